@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures how the FST writer keeps up with the event dumper thread.
+ *
+ * The same stream of value changes, converted the same way as in Fst_file::dump,
+ * is written with the sequential and the parallel writers, first with one
+ * packing thread, then with the given number of them. The time spent in
+ * fstWriterEmitTimeChange is reported separately, since this is where the
+ * writer flushes a section: in sequential mode this is the packing time,
+ * while in parallel mode this is the time needed to hand the section over,
+ * plus the time waiting for the previous one to be packed. In sequential mode
+ * with one thread, the ratio between this stall time and the rest tells how
+ * many packing threads are needed so that the dumper thread does not wait.
+ * The output files are the same whatever the mode and number of threads.
+ */
+
+#include "../src/trace/fst/fstapi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include <string>
+
+static inline int64_t get_time_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "Usage: %s [--signals N] [--changes N] [--steps N] [--threads N] [--pack zlib|fastlz|lz4] [--output PATH]\n", name);
+  exit(1);
+}
+
+static void run(const char *path, bool parallel, int nb_threads, int pack, int nb_signals, int nb_changes, int64_t nb_steps)
+{
+  void *writer = fstWriterCreate(path, 0);
+  if (writer == NULL)
+  {
+    fprintf(stderr, "Error while opening FST file (path: %s)\n", path);
+    exit(1);
+  }
+
+  fstWriterSetTimescale(writer, -12);
+  fstWriterSetParallelMode(writer, parallel);
+  fstWriterSetPackThreads(writer, nb_threads);
+  fstWriterSetPackType(writer, (enum fstWriterPackType)pack);
+
+  // Mix of the widths found in the platforms, from single wires to 64 bits
+  // buses, in a few scopes
+  static const int widths[] = { 1, 1, 8, 32, 64 };
+  std::vector<fstHandle> vars(nb_signals);
+  std::vector<int> vars_width(nb_signals);
+  for (int i=0; i<nb_signals; i++)
+  {
+    if (i % 100 == 0)
+    {
+      if (i != 0)
+        fstWriterSetUpscope(writer);
+      fstWriterSetScope(writer, FST_ST_VCD_MODULE, ("comp" + std::to_string(i / 100)).c_str(), NULL);
+    }
+
+    vars_width[i] = widths[i % 5];
+    vars[i] = fstWriterCreateVar(writer, FST_VT_VCD_WIRE, FST_VD_INOUT, vars_width[i],
+      ("sig" + std::to_string(i)).c_str(), 0);
+  }
+  fstWriterSetUpscope(writer);
+
+  uint32_t seed = 1;
+  int64_t stall_time = 0;
+  int64_t start = get_time_ns();
+
+  for (int64_t step=0; step<nb_steps; step++)
+  {
+    int64_t emit_start = get_time_ns();
+    fstWriterEmitTimeChange(writer, step * 1000);
+    stall_time += get_time_ns() - emit_start;
+
+    for (int i=0; i<nb_changes; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      int id = (seed >> 8) % nb_signals;
+      seed = seed * 1103515245 + 12345;
+      uint32_t value = seed >> 4;
+      int width = vars_width[id];
+
+      char val[64];
+      for (int j=0; j<width; j++)
+      {
+        val[width - j - 1] = '0' + ((value >> (j & 31)) & 1);
+      }
+      fstWriterEmitValueChange(writer, vars[id], val);
+    }
+  }
+
+  int64_t close_start = get_time_ns();
+  fstWriterClose(writer);
+  int64_t end = get_time_ns();
+
+  printf("%-10s %2d threads  total %8.3f s  stalls %8.3f s (%5.1f %%)  close %8.3f s  %6.2f Mchanges/s\n",
+    parallel ? "parallel" : "sequential", nb_threads,
+    (end - start) / 1e9, stall_time / 1e9, stall_time * 100.0 / (close_start - start),
+    (end - close_start) / 1e9, nb_steps * nb_changes / ((end - start) / 1e3));
+
+  // The hierarchy is kept in a separate file since it is not compressed
+  unlink(path);
+  unlink((std::string(path) + ".hier").c_str());
+}
+
+int main(int argc, char *argv[])
+{
+  int nb_signals = 2000;
+  int nb_changes = 20;
+  int64_t nb_steps = 1000000;
+  int nb_threads = 4;
+  int pack = FST_WR_PT_LZ4;
+  std::string path = "fst_bench.fst";
+
+  for (int i=1; i<argc; i++)
+  {
+    if (i + 1 >= argc)
+      usage(argv[0]);
+
+    std::string opt = argv[i++];
+    if (opt == "--signals")
+      nb_signals = atoi(argv[i]);
+    else if (opt == "--changes")
+      nb_changes = atoi(argv[i]);
+    else if (opt == "--steps")
+      nb_steps = atoll(argv[i]);
+    else if (opt == "--threads")
+      nb_threads = atoi(argv[i]);
+    else if (opt == "--output")
+      path = argv[i];
+    else if (opt == "--pack")
+    {
+      std::string name = argv[i];
+      if (name == "zlib")
+        pack = FST_WR_PT_ZLIB;
+      else if (name == "fastlz")
+        pack = FST_WR_PT_FASTLZ;
+      else if (name == "lz4")
+        pack = FST_WR_PT_LZ4;
+      else
+        usage(argv[0]);
+    }
+    else
+      usage(argv[0]);
+  }
+
+  if (nb_signals <= 0 || nb_changes <= 0 || nb_steps <= 0 || nb_threads <= 0)
+    usage(argv[0]);
+
+  printf("%d signals, %d changes per step, %ld steps\n", nb_signals, nb_changes, nb_steps);
+
+  run(path.c_str(), false, 1, pack, nb_signals, nb_changes, nb_steps);
+  run(path.c_str(), true, 1, pack, nb_signals, nb_changes, nb_steps);
+  if (nb_threads > 1)
+  {
+    run(path.c_str(), false, nb_threads, pack, nb_signals, nb_changes, nb_steps);
+    run(path.c_str(), true, nb_threads, pack, nb_signals, nb_changes, nb_steps);
+  }
+
+  return 0;
+}
@@ -310,7 +310,11 @@ namespace gv {
     /**
      * GVSOC interface
      *
-     * Gather all the methods which can be called to control GVSOC execution and other features
+     * Gather all the methods which can be called to control GVSOC execution and other features.
+     *
+     * Several instances can be opened in the same process, each one with its own configuration.
+     * They are independent and can be controlled from different threads, the model libraries
+     * being loaded only once and shared by all of them.
      */
     class Gvsoc : public Io, public Vcd
     {
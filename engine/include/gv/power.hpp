@@ -200,6 +200,11 @@ namespace vp
             bool is_dynamic_power_on = false;      // True is the power domain containing the power source is on and backgroun-power and leakage should be reported
             bool dynamic_power_is_on_sync = false;
             bool leakage_power_is_on_sync = false;
+            bool quantum_is_on = false;  // True if quanta of energy should be accounted, updated everytime the
+                                         // source state is changed so that accounting a quantum is a single test
+            double setup_temp = -1;  // Operating point used to compute the current power numbers, they are
+            double setup_volt = -1;  // only estimated again from the tables when it changes
+            double setup_freq = -1;
         };
 
 
@@ -242,6 +247,16 @@ namespace vp
              */
             inline bool get_active() { return trace.get_event_active(); }
 
+            /**
+             * @brief Register a callback called when the trace is enabled or disabled
+             *
+             * This can be used by components which let initiators bypass them
+             * and must see again all accesses to account their power.
+             *
+             * @param callback Callback to be called
+             */
+            inline void register_callback(std::function<void()> callback) { trace.register_callback(callback); }
+
             /**
              * @brief Dump the trace
              *
@@ -349,7 +364,26 @@ namespace vp
              */
             void inc_dynamic_energy(double energy);
 
+            /**
+             * @brief Account a quantum of energy consumed in the current cycle.
+             *
+             * Quanta of energy accounted in the same cycle are summed and only accounted once
+             * at the end of the cycle, like if inc_dynamic_energy was called with the sum,
+             * so that this can be called on every access. Quanta accounted while the clock
+             * engine of the component is not executing its events are accounted directly.
+             * This method is reserved for methods belonging to namespace vp::power.
+             *
+             * @param energy Quantum of energy.
+             */
+            inline void account_quantum(double energy);
+
         private:
+            // Account the quanta of energy summed in the current cycle, if any
+            inline void flush_pending_energy();
+
+            // Event handler called at the end of a cycle where quanta of energy were summed
+            static void pending_energy_handler(void *__this, vp::clock_event *event);
+
             // Regularly, current power consumption is converted into energy and added
             // to the total amount of energy consumed, for example when the current power
             // consumption is modified.
@@ -429,6 +463,11 @@ namespace vp
                                                      // energy over the period being measured. Everytime it is updated,
                                                      // the energy should be computed and the timestamp updated.
 
+            vp::clock_event *pending_energy_event; // Clock event used to account pending energy at the end of the cycle
+            double pending_energy;            // Sum of the quanta of energy accounted in the current cycle and not
+                                              // yet reported
+            bool has_pending_energy;          // True if pending_energy must be accounted
+
             double current_power;    // Instant power of the current cycle. This is updated everytime
                                      // background or leakage power is updated and also when a quantum of energy is 
                                      // accounted, in order to proerly update the VCD trace
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <zlib.h>
+
+namespace vp {
+
+    #define CHECKPOINT_PAGE_SIZE 4096
+
+    // Checkpoint file, used both to save and to restore the state of the whole
+    // platform. All the accesses are symmetric so that the same code can be used
+    // to save the state, or to restore it, depending on the checkpoint direction.
+    // The file is compressed and memory pages are deduplicated, so that big
+    // memories which are mostly empty take very little space.
+    // Any error, including a checkpoint which does not match the platform, is
+    // reported by throwing an std::runtime_error.
+    class checkpoint
+    {
+    public:
+        checkpoint(std::string path, bool is_restore);
+        ~checkpoint();
+
+        inline bool is_restore() { return this->restore; }
+
+        // Start the section of the specified component. The name is checked when
+        // restoring to detect checkpoints taken on a different platform.
+        void section(std::string name);
+
+        // Save or restore raw data
+        void data(void *data, size_t size);
+
+        template<typename T> inline void value(T &value) { this->data((void *)&value, sizeof(T)); }
+
+        // Save or restore a memory area, page by page. Pages which are full of
+        // zeros or which are identical to a page already saved are not stored.
+        // When restoring, pages which already have the right content are not
+        // written so that lazily allocated memories are not populated.
+        void pages(uint8_t *data, size_t size);
+
+    private:
+        void write(void *data, size_t size);
+        void read(void *data, size_t size);
+        uint64_t page_hash(uint8_t *data, size_t size);
+
+        std::string path;
+        bool restore;
+        gzFile file;
+        // Pages saved or restored so far, indexed by their order in the file,
+        // used to resolve duplicated pages
+        std::vector<uint8_t *> page_list;
+        // Pages saved so far indexed by their hash, used to detect duplicated pages
+        std::unordered_multimap<uint64_t, uint32_t> page_hashes;
+    };
+};
@@ -61,6 +61,7 @@ namespace vp {
       // This probably comes from models manipulating 2 clock domains at the same time.
       if (unlikely(!this->is_running()))
       {
+        this->check_partition();
         this->sync();
       }
 
@@ -83,6 +84,18 @@ namespace vp {
       return this->enqueue(event, cycles);
     }
 
+    // Execute the event once all the events of the current cycle have been
+    // executed. Must only be called while the engine is executing its events.
+    inline void enqueue_cycle_end(clock_event *event)
+    {
+      vp_assert(!event->enqueued, 0, "Enqueueing already enqueued event\n");
+      vp_assert(this->is_running(), 0, "Enqueueing cycle end event while engine is not running\n");
+
+      event->enqueued = true;
+      event->next = this->cycle_end_events;
+      this->cycle_end_events = event;
+    }
+
     clock_event *event_new(component_clock *comp, clock_event_meth_t *meth)
     {
       clock_event *event = new clock_event(comp, meth);
@@ -102,13 +115,22 @@ namespace vp {
 
     void event_del(component_clock *comp, clock_event *event)
     {
+      comp->remove_clock_event(event);
       delete event;
     }
 
     int64_t exec();
 
+    // Save or restore the cycle count and frequency. Pending events are dropped
+    // when restoring, they are then re-enqueued by the components owning them.
+    void checkpoint(vp::checkpoint *cp);
+
     inline void sync();
 
+    // In parallel mode, check that the engine is executed by the current thread,
+    // as components can not push events to clocks of other partitions.
+    void check_partition();
+
     void update();
 
     void set_time_engine(vp::time_engine *engine) { this->engine = engine; }
@@ -127,10 +149,24 @@ namespace vp {
 
     bool has_events() { return this->nb_enqueued_to_cycle || this->delayed_queue; }
 
+    // Can be called from an event callback to know if the engine can directly
+    // jump to the specified number of cycles in the future, which is the case
+    // if no other event from this engine or from another one would be executed
+    // in-between.
+    inline bool can_skip_cycles(int64_t cycles);
+
+    // Jump to the specified number of cycles in the future. Must only be called
+    // from an event callback after can_skip_cycles returned true.
+    inline void skip_cycles(int64_t cycles);
+
   protected:
 
     void flush_delayed_queue();
 
+    void exec_cycle_end_events();
+
+    bool cancel_from_cycle(int cycle, clock_event *event);
+
     inline void enqueue_to_cycle(clock_event *event, int64_t cycles)
     {
       // The position of one round of the circular buffer is always aligned
@@ -138,14 +174,36 @@ namespace vp {
       int cycle = (current_cycle + cycles) & CLOCK_EVENT_QUEUE_MASK;
       event->next = event_queue[cycle];
       event_queue[cycle] = event;
+      event_queue_mask |= 1U << cycle;
       nb_enqueued_to_cycle++;
       event->cycle = cycles + get_cycles();
     }
 
+    // Return the number of cycles from the current cycle to the first non-empty
+    // slot of the circular buffer. Must only be called when it is not empty.
+    inline int get_next_cycle_distance()
+    {
+      uint32_t mask = event_queue_mask;
+      int shift = current_cycle;
+      mask = (mask >> shift) | (mask << ((CLOCK_EVENT_QUEUE_SIZE - shift) & CLOCK_EVENT_QUEUE_MASK));
+      return __builtin_ctz(mask);
+    }
+
+    inline void advance_cycles(int64_t cycles);
+
     clock_event *enqueue_other(clock_event *event, int64_t cycles);
 
     clock_event *event_queue[CLOCK_EVENT_QUEUE_SIZE];
+
+    // Bitmap of the non-empty slots of the circular buffer, used to jump over
+    // empty cycles.
+    uint32_t event_queue_mask = 0;
+
     clock_event *delayed_queue = NULL;
+
+    // Events to be executed after the events of the current cycle
+    clock_event *cycle_end_events = NULL;
+
     int current_cycle = 0;
     int64_t period = 0;
     int64_t freq;
@@ -32,6 +32,7 @@ namespace vp {
 
   #define CLOCK_EVENT_PAYLOAD_SIZE 64
   #define CLOCK_EVENT_NB_ARGS 8
+  // The circular buffer size must match the width of the clock engine slot bitmap
   #define CLOCK_EVENT_QUEUE_SIZE 32
   #define CLOCK_EVENT_QUEUE_MASK (CLOCK_EVENT_QUEUE_SIZE - 1)
 
@@ -46,8 +47,7 @@ namespace vp {
 
     clock_event(component_clock *comp, clock_event_meth_t *meth);
 
-    clock_event(component_clock *comp, void *_this, clock_event_meth_t *meth) 
-      : comp(comp), _this(_this), meth(meth), enqueued(false) {}
+    clock_event(component_clock *comp, void *_this, clock_event_meth_t *meth);
 
     inline int get_payload_size() { return CLOCK_EVENT_PAYLOAD_SIZE; }
     inline uint8_t *get_payload() { return payload; }
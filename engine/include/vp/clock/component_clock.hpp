@@ -83,6 +83,10 @@ namespace vp {
 
     void add_clock_event(clock_event *);
 
+    void add_ext_clock_event(clock_event *);
+
+    void remove_clock_event(clock_event *);
+
   protected:
     clock_engine *clock = NULL;
 
@@ -91,6 +95,11 @@ namespace vp {
 
     std::vector<clock_event *> events;
 
+    // Events created for another object than the component, which are handled by
+    // this object and then not cancelled on reset. They are still checkpointed
+    // with the component.
+    std::vector<clock_event *> ext_events;
+
 
   };
 
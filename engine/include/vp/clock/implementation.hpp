@@ -92,11 +92,63 @@ inline vp::time_engine *vp::component_clock::get_engine()
 
 inline void vp::clock_engine::sync()
 {
-  if (!is_running() && !nb_enqueued_to_cycle)
+  // The engine may be waiting for an event several cycles ahead, even if there
+  // are events in the circular buffer, so always bring it to the current time.
+  if (!is_running())
   {
     this->update();
   }
 }
 
 
+inline bool vp::clock_engine::can_skip_cycles(int64_t cycles)
+{
+  // The other events of the current cycle must be executed first
+  if (cycles >= CLOCK_EVENT_QUEUE_SIZE || event_queue[current_cycle] != NULL || cycle_end_events != NULL)
+  {
+    return false;
+  }
+
+  // Then check there is no event up to the target cycle, the current slot being
+  // excluded as its bit is only cleared once the engine is done with it.
+  uint32_t mask = event_queue_mask;
+  int shift = current_cycle;
+  mask = (mask >> shift) | (mask << ((CLOCK_EVENT_QUEUE_SIZE - shift) & CLOCK_EVENT_QUEUE_MASK));
+  if (mask & ((2U << cycles) - 2))
+  {
+    return false;
+  }
+
+  if (delayed_queue && delayed_queue->cycle <= this->cycles + cycles)
+  {
+    return false;
+  }
+
+  return this->engine->can_advance(cycles * this->period);
+}
+
+
+inline void vp::clock_engine::skip_cycles(int64_t cycles)
+{
+  event_queue_mask &= ~(1U << current_cycle);
+  this->advance_cycles(cycles);
+  this->engine->advance(cycles * this->period);
+}
+
+
+inline void vp::clock_engine::advance_cycles(int64_t cycles)
+{
+  // All the slots we are going through are empty, just move the current slot.
+  // Crossing the end of the buffer means events from the delayed queue may now
+  // fit into it.
+  if (current_cycle + cycles >= CLOCK_EVENT_QUEUE_SIZE)
+  {
+    this->must_flush_delayed_queue = true;
+  }
+
+  this->cycles += cycles;
+  this->current_cycle = (this->current_cycle + cycles) & CLOCK_EVENT_QUEUE_MASK;
+}
+
+
 #endif
@@ -57,6 +57,7 @@ namespace vp {
   class clock_engine;
   class component;
   class signal;
+  class checkpoint;
 
 
   class Notifier {
@@ -71,10 +72,14 @@ namespace vp {
     public:
         block(block *parent);
         virtual void reset(bool active) {}
+        // Can be overloaded by models to save or restore the part of their state
+        // which is not already held by signals, registers or sub-blocks.
+        virtual void checkpoint(vp::checkpoint *cp) {}
         void add_signal(vp::signal *signal);
 
     protected:
         void reset_all(bool active);
+        void checkpoint_all(vp::checkpoint *cp);
         void add_block(block *block);
 
     private:
@@ -122,6 +127,9 @@ namespace vp {
 
     js::config *get_vp_config();
     void set_vp_config(js::config *config);
+    // Path of the configuration file this simulator instance was created from
+    std::string get_config_path();
+    void set_config_path(std::string path);
     void set_gv_conf(struct gv_conf *gv_conf);
 
     inline config *get_config(std::string name);
@@ -139,6 +147,11 @@ namespace vp {
 
     virtual vp::time_engine *get_time_engine() ;
 
+    // Return the time engine executing this component, which is the engine of its
+    // partition in parallel mode. Clock engines are executed by the engine they
+    // are attached to, other components by the one of their clock engine.
+    vp::time_engine *get_partition_engine();
+
     string get_path() { return path; }
     string get_name() { return name; }
 
@@ -178,6 +191,15 @@ namespace vp {
 
     void reset_all(bool active, bool from_itf=false);
 
+    // Save or restore the state of this component and of all its sub-components.
+    // Must only be called while the engine is locked.
+    void checkpoint_save(std::string path);
+    void checkpoint_restore(std::string path);
+
+    void checkpoint_all(vp::checkpoint *cp);
+
+    void checkpoint_events_all(vp::checkpoint *cp);
+
     void new_master_port(std::string name, master_port *port);
 
     void new_master_port(void *comp, std::string name, master_port *port);
@@ -244,6 +266,7 @@ namespace vp {
 
     js::config *comp_js_config;
     js::config *vp_config = NULL;
+    std::string config_path;
     trace root_trace;
 
     std::map<std::string, master_port *> master_ports;
@@ -270,6 +293,7 @@ namespace vp {
   public:
       component *top_instance;
       power::engine *power_engine;
+      Gv_proxy *proxy = NULL;
   private:
   };
 
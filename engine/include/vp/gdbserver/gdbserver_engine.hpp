@@ -36,6 +36,15 @@ namespace vp
             stopped
         } state;
 
+        typedef enum
+        {
+            stop_reason_halt,
+            stop_reason_breakpoint,
+            stop_reason_watch_write,
+            stop_reason_watch_read,
+            stop_reason_watch_access
+        } stop_reason;
+
         virtual int gdbserver_get_id() = 0;
         virtual std::string gdbserver_get_name() = 0;
         virtual int gdbserver_reg_set(int reg, uint8_t *value) = 0;
@@ -45,6 +54,11 @@ namespace vp
         virtual int gdbserver_cont() = 0;
         virtual int gdbserver_stepi() = 0;
         virtual int gdbserver_state() = 0;
+        virtual int gdbserver_breakpoint_insert(uint64_t addr) = 0;
+        virtual int gdbserver_breakpoint_remove(uint64_t addr) = 0;
+        virtual int gdbserver_watchpoint_insert(bool is_write, bool is_read, uint64_t addr, int size) = 0;
+        virtual int gdbserver_watchpoint_remove(bool is_write, bool is_read, uint64_t addr, int size) = 0;
+        virtual int gdbserver_stop_reason(uint64_t *addr) = 0;
     };
 
 
@@ -56,7 +56,13 @@ namespace vp {
     return get_js_config()->get_child_str(name);
   }
 
-  inline int64_t component::get_time() { return this->get_time_engine()->get_time(); }
+  inline int64_t component::get_time()
+  {
+    // In parallel mode, each partition has its own time, which is found through
+    // the clock engine
+    vp::clock_engine *clock = this->get_clock();
+    return clock ? clock->get_time() : this->get_time_engine()->get_time();
+  }
 
 
 };
@@ -63,6 +63,8 @@ namespace vp {
     static inline void sync_default(void *, bool value);
     static inline void set_frequency_default(void *, int64_t value);
     static inline void set_frequency_freq_cross_stub(clock_master *_this, int64_t value);
+    static inline void sync_partition_cross_stub(clock_master *_this, bool value);
+    static inline void set_frequency_partition_cross_stub(clock_master *_this, int64_t value);
 
     void (*sync_meth)(void *, bool value);
     void (*sync_meth_mux)(void *, bool value, int id);
@@ -32,12 +32,38 @@ namespace vp {
 
 
 
+  // Whole hyperbus transaction, from chip select assertion to deassertion, which
+  // can be transferred in one call to slaves supporting it instead of one call per byte.
+  class hyper_burst
+  {
+  public:
+    // Address, as decoded by the slave from the command-address phase
+    uint32_t addr;
+    // Number of data bytes
+    int size;
+    // Data to be written, or filled by the slave with the data read
+    uint8_t *data;
+    bool is_write;
+    // True if the access targets the register space
+    bool reg_access;
+    // Filled by the slave with the number of bytes the transaction would have
+    // transferred in pin-level mode, including the command-address phase, so that
+    // the master can account for the same duration.
+    int64_t duration;
+  };
+
+
+
   typedef void (hyper_sync_cycle_meth_t)(void *, int data);
   typedef void (hyper_cs_sync_meth_t)(void *, int cs, int active);
 
   typedef void (hyper_sync_cycle_meth_muxed_t)(void *, int data, int id);
   typedef void (hyper_cs_sync_meth_muxed_t)(void *, int cs, int active, int id);
 
+  // Returns false if the slave can not handle this transaction in burst mode, in
+  // which case the master must send it in pin-level mode
+  typedef bool (hyper_burst_meth_t)(void *, hyper_burst *burst);
+
 
   class hyper_master : public vp::master_port
   {
@@ -57,6 +83,12 @@ namespace vp {
       return cs_sync_meth(this->get_remote_context(), cs, active);
     }
 
+    // Send a whole transaction, must only be called if the slave is burst capable
+    inline bool burst(hyper_burst *burst)
+    {
+      return burst_meth(this->get_remote_context(), burst);
+    }
+
     void bind_to(vp::port *port, vp::config *config);
 
     inline void set_sync_cycle_meth(hyper_sync_cycle_meth_t *meth);
@@ -64,6 +96,10 @@ namespace vp {
 
     bool is_bound() { return slave_port != NULL; }
 
+    // Tells if the slave can receive transactions in burst mode. This is known once
+    // the port is bound, slaves bound through a multiplexer only support pin-level mode.
+    bool is_burst_capable() { return burst_meth != NULL; }
+
   private:
 
     static inline void sync_cycle_muxed_stub(hyper_master *_this, int data);
@@ -76,6 +112,7 @@ namespace vp {
     void (*sync_cycle_meth_mux)(void *, int data, int mux);
     void (*cs_sync_meth)(void *, int cs, int active);
     void (*cs_sync_meth_mux)(void *, int cs, int active, int mux);
+    hyper_burst_meth_t *burst_meth = NULL;
 
     static inline void sync_cycle_default(void *, int data);
 
@@ -108,6 +145,8 @@ namespace vp {
     inline void set_cs_sync_meth(hyper_cs_sync_meth_t *meth);
     inline void set_cs_sync_meth_muxed(hyper_cs_sync_meth_muxed_t *meth, int id);
 
+    inline void set_burst_meth(hyper_burst_meth_t *meth);
+
     inline void bind_to(vp::port *_port, vp::config *config);
 
     static inline void sync_cycle_muxed_stub(hyper_slave *_this, int data);
@@ -122,6 +161,7 @@ namespace vp {
     void (*sync_cycle_mux_meth)(void *comp, int data, int mux);
     void (*cs_sync)(void *comp, int cs, int active);
     void (*cs_sync_mux)(void *comp, int cs, int active, int mux);
+    hyper_burst_meth_t *burst_meth = NULL;
 
     static inline void sync_cycle_default(hyper_slave *, int data);
     static inline void cs_sync_default(hyper_slave *, int cs, int active);
@@ -180,6 +220,7 @@ namespace vp {
     {
       sync_cycle_meth = port->sync_cycle_meth;
       cs_sync_meth = port->cs_sync;
+      burst_meth = port->burst_meth;
       this->set_remote_context(port->get_context());
     }
     else
@@ -239,6 +280,11 @@ namespace vp {
     cs_sync_mux = NULL;
   }
 
+  inline void hyper_slave::set_burst_meth(hyper_burst_meth_t *meth)
+  {
+    burst_meth = meth;
+  }
+
   inline void hyper_slave::set_sync_cycle_meth_muxed(hyper_sync_cycle_meth_muxed_t *meth, int id)
   {
     sync_cycle_mux_meth = meth;
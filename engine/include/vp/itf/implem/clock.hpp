@@ -100,6 +100,18 @@ namespace vp {
     return _this->set_frequency_meth_freq_cross((component *)_this->slave_context_for_freq_cross, value);
   }
 
+  inline void clock_master::sync_partition_cross_stub(clock_master *_this, bool value)
+  {
+    // The slave is executed by another thread in parallel mode, the call is then
+    // delivered at the end of the quantum.
+    _this->partition_defer([_this, value]() { clock_master::sync_freq_cross_stub(_this, value); });
+  }
+
+  inline void clock_master::set_frequency_partition_cross_stub(clock_master *_this, int64_t value)
+  {
+    _this->partition_defer([_this, value]() { clock_master::set_frequency_freq_cross_stub(_this, value); });
+  }
+
   inline void clock_master::set_frequency_muxed(clock_master *_this, int64_t frequency)
   {
     return _this->set_frequency_meth_mux(_this->comp_mux, frequency, _this->sync_mux);
@@ -109,7 +121,9 @@ namespace vp {
   {
     // We have to instantiate a stub in case the binding is crossing different
     // frequency domains in order to resynchronize the target engine.
-    if (this->get_owner()->get_clock() != this->remote_port->get_owner()->get_clock())
+    bool partition_cross = this->is_partition_cross();
+
+    if (partition_cross || this->get_owner()->get_clock() != this->remote_port->get_owner()->get_clock())
     {
       // Just save the normal handler and tweak it to enter the stub when the
       // master is pushing the request.
@@ -121,6 +135,12 @@ namespace vp {
 
       this->slave_context_for_freq_cross = this->get_remote_context();
       this->set_remote_context(this);
+
+      if (partition_cross)
+      {
+        this->sync_meth = (void (*)(void *, bool))&clock_master::sync_partition_cross_stub;
+        this->set_frequency_meth = (void (*)(void *, int64_t))&clock_master::set_frequency_partition_cross_stub;
+      }
     }
   }
 
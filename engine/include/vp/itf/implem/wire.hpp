@@ -92,6 +92,14 @@ namespace vp {
     return _this->sync_meth_freq_cross((component *)_this->slave_context_for_freq_cross, value);
   }
 
+  template<class T>
+  inline void wire_master<T>::sync_partition_cross_stub(wire_master<T> *_this, T value)
+  {
+    // The slave is executed by another thread in parallel mode, the value is then
+    // delivered at the end of the quantum.
+    _this->partition_defer([_this, value]() { wire_master<T>::sync_freq_cross_stub(_this, value); });
+  }
+
   template<class T>
   inline void wire_master<T>::sync_back_freq_cross_stub(wire_master<T> *_this, T *value)
   {
@@ -108,7 +116,9 @@ namespace vp {
   {
     // We have to instantiate a stub in case the binding is crossing different
     // frequency domains in order to resynchronize the target engine.
-    if (this->get_owner()->get_clock() != this->remote_port->get_owner()->get_clock())
+    bool partition_cross = this->is_partition_cross();
+
+    if (partition_cross || this->get_owner()->get_clock() != this->remote_port->get_owner()->get_clock())
     {
       // Just save the normal handler and tweak it to enter the stub when the
       // master is pushing the request.
@@ -120,6 +130,21 @@ namespace vp {
 
       this->slave_context_for_freq_cross = this->get_remote_context();
       this->set_remote_context(this);
+
+      if (partition_cross)
+      {
+        // Values read back need an immediate answer from a component executed by
+        // another thread, which can not be done safely.
+        wire_slave<T> *slave = (wire_slave<T> *)this->remote_port;
+        if (slave->sync_back || slave->sync_back_mux)
+        {
+          this->get_owner()->get_trace()->fatal("Wire with sync_back is crossing partitions of the parallel mode (master: %s, slave: %s)\n",
+            this->get_owner()->get_path().c_str(), this->remote_port->get_owner()->get_path().c_str());
+          return;
+        }
+
+        this->sync_meth = (void (*)(void *, T))&wire_master<T>::sync_partition_cross_stub;
+      }
     }
   }
 
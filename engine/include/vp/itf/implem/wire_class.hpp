@@ -63,6 +63,8 @@ namespace vp {
   private:
     static inline void sync_muxed(wire_master *_this, T value);
     static inline void sync_freq_cross_stub(wire_master *_this, T value);
+
+    static inline void sync_partition_cross_stub(wire_master *_this, T value);
     static inline void sync_back_freq_cross_stub(wire_master *_this, T *value);
     static inline void sync_back_muxed(wire_master *_this, T *value);
     void (*sync_meth)(void *, T value);
@@ -52,6 +52,44 @@ namespace vp {
   typedef void (io_resp_meth_t)(void *, io_req *);
   typedef void (io_grant_meth_t)(void *, io_req *);
 
+  class io_dmi;
+
+  typedef io_req_status_e (io_dmi_meth_t)(void *, uint64_t addr, io_dmi *);
+  typedef void (io_dmi_invalidate_meth_t)(void *);
+
+
+
+  /*
+   * Direct memory interface descriptor
+   *
+   * This describes a window of the slave address space which can be accessed
+   * directly through a host pointer, with a fixed latency, instead of sending
+   * IO requests. It is returned by the slave and each component on the path
+   * (e.g. routers) translates the window and adds its own latency.
+   */
+  class io_dmi
+  {
+  public:
+    io_dmi() { this->init(); }
+
+    inline void init() { base = 0; size = 0; data = NULL; latency = 0; }
+
+    // Tell if the window is valid and covers the specified access
+    inline bool contains(uint64_t addr, uint64_t size)
+    {
+      return addr >= this->base && addr + size <= this->base + this->size;
+    }
+
+    // First address of the window, in the address space of the port
+    uint64_t base;
+    // Size in bytes of the window, 0 if the window is not valid
+    uint64_t size;
+    // Host pointer corresponding to the first address of the window
+    uint8_t *data;
+    // Latency in cycles of any access to the window
+    int64_t latency;
+  };
+
   class io_req : public vp::queue_elem
   {
     friend class io_master;
@@ -173,6 +211,14 @@ namespace vp {
     // Can be called by master component to send an IO request.  
     inline io_req_status_e req(io_req *req);
 
+    // Can be called by master component to get a direct access to the window
+    // of the slave memory containing the specified address.
+    // Returns IO_REQ_OK and fills the descriptor if the slave granted it.
+    inline io_req_status_e dmi_req(uint64_t addr, io_dmi *dmi);
+
+    // Same as dmi_req but the request is sent to the specified slave port.
+    inline io_req_status_e dmi_req(uint64_t addr, io_dmi *dmi, io_slave *slave_port);
+
     // Can be called by master component to forward an IO request.
     // Compared to the req method, this one will not redefined the response
     // port and thus responses sent back by the slave will be send to our
@@ -198,6 +244,11 @@ namespace vp {
     // an IO request response. Before being set, a default empty callback is active.
     inline void set_resp_meth(io_resp_meth_t *meth);
 
+    // Set the callback on master side called when the slave invalidates the
+    // direct memory windows it previously granted. Before being set, a default
+    // empty callback is active.
+    inline void set_dmi_invalidate_meth(io_dmi_invalidate_meth_t *meth);
+
 
 
     /*
@@ -238,6 +289,14 @@ namespace vp {
     // Default response callback, just do nothing.
     static inline void resp_default(void *, io_req *);
 
+    // DMI invalidation callback set by the user.
+    // This gets called anytime the slave is invalidating its direct memory
+    // windows. This is set to an empty callback by default.
+    void (*dmi_invalidate_meth)(void *context);
+
+    // Default DMI invalidation callback, just do nothing.
+    static inline void dmi_invalidate_default(void *);
+
 
     /*
      * Slave callbacks
@@ -246,6 +305,9 @@ namespace vp {
     // Callback set by the user on slave port and retrieved during binding
     io_req_status_e (*req_meth)(void *, io_req *);
 
+    // DMI callback set by the user on slave port and retrieved during binding
+    io_req_status_e (*dmi_meth)(void *, uint64_t, io_dmi *);
+
     // req_meth saved when the slave port is multiplexed as a stub is setup instead
     io_req_status_e (*req_meth_mux)(void *, io_req *, int mux);
 
@@ -268,6 +330,16 @@ namespace vp {
     // domain before we call it.
     static inline io_req_status_e req_freq_cross_stub(io_master *_this, io_req *req);
 
+    // This is a stub setup when the binding is crossing 2 partitions of the parallel
+    // mode so that the request is delivered to the slave at the end of the quantum.
+    // The request is denied to the master until the slave accepts it.
+    static inline io_req_status_e req_partition_cross_stub(io_master *_this, io_req *req);
+
+    // This is a stub setup when the binding is crossing 2 partitions of the parallel
+    // mode. The slave memory is accessed by another thread, so direct accesses are
+    // refused and the master has to go through requests.
+    static inline io_req_status_e dmi_partition_cross_stub(void *, uint64_t addr, io_dmi *dmi);
+
 
     /*
      * Internal data
@@ -290,6 +362,11 @@ namespace vp {
     // is multiplexed.
     int slave_req_mux_id = -1;
 
+    // Slave context for DMI requests.
+    // The normal remote context can be replaced by stubs, so we keep here a copy
+    // of the slave context which can always be used for DMI requests.
+    void *slave_context_for_dmi = NULL;
+
 
     // Several IO master ports are often connected to the same slave port
     // while the slave will need to reply to the master.
@@ -327,6 +404,11 @@ namespace vp {
     // owned back by the master which can then proceed with the request.
     inline void resp(io_req *req) { this->master_resp_meth(this->get_remote_context(), req); }
 
+    // Can be called to invalidate all the direct memory windows granted through
+    // this port. All the masters bound to this port are notified so that they
+    // stop using them and fall back to IO requests.
+    inline void dmi_invalidate();
+
 
 
     /*
@@ -342,6 +424,11 @@ namespace vp {
     // when calling the callback, and can be used to multiplex a slave port
     inline void set_req_meth_muxed(io_req_meth_muxed_t *meth, int id);
 
+    // Set the callback on slave side called when the master is asking for a
+    // direct memory window. Before being set, a default callback denying any
+    // window is active.
+    inline void set_dmi_meth(io_dmi_meth_t *meth);
+
 
 
     /*
@@ -377,6 +464,14 @@ namespace vp {
     // This one gets called instead of the normal once in case it is not NULL
     io_req_status_e (*req_meth_mux)(void *context, io_req *, int mux);
 
+    // DMI callback set by the user.
+    // This gets called anytime the master is asking for a direct memory window.
+    // This is set to a callback denying any window by default.
+    io_req_status_e (*dmi_meth)(void *context, uint64_t, io_dmi *);
+
+    // Default DMI callback, just deny the window.
+    static inline io_req_status_e dmi_default(void *, uint64_t, io_dmi *);
+
 
 
     /*
@@ -397,6 +492,9 @@ namespace vp {
     // setup instead
     void (*master_grant_meth_freq_cross)(void *, io_req *);
 
+    // DMI invalidation callback set by the user on master port and retrived during binding
+    void (*master_dmi_invalidate_meth)(void *);
+
 
     /*
      * Stubs
@@ -412,6 +510,14 @@ namespace vp {
     // domain before we call it.
     static inline void resp_freq_cross_stub(io_slave *_this, io_req *req);
 
+    // This is a stub setup when the binding is crossing 2 partitions of the parallel
+    // mode so that the grant is delivered to the master at the end of the quantum.
+    static inline void grant_partition_cross_stub(io_slave *_this, io_req *req);
+
+    // This is a stub setup when the binding is crossing 2 partitions of the parallel
+    // mode so that the response is delivered to the master at the end of the quantum.
+    static inline void resp_partition_cross_stub(io_slave *_this, io_req *req);
+
     // Setup stubs for cross frequency domain crossing
     inline void set_freq_stub();
 
@@ -430,6 +536,13 @@ namespace vp {
     // so that the stub is working well.
     void *master_context_for_freq_cross;
 
+    // Master context for DMI invalidations, which is never replaced by a stub.
+    void *master_context_for_dmi;
+
+    // Ports created for each master bound to this port, used to broadcast
+    // DMI invalidations to all of them.
+    std::vector<io_slave *> master_ports;
+
   };
 
 
@@ -438,6 +551,8 @@ namespace vp {
     // Set default callbacks in case the user does not set them
     this->resp_meth = &io_master::resp_default;
     this->grant_meth = &io_master::grant_default;
+    this->dmi_invalidate_meth = &io_master::dmi_invalidate_default;
+    this->dmi_meth = &io_slave::dmi_default;
   }
 
 
@@ -472,6 +587,32 @@ namespace vp {
 
 
 
+  inline io_req_status_e io_master::dmi_req(uint64_t addr, io_dmi *dmi)
+  {
+    dmi->init();
+    return this->dmi_meth(this->slave_context_for_dmi, addr, dmi);
+  }
+
+
+
+  inline io_req_status_e io_master::dmi_req(uint64_t addr, io_dmi *dmi, io_slave *port)
+  {
+    dmi->init();
+
+    // Same as for bindings crossing partitions, see dmi_partition_cross_stub
+    vp::time_engine *engine = this->get_owner()->get_partition_engine();
+    vp::time_engine *remote_engine = port->get_owner()->get_partition_engine();
+    if (engine != NULL && remote_engine != NULL && engine != remote_engine)
+    {
+      return IO_REQ_INVALID;
+    }
+
+    return port->dmi_meth(port->get_context(), addr, dmi);
+  }
+
+
+
+
   inline io_req *io_master::req_new(uint64_t addr, uint8_t *data, uint64_t size, bool is_write)
   {
     // For now we allocate new requests but this would be better to manage a pool of requests
@@ -503,12 +644,25 @@ namespace vp {
 
 
 
+  inline void io_master::set_dmi_invalidate_meth(io_dmi_invalidate_meth_t *meth)
+  {
+    dmi_invalidate_meth = meth;
+  }
+
+
+
   inline void io_master::resp_default(void *, io_req *)
   {
   }
 
 
 
+  inline void io_master::dmi_invalidate_default(void *)
+  {
+  }
+
+
+
   inline void io_master::grant_default(void *, io_req *)
   {
   }
@@ -523,6 +677,9 @@ namespace vp {
     vp_assert(port != NULL, this->get_owner()->get_trace(),
       "Binding to NULL slave port\n");
 
+    this->dmi_meth = port->dmi_meth;
+    this->slave_context_for_dmi = port->get_context();
+
     if (port->req_meth_mux == NULL)
     {
       // Normal binding, just register the method and context into the master
@@ -571,6 +728,41 @@ namespace vp {
 
 
 
+  inline io_req_status_e io_master::req_partition_cross_stub(io_master *_this, io_req *req)
+  {
+    // The slave is executed by another thread, so its answer is only known when the
+    // request is delivered at the end of the quantum. The request is then denied to
+    // the master, which gets the grant once the slave accepted it. If the slave denies
+    // it as well, the grant is the one sent later by the slave. If the slave handles
+    // it synchronously, the response is sent back as if the slave had replied
+    // asynchronously.
+    _this->partition_defer([_this, req]() {
+      io_req_status_e status = io_master::req_freq_cross_stub(_this, req);
+
+      if (status == IO_REQ_DENIED)
+        return;
+
+      req->get_resp_port()->grant(req);
+
+      if (status == IO_REQ_OK || status == IO_REQ_INVALID)
+      {
+        req->status = status;
+        req->get_resp_port()->resp(req);
+      }
+    });
+
+    return IO_REQ_DENIED;
+  }
+
+
+
+  inline io_req_status_e io_master::dmi_partition_cross_stub(void *, uint64_t addr, io_dmi *dmi)
+  {
+    return IO_REQ_INVALID;
+  }
+
+
+
   inline void io_master::finalize()
   {
     vp_assert(this->get_owner() != NULL, NULL,
@@ -586,9 +778,11 @@ namespace vp {
     vp_assert(this->remote_port->get_owner()->get_clock() != NULL, this->get_comp()->get_trace(),
       "No remote port owner clock found when finalizing master binding\n");
 
+    bool partition_cross = this->is_partition_cross();
+
     // We have to instantiate a stub in case the binding is crossing different
     // frequency domains in order to resynchronize the target engine.
-    if (this->get_owner()->get_clock() != this->remote_port->get_owner()->get_clock())
+    if (partition_cross || this->get_owner()->get_clock() != this->remote_port->get_owner()->get_clock())
     {
       // Just save the normal handler and tweak it to enter the stub when the
       // master is pushing the request.
@@ -596,6 +790,12 @@ namespace vp {
       this->req_meth = (io_req_meth_t *)&io_master::req_freq_cross_stub;
       this->slave_context_for_freq_cross = this->get_remote_context();
       this->set_remote_context(this);
+
+      if (partition_cross)
+      {
+        this->req_meth = (io_req_meth_t *)&io_master::req_partition_cross_stub;
+        this->dmi_meth = &io_master::dmi_partition_cross_stub;
+      }
     }
   }
 
@@ -603,6 +803,7 @@ namespace vp {
 
   inline io_slave::io_slave() : req_meth(NULL), req_meth_mux(NULL) {
     req_meth = (io_req_meth_t *)&io_slave::req_default;
+    dmi_meth = &io_slave::dmi_default;
   }
 
 
@@ -617,7 +818,19 @@ namespace vp {
     port->slave_port->set_owner(this->get_owner());
     port->slave_port->master_resp_meth = port->resp_meth;
     port->slave_port->master_grant_meth = port->grant_meth;
+    port->slave_port->master_dmi_invalidate_meth = port->dmi_invalidate_meth;
+    port->slave_port->master_context_for_dmi = port->get_context();
     port->slave_port->set_remote_context(port->get_context());
+    this->master_ports.push_back(port->slave_port);
+  }
+
+
+  inline void io_slave::dmi_invalidate()
+  {
+    for (io_slave *port: this->master_ports)
+    {
+      port->master_dmi_invalidate_meth(port->master_context_for_dmi);
+    }
   }
 
 
@@ -638,6 +851,13 @@ namespace vp {
 
 
 
+  inline void io_slave::set_dmi_meth(io_dmi_meth_t *meth)
+  {
+    this->dmi_meth = meth;
+  }
+
+
+
   inline io_req_status_e io_slave::req_default(io_slave *, io_req *)
   {
     return IO_REQ_OK;
@@ -645,6 +865,13 @@ namespace vp {
 
 
 
+  inline io_req_status_e io_slave::dmi_default(void *, uint64_t, io_dmi *)
+  {
+    return IO_REQ_INVALID;
+  }
+
+
+
   inline void io_slave::grant_freq_cross_stub(io_slave *_this, io_req *req)
   {
     // The normal callback was tweaked in order to get there when the master is sending a
@@ -669,6 +896,20 @@ namespace vp {
 
 
 
+  inline void io_slave::grant_partition_cross_stub(io_slave *_this, io_req *req)
+  {
+    _this->partition_defer([_this, req]() { io_slave::grant_freq_cross_stub(_this, req); });
+  }
+
+
+
+  inline void io_slave::resp_partition_cross_stub(io_slave *_this, io_req *req)
+  {
+    _this->partition_defer([_this, req]() { io_slave::resp_freq_cross_stub(_this, req); });
+  }
+
+
+
   inline void io_slave::set_freq_stub()
   {
       // Just save the normal handler and tweak it to enter the stub when the
@@ -681,6 +922,16 @@ namespace vp {
       
       this->master_context_for_freq_cross = this->get_remote_context();
       this->set_remote_context(this);
+
+      if (this->is_partition_cross())
+      {
+        this->master_grant_meth = (void (*)(void *, io_req *))&io_slave::grant_partition_cross_stub;
+        this->master_resp_meth = (void (*)(void *, io_req *))&io_slave::resp_partition_cross_stub;
+
+        // No direct access can be granted across partitions, so there is nothing to
+        // invalidate, and the master must not be called from this thread
+        this->master_dmi_invalidate_meth = &io_master::dmi_invalidate_default;
+      }
   }
 
 
@@ -688,7 +939,8 @@ namespace vp {
   {
     // We have to instantiate a stub in case the binding is crossing different
     // frequency domains in order to resynchronize the target engine.
-    if (this->remote_port && this->get_owner()->get_clock() != this->remote_port->get_owner()->get_clock())
+    if (this->remote_port && (this->get_owner()->get_clock() != this->remote_port->get_owner()->get_clock() ||
+      this->is_partition_cross()))
     {
       this->set_freq_stub();
 
@@ -32,6 +32,26 @@ namespace vp {
 
 
 
+  // Whole SPI transaction, from chip select assertion to deassertion, which can be
+  // transferred in one call to slaves supporting it instead of one call per clock edge.
+  class qspim_burst
+  {
+  public:
+    // Command byte
+    int cmd;
+    // Address, for commands having one
+    uint32_t addr;
+    // Number of data bytes
+    int size;
+    // Data to be written, or filled by the slave with the data read
+    uint8_t *data;
+    // Filled by the slave with the number of SPI clock cycles the transaction would
+    // have taken in pin-level mode, so that the master can account for the same duration.
+    int64_t duration;
+  };
+
+
+
   typedef void (qspim_sync_meth_t)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
   typedef void (qspim_cs_sync_meth_t)(void *, int cs, int active);
 
@@ -41,6 +61,10 @@ namespace vp {
   typedef void (qspim_slave_sync_meth_t)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
   typedef void (qspim_slave_sync_meth_muxed_t)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int id);
 
+  // Returns false if the slave can not handle this command in burst mode, in which
+  // case the master must send it in pin-level mode
+  typedef bool (qspim_burst_meth_t)(void *, qspim_burst *burst);
+
 
 
   class qspim_master : public vp::master_port
@@ -61,6 +85,12 @@ namespace vp {
       return cs_sync_meth(this->get_remote_context(), cs, active);
     }
 
+    // Send a whole transaction, must only be called if the slave is burst capable
+    inline bool burst(qspim_burst *burst)
+    {
+      return burst_meth(this->get_remote_context(), burst);
+    }
+
     void bind_to(vp::port *port, vp::config *config);
 
     inline void set_sync_meth(qspim_slave_sync_meth_t *meth);
@@ -69,6 +99,10 @@ namespace vp {
 
     bool is_bound() { return slave_port != NULL; }
 
+    // Tells if the slave can receive transactions in burst mode. This is known once
+    // the port is bound, slaves bound through a multiplexer only support pin-level mode.
+    bool is_burst_capable() { return burst_meth != NULL; }
+
   private:
 
     static inline void sync_muxed_stub(qspim_master *_this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
@@ -81,6 +115,7 @@ namespace vp {
     void (*sync_meth_mux)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int mux);
     void (*cs_sync_meth)(void *, int cs, int active);
     void (*cs_sync_meth_mux)(void *, int cs, int active, int mux);
+    qspim_burst_meth_t *burst_meth = NULL;
 
     static inline void sync_default(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
 
@@ -114,6 +149,8 @@ namespace vp {
     inline void set_cs_sync_meth(qspim_cs_sync_meth_t *meth);
     inline void set_cs_sync_meth_muxed(qspim_cs_sync_meth_muxed_t *meth, int id);
 
+    inline void set_burst_meth(qspim_burst_meth_t *meth);
+
     inline void bind_to(vp::port *_port, vp::config *config);
 
   private:
@@ -128,6 +165,7 @@ namespace vp {
     void (*sync_mux_meth)(void *comp, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int mux);
     void (*cs_sync)(void *comp, int cs, int active);
     void (*cs_sync_mux)(void *comp, int cs, int active, int mux);
+    qspim_burst_meth_t *burst_meth = NULL;
 
     static inline void sync_default(qspim_slave *, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
     static inline void cs_sync_default(qspim_slave *, int cs, int active);
@@ -169,6 +207,7 @@ namespace vp {
     {
       sync_meth = port->sync_meth;
       cs_sync_meth = port->cs_sync;
+      burst_meth = port->burst_meth;
       this->set_remote_context(port->get_context());
     }
     else
@@ -244,6 +283,11 @@ namespace vp {
     cs_sync_mux = NULL;
   }
 
+  inline void qspim_slave::set_burst_meth(qspim_burst_meth_t *meth)
+  {
+    burst_meth = meth;
+  }
+
   inline void qspim_slave::set_sync_meth_muxed(qspim_sync_meth_muxed_t *meth, int id)
   {
     sync_mux_meth = meth;
@@ -25,12 +25,14 @@
 
 #include "vp/vp_data.hpp"
 #include "vp/config.hpp"
+#include <functional>
 
 namespace vp
 {
 
 class slave_port;
 class component;
+class time_engine;
 
 class port
 {
@@ -78,6 +80,15 @@ public:
     // Tell if the port is bound to another port
     bool is_bound = false;
 
+    // Tell if the owner of this port and the owner of the remote port are executed
+    // by different partitions of the parallel mode, in which case calls through this
+    // port must be deferred with partition_defer.
+    bool is_partition_cross();
+
+    // Defer a call to the partition of the remote port until the end of the current
+    // quantum. Can only be used if is_partition_cross returned true.
+    void partition_defer(std::function<void()> callback);
+
 protected:
     // Component owner of this port.
     // The port is considered in the same domains as the owner component.
@@ -98,6 +109,11 @@ protected:
 
     // Name of the port defined in the component, can used for debug purposes.
     std::string name = "";
+
+    // Engine of the partition executing the owner and index of the remote one,
+    // only valid when the port is crossing partitions.
+    vp::time_engine *partition_engine = NULL;
+    int remote_partition_id = 0;
 };
 
 class master_port : public port
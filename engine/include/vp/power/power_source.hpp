@@ -104,8 +104,8 @@ inline void vp::power::power_source::dynamic_power_stop()
 inline void vp::power::power_source::account_energy_quantum()
 {
     // Only account energy is a quantum is defined
-    if (this->is_on && this->is_dynamic_power_on && this->quantum != -1)
+    if (this->quantum_is_on)
     {
-        this->trace->inc_dynamic_energy(this->quantum);
+        this->trace->account_quantum(this->quantum);
     }
 }
@@ -27,13 +27,59 @@
 
 inline double vp::power::power_trace::get_power()
 {
+    this->flush_pending_energy();
+
     return this->current_power;
 }
 
 
 
+inline void vp::power::power_trace::account_quantum(double energy)
+{
+    // The sum is accounted from an event executed by the clock engine once all the
+    // events of the cycle have been executed, so that the accounting is done only
+    // once per cycle with the same timestamp.
+    if (unlikely(!this->has_pending_energy))
+    {
+        // Quanta can also be accounted while the clock engine is not executing its
+        // events, for example when the component is accessed from another clock
+        // domain. There is then no end of cycle to sum them, account them directly.
+        vp::clock_engine *clock = this->top->get_clock();
+        if (clock == NULL || clock->get_period() == 0 || !clock->is_running())
+        {
+            this->inc_dynamic_energy(energy);
+            return;
+        }
+
+        this->has_pending_energy = true;
+        this->pending_energy = 0;
+
+        if (!this->pending_energy_event->is_enqueued())
+        {
+            clock->enqueue_cycle_end(this->pending_energy_event);
+        }
+    }
+
+    this->pending_energy += energy;
+}
+
+
+
+inline void vp::power::power_trace::flush_pending_energy()
+{
+    if (unlikely(this->has_pending_energy))
+    {
+        this->has_pending_energy = false;
+        this->inc_dynamic_energy(this->pending_energy);
+    }
+}
+
+
+
 inline double vp::power::power_trace::get_quantum_power_for_cycle()
 {
+    this->flush_pending_energy();
+
     // First check if the current energy is for an old cycle
     this->flush_quantum_power_for_cycle();
 
@@ -75,6 +121,8 @@ inline void vp::power::power_trace::flush_quantum_power_for_cycle()
 
 inline double vp::power::power_trace::get_report_dynamic_energy()
 {
+    this->flush_pending_energy();
+
     // First convert background power to energy
     this->account_dynamic_power();
     
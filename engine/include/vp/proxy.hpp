@@ -29,6 +29,7 @@ class Gv_proxy : vp::Notifier
     void notify_stop();
     void notify_run();
     bool send_payload(FILE *reply_file, std::string req, uint8_t *payload, int size);
+    void send_payload_header(FILE *reply_file, std::string req, uint64_t size);
     
   private:
  
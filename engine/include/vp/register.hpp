@@ -25,6 +25,8 @@
 
 namespace vp
 {
+    class checkpoint;
+
     class regfield
     {
         public:
@@ -42,6 +44,7 @@ namespace vp
         std::string get_name() { return this->name != "" ? this->name : this->hw_name; }
         void init(vp::component *top, std::string name, int bits, uint8_t *value, uint8_t *reset_val);
         void reset(bool active);
+        void checkpoint(vp::checkpoint *cp);
         virtual void access(uint64_t reg_offset, int size, uint8_t *value, bool is_write) {}
         virtual void update(uint64_t reg_offset, int size, uint8_t *value, bool is_write) {}
 
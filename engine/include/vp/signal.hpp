@@ -33,6 +33,7 @@ namespace vp {
         int64_t get() { return this->value; }
         uint64_t getu() { return this->value; }
         void reset(bool active);
+        void checkpoint(vp::checkpoint *cp);
     private:
         int64_t value;
         int64_t reset_value;
@@ -39,8 +39,15 @@ class time_engine : public component
 public:
     time_engine(js::config *config);
 
+    // Constructor of the engines executing the partitions of the parallel mode
+    time_engine(time_engine *parent, int partition_id);
+
+    ~time_engine();
+
     void start();
 
+    void stop();
+
     void run_loop();
 
     int64_t step(int64_t timestamp);
@@ -83,6 +90,13 @@ public:
 
     int64_t get_time() { return time; }
 
+    // Tell if the client being executed can directly move the time forward by
+    // the specified amount, which is the case if no other client needs to be
+    // executed before and nobody asked the engine to stop.
+    inline bool can_advance(int64_t time);
+
+    inline void advance(int64_t time) { this->time += time; }
+
     inline void retain() { retain_count++; }
     inline void release() { retain_count--; }
 
@@ -92,8 +106,55 @@ public:
 
     void wait_ready();
 
+    // Save or restore the current time. Clients still enqueued when restoring
+    // keep the same distance to the current time.
+    void checkpoint(vp::checkpoint *cp);
+
+    inline int get_partition_id() { return this->partition_id; }
+
+    // Partition executed by the current thread in parallel mode, NULL when no
+    // partition is being executed
+    static thread_local time_engine *current_partition;
+
+    // Defer a call to a component executed by another partition of the parallel
+    // mode. Calls are delivered at the end of the quantum, when no partition is running.
+    inline void defer(int partition_id, std::function<void()> callback)
+    {
+        this->deferred[partition_id].push_back(callback);
+    }
+
 private:
-    time_engine_client *first_client = NULL;
+    // Parallel mode.
+    // The clock engines are partitioned onto several time engines, each one executed
+    // by its own thread. They all advance by quanta of the same duration, and calls
+    // crossing partitions are deferred until the end of the quantum.
+    void parallel_init();
+    void parallel_run();
+    void parallel_report();
+    void parallel_quit();
+    static void *partition_routine(void *arg);
+    void partition_loop();
+    void exec_quantum(int64_t end);
+    void flush_deferred();
+    inline bool has_clients();
+    inline int get_retain_count();
+
+    // Clients are kept in a binary heap ordered by their next event time so that
+    // enqueueing, dequeueing and getting the next one do not depend linearly on
+    // the number of clock domains.
+    inline time_engine_client *first_client();
+    inline bool client_is_before(time_engine_client *a, time_engine_client *b);
+    inline void client_set(int index, time_engine_client *client);
+    inline void client_sift_up(int index);
+    inline void client_sift_down(int index);
+    inline void client_push(time_engine_client *client);
+    inline time_engine_client *client_pop();
+    inline void client_remove(time_engine_client *client);
+
+    std::vector<time_engine_client *> clients;
+    // Incremented each time a client is pushed, used to keep the order of
+    // clients with the same time, the last pushed one being executed first.
+    int64_t client_seq = 0;
     bool locked = false;
     bool locked_run_req;
     bool run_req;
@@ -122,6 +183,34 @@ private:
 private:
     vp::component *stop_event;
     std::vector<Notifier *> exec_notifiers;
+
+    // Engine of the whole simulation when this one is executing a partition
+    time_engine *parent = NULL;
+    int partition_id = 0;
+    // All partitions, including this engine as the first one, only on the top engine
+    std::vector<time_engine *> partitions;
+    std::vector<std::string> partition_paths;
+    // Calls deferred by this partition, one queue per destination partition
+    std::vector<std::vector<std::function<void()>>> deferred;
+    // Client pushed at the end of the quantum so that the partition stops there
+    time_engine_client *quantum_end_client = NULL;
+    int64_t quantum = 0;
+    int64_t quantum_end = 0;
+    bool parallel_started = false;
+    // Set when the partition threads must exit, read after the quantum start barrier
+    bool parallel_stop = false;
+    // Set if the engine thread was cancelled, the partition threads can then be
+    // blocked in a barrier and are not joined
+    bool parallel_cancelled = false;
+    std::vector<pthread_t> partition_threads;
+    pthread_barrier_t quantum_start_barrier;
+    pthread_barrier_t quantum_end_barrier;
+    // Statistics reported at the end of the simulation
+    int64_t busy_time = 0;
+    int64_t parallel_time = 0;
+    int64_t nb_quanta = 0;
+    int64_t nb_deferred = 0;
+    int nb_clock_engines = 0;
 };
 
 class time_engine_client : public component
@@ -152,7 +241,10 @@ public:
     virtual int64_t exec() = 0;
 
 protected:
-    time_engine_client *next;
+    // Position of the client in the time engine heap
+    int heap_index = -1;
+    // Push sequence number, to order clients with the same time
+    int64_t heap_seq = 0;
 
     // This gives the time of the next event.
     // It is only valid when the client is not the currently active one,
@@ -169,6 +261,12 @@ protected:
 // to the main python thread which will take care of stopping the engine.
 inline void vp::time_engine::stop_engine(int status, bool force, bool no_retain)
 {
+    if (this->parent)
+    {
+        this->parent->stop_engine(status, force, no_retain);
+        return;
+    }
+
     if (!this->engine_has_been_stopped)
     {
         this->engine_has_been_stopped = true;
@@ -198,8 +296,114 @@ inline void vp::time_engine::stop_engine(int status, bool force, bool no_retain)
 }
 
 
+inline vp::time_engine_client *vp::time_engine::first_client()
+{
+    return this->clients.size() ? this->clients[0] : NULL;
+}
+
+inline bool vp::time_engine::client_is_before(time_engine_client *a, time_engine_client *b)
+{
+    return a->next_event_time < b->next_event_time ||
+        (a->next_event_time == b->next_event_time && a->heap_seq > b->heap_seq);
+}
+
+inline void vp::time_engine::client_set(int index, time_engine_client *client)
+{
+    this->clients[index] = client;
+    client->heap_index = index;
+}
+
+inline void vp::time_engine::client_sift_up(int index)
+{
+    time_engine_client *client = this->clients[index];
+    while (index > 0)
+    {
+        int parent = (index - 1) >> 1;
+        if (!this->client_is_before(client, this->clients[parent]))
+            break;
+        this->client_set(index, this->clients[parent]);
+        index = parent;
+    }
+    this->client_set(index, client);
+}
+
+inline void vp::time_engine::client_sift_down(int index)
+{
+    int size = this->clients.size();
+    time_engine_client *client = this->clients[index];
+    while (1)
+    {
+        int child = (index << 1) + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && this->client_is_before(this->clients[child + 1], this->clients[child]))
+            child++;
+        if (!this->client_is_before(this->clients[child], client))
+            break;
+        this->client_set(index, this->clients[child]);
+        index = child;
+    }
+    this->client_set(index, client);
+}
+
+inline void vp::time_engine::client_push(time_engine_client *client)
+{
+    client->heap_seq = this->client_seq++;
+    client->is_enqueued = true;
+    this->clients.push_back(client);
+    this->client_sift_up(this->clients.size() - 1);
+}
+
+inline vp::time_engine_client *vp::time_engine::client_pop()
+{
+    time_engine_client *client = this->clients[0];
+    time_engine_client *last = this->clients.back();
+    this->clients.pop_back();
+    if (last != client)
+    {
+        this->client_set(0, last);
+        this->client_sift_down(0);
+    }
+    client->heap_index = -1;
+    client->is_enqueued = false;
+    return client;
+}
+
+inline void vp::time_engine::client_remove(time_engine_client *client)
+{
+    int index = client->heap_index;
+    time_engine_client *last = this->clients.back();
+    this->clients.pop_back();
+    if (last != client)
+    {
+        this->client_set(index, last);
+        if (index > 0 && this->client_is_before(last, this->clients[(index - 1) >> 1]))
+            this->client_sift_up(index);
+        else
+            this->client_sift_down(index);
+    }
+    client->heap_index = -1;
+    client->is_enqueued = false;
+}
+
+inline bool vp::time_engine::can_advance(int64_t time)
+{
+#if defined(__VP_USE_SYSTEMC) || defined(__VP_USE_SYSTEMV)
+    return false;
+#else
+    time_engine_client *next = this->first_client();
+    return this->run_req && (next == NULL || next->next_event_time >= this->time + time);
+#endif
+}
+
 inline void vp::time_engine::stop_retain(int count)
 {
+    if (this->parent)
+    {
+        this->parent->stop_retain(count);
+        return;
+    }
+
     this->stop_retain_count += count;
 }
 
@@ -221,6 +425,12 @@ inline void vp::time_engine::pause()
 
 inline void vp::time_engine::wait_running()
 {
+    if (this->parent)
+    {
+        this->parent->wait_running();
+        return;
+    }
+
     pthread_mutex_lock(&mutex);
     while (!init)
         pthread_cond_wait(&cond, &mutex);
@@ -251,6 +461,12 @@ inline void vp::time_engine::lock_step_cancel()
 
 inline void vp::time_engine::lock()
 {
+    if (this->parent)
+    {
+        this->parent->lock();
+        return;
+    }
+
     pthread_mutex_lock(&mutex);
     if (!locked)
     {
@@ -266,6 +482,12 @@ inline void vp::time_engine::lock()
 
 inline void vp::time_engine::unlock()
 {
+    if (this->parent)
+    {
+        this->parent->unlock();
+        return;
+    }
+
     pthread_mutex_lock(&mutex);
     run_req = locked_run_req;
     locked = false;
@@ -291,6 +513,38 @@ inline void vp::time_engine::update(int64_t time)
         this->time = time;
 }
 
+inline bool vp::time_engine::has_clients()
+{
+    // In parallel mode, the other partitions can also have clients or deferred calls
+    // which will enqueue clients
+    for (time_engine *partition: this->partitions)
+    {
+        if (partition->first_client())
+            return true;
+
+        for (auto &queue: partition->deferred)
+        {
+            if (queue.size())
+                return true;
+        }
+    }
+
+    return this->first_client() != NULL;
+}
+
+inline int vp::time_engine::get_retain_count()
+{
+    int count = this->retain_count;
+
+    for (time_engine *partition: this->partitions)
+    {
+        if (partition != this)
+            count += partition->retain_count;
+    }
+
+    return count;
+}
+
 }; // namespace vp
 
 #endif
@@ -28,11 +28,53 @@
 #include "gv/gvsoc.hpp"
 #include <pthread.h>
 #include <thread>
+#include <atomic>
 
 namespace vp {
 
   #define TRACE_EVENT_BUFFER_SIZE (1<<16)
   #define TRACE_EVENT_NB_BUFFER   4
+  // Maximum number of event buffers, must be a power of 2
+  #define TRACE_EVENT_MAX_BUFFER  256
+
+  // What to do when the dumper thread is late and no buffer of events is free
+  typedef enum
+  {
+    TRACE_BUFFER_POLICY_BLOCK,  // Wait until the dumper thread releases a buffer
+    TRACE_BUFFER_POLICY_DROP,   // Drop the events and count them
+    TRACE_BUFFER_POLICY_GROW,   // Allocate a new buffer, up to TRACE_EVENT_MAX_BUFFER
+  } trace_buffer_policy_e;
+
+  // Lock-free ring of event buffers, between one producer thread and one
+  // consumer thread.
+  class trace_buffer_ring
+  {
+  public:
+    inline bool push(char *buffer)
+    {
+      unsigned int tail = this->tail.load(std::memory_order_relaxed);
+      if (tail - this->head.load(std::memory_order_acquire) == TRACE_EVENT_MAX_BUFFER)
+        return false;
+      this->buffers[tail & (TRACE_EVENT_MAX_BUFFER - 1)] = buffer;
+      this->tail.store(tail + 1, std::memory_order_seq_cst);
+      return true;
+    }
+
+    inline char *pop()
+    {
+      unsigned int head = this->head.load(std::memory_order_relaxed);
+      if (head == this->tail.load(std::memory_order_seq_cst))
+        return NULL;
+      char *buffer = this->buffers[head & (TRACE_EVENT_MAX_BUFFER - 1)];
+      this->head.store(head + 1, std::memory_order_release);
+      return buffer;
+    }
+
+  private:
+    char *buffers[TRACE_EVENT_MAX_BUFFER];
+    std::atomic<unsigned int> head{0};
+    std::atomic<unsigned int> tail{0};
+  };
 
   #define TRACE_FORMAT_LONG  0
   #define TRACE_FORMAT_SHORT 1
@@ -89,6 +131,8 @@ namespace vp {
     char *get_event_buffer(int bytes);
     void vcd_routine();
     void flush();
+    void push_ready_buffer(char *buffer);
+    char *pop_free_buffer();
     void check_pending_events(int64_t timestamp);
     void dump_event_to_buffer(vp::trace *trace, int64_t timestamp, uint8_t *event, int bytes, bool include_size=false);
 
@@ -98,13 +142,28 @@ namespace vp {
     // the same timestamp.
     void flush_event_traces(int64_t timestamp);
 
-    vector<char *> event_buffers;
-    vector<char *> ready_event_buffers;
+    // Buffers are exchanged with the dumper thread through lock-free rings. The mutex
+    // and the condition are only used when one of the thread needs to sleep, which
+    // is indicated with the waiting flags so that the other thread only wakes it
+    // up in this case.
+    trace_buffer_ring event_buffers;
+    trace_buffer_ring ready_event_buffers;
     char *current_buffer;
     int current_buffer_size;
     pthread_mutex_t mutex;
     pthread_cond_t cond;
-    int end = 0;
+    std::atomic<bool> producer_waiting{false};
+    std::atomic<bool> dumper_waiting{false};
+    std::atomic<int> end{0};
+
+    trace_buffer_policy_e buffer_policy = TRACE_BUFFER_POLICY_BLOCK;
+    int nb_buffers;
+    // Spare buffer used to write events which are dropped
+    char *drop_buffer = NULL;
+    // Number of times the simulation thread had to wait for the dumper thread
+    int64_t nb_producer_stalls = 0;
+    // Number of buffers of events dropped because the dumper thread was late
+    int64_t nb_dropped_buffers = 0;
     std::thread *thread;
     trace *first_pending_event;
 
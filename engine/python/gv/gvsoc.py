@@ -56,8 +56,18 @@ def appendArgs(parser: argparse.ArgumentParser, runnerConfig: js.config) -> None
 
     parser.add_argument("--event-format", dest="format", default=None, help="Specify events format (vcd or fst)")
 
+    parser.add_argument("--event-buffer-policy", dest="event_buffer_policy", default=None,
+                        choices=['block', 'drop', 'grow'],
+                        help="Specify what to do when the events dumper is late (block, drop or grow)")
+
     parser.add_argument("--gtkwi", dest="gtkwi", action="store_true", help="Dump events to pipe and open gtkwave in interactive mode")
 
+    parser.add_argument("--parallel-partition", dest="parallel_partitions", default=[], action="append",
+                        help="Simulate the clock domains under this component path on a separate thread")
+
+    parser.add_argument("--parallel-quantum", dest="parallel_quantum", default=None, type=int,
+                        help="Specify the synchronization quantum of the parallel mode, in picoseconds")
+
 
 def process_args(args, config):
     for trace in args.traces:
@@ -82,9 +92,18 @@ def process_args(args, config):
     if args.format is not None:
         config.set('gvsoc/events/format', args.format)
 
+    if args.event_buffer_policy is not None:
+        config.set('gvsoc/events/buffer_policy', args.event_buffer_policy)
+
     if args.gtkwi:
         config.set('gvsoc/events/gtkw', True)
 
+    for partition in args.parallel_partitions:
+        config.set('gvsoc/parallel/partitions', partition)
+
+    if args.parallel_quantum is not None:
+        config.set('gvsoc/parallel/quantum', args.parallel_quantum)
+
 
 def prepare_exec(config, full_config, gen=False):
 
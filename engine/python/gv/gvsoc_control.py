@@ -18,6 +18,7 @@ import socket
 import threading
 import socket
 import os
+import struct
 
 
 
@@ -315,6 +316,34 @@ class Proxy(object):
 
 
 
+    def checkpoint_save(self, path: str):
+        """Save the state of the whole simulation into a checkpoint.
+
+        Execution must be stopped.
+
+        :param path: Path of the checkpoint file
+        :raises: RuntimeError, if the checkpoint can not be written.
+        """
+
+        reply = self._send_cmd('checkpoint save %s' % path)
+        if reply != 'ok':
+            raise RuntimeError('Failed to save checkpoint: %s' % reply)
+
+    def checkpoint_restore(self, path: str):
+        """Restore the state of the whole simulation from a checkpoint.
+
+        The checkpoint must have been saved from the same platform. Execution must be stopped.
+
+        :param path: Path of the checkpoint file
+        :raises: RuntimeError, if the checkpoint can not be read or does not match the platform.
+        """
+
+        reply = self._send_cmd('checkpoint restore %s' % path)
+        if reply != 'ok':
+            raise RuntimeError('Failed to restore checkpoint: %s' % reply)
+
+
+
     def quit(self, status: int = 0):
         """Exit simulation.
 
@@ -411,6 +440,72 @@ class Router(object):
         return reply
 
 
+    def mem_batch(self, accesses: list) -> list:
+        """Inject a batch of memory accesses.
+
+        All the accesses are sent in a single binary message and executed in order,
+        which is much faster than one mem_read or mem_write per access when
+        many small accesses are needed.
+        The accesses are generated by the router where this class is connected and are
+        injected as debug requests to not disturb the timing.
+
+        :param accesses: list, The accesses, each being a tuple (addr, size) for a read,
+            or (addr, size, values) for a write, values being the sequence of bytes to be
+            written, in little endian byte ordering.
+
+        :return: list, For each access, the sequence of bytes read for a read, or None for a write.
+
+        :raises: RuntimeError, if any access generates an error in the architecture.
+        """
+
+        descs = bytearray()
+        write_data = []
+        read_size = 0
+        for access in accesses:
+            if len(access) == 3:
+                addr, size, values = access
+                if len(values) != size:
+                    raise RuntimeError('Invalid write size (expected: %d, got: %d)' % (size, len(values)))
+                descs += struct.pack('<QII', addr, size, 1)
+                write_data.append(values)
+            else:
+                addr, size = access
+                descs += struct.pack('<QII', addr, size, 0)
+                read_size += size
+
+        cmd = 'component %s mem_batch %d' % (self.component, len(accesses))
+
+        # The descriptors and the write data must follow the command, so
+        # the command queue is kept locked until everything is sent
+        req = self.proxy._send_cmd(cmd, keep_lock=True, wait_reply=False)
+        self.proxy.socket.sendall(descs)
+        for values in write_data:
+            self.proxy.socket.sendall(values)
+
+        payload = self.proxy.reader._get_payload(req)
+
+        self.proxy._unlock_cmd()
+
+        self.proxy.reader.wait_reply(req)
+
+        if len(payload) != read_size + len(accesses):
+            raise RuntimeError('Memory batch rejected (nb_accesses: %d)' % len(accesses))
+
+        status = payload[read_size:]
+        result = []
+        offset = 0
+        for index, access in enumerate(accesses):
+            if status[index] != 0:
+                raise RuntimeError('Memory access failed (addr: 0x%x, size: 0x%x)' % (access[0], access[1]))
+
+            if len(access) == 3:
+                result.append(None)
+            else:
+                result.append(bytes(payload[offset:offset + access[1]]))
+                offset += access[1]
+
+        return result
+
     def mem_write_int(self, addr: int, size: int, value: int):
         """Write an integer.
 
@@ -21,6 +21,7 @@
 
 #include <vp/vp.hpp>
 #include <vp/signal.hpp>
+#include <vp/checkpoint.hpp>
 
 vp::block::block(block *parent)
     : parent(parent)
@@ -48,6 +49,22 @@ void vp::block::reset_all(bool active)
 }
 
 
+void vp::block::checkpoint_all(vp::checkpoint *cp)
+{
+    for (block *block: this->subblocks)
+    {
+        block->checkpoint_all(cp);
+    }
+
+    for (signal *signal: this->signals)
+    {
+        signal->checkpoint(cp);
+    }
+
+    this->checkpoint(cp);
+}
+
+
 void vp::block::add_block(block *block)
 {
     this->subblocks.push_back(block);
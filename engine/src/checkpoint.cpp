@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#include <string.h>
+#include <stdexcept>
+#include <vp/vp.hpp>
+#include <vp/checkpoint.hpp>
+
+#define CHECKPOINT_MAGIC   0x4b435047
+#define CHECKPOINT_VERSION 1
+
+// Tags preceding each page in the file
+#define CHECKPOINT_PAGE_ZERO 0
+#define CHECKPOINT_PAGE_DUP  1
+#define CHECKPOINT_PAGE_DATA 2
+
+vp::checkpoint::checkpoint(std::string path, bool is_restore)
+    : path(path), restore(is_restore)
+{
+    this->file = gzopen(path.c_str(), is_restore ? "rb" : "wb6");
+    if (this->file == NULL)
+    {
+        throw std::runtime_error("Unable to open checkpoint (path: " + path + ", error: " + strerror(errno) + ")");
+    }
+
+    uint32_t magic = CHECKPOINT_MAGIC;
+    uint32_t version = CHECKPOINT_VERSION;
+
+    this->value(magic);
+    this->value(version);
+
+    if (magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION)
+    {
+        gzclose(this->file);
+        throw std::runtime_error("Invalid checkpoint (path: " + path + ")");
+    }
+}
+
+vp::checkpoint::~checkpoint()
+{
+    gzclose(this->file);
+}
+
+void vp::checkpoint::write(void *data, size_t size)
+{
+    if (size > 0 && gzwrite(this->file, data, size) != (int)size)
+    {
+        int errnum;
+        throw std::runtime_error("Failed to write checkpoint (path: " + this->path + ", error: " + gzerror(this->file, &errnum) + ")");
+    }
+}
+
+void vp::checkpoint::read(void *data, size_t size)
+{
+    if (size > 0 && gzread(this->file, data, size) != (int)size)
+    {
+        throw std::runtime_error("Truncated checkpoint (path: " + this->path + ")");
+    }
+}
+
+void vp::checkpoint::data(void *data, size_t size)
+{
+    if (this->restore)
+    {
+        this->read(data, size);
+    }
+    else
+    {
+        this->write(data, size);
+    }
+}
+
+void vp::checkpoint::section(std::string name)
+{
+    uint32_t size = name.size();
+    this->value(size);
+
+    if (this->restore)
+    {
+        std::string saved_name(size, '\0');
+        this->read(&saved_name[0], size);
+        if (saved_name != name)
+        {
+            throw std::runtime_error("Checkpoint does not match the platform (expected: " + name +
+                ", found: " + saved_name + ")");
+        }
+    }
+    else
+    {
+        this->write(&name[0], size);
+    }
+}
+
+uint64_t vp::checkpoint::page_hash(uint8_t *data, size_t size)
+{
+    // FNV-1a on 64 bits words, only used to find candidates for deduplication
+    uint64_t hash = 0xcbf29ce484222325;
+    uint64_t *words = (uint64_t *)data;
+    for (size_t i = 0; i < size / sizeof(uint64_t); i++)
+    {
+        hash = (hash ^ words[i]) * 0x100000001b3;
+    }
+    return hash;
+}
+
+static bool page_is_zero(uint8_t *data, size_t size)
+{
+    uint64_t *words = (uint64_t *)data;
+    for (size_t i = 0; i < size / sizeof(uint64_t); i++)
+    {
+        if (words[i] != 0)
+        {
+            return false;
+        }
+    }
+    for (size_t i = size & ~(sizeof(uint64_t) - 1); i < size; i++)
+    {
+        if (data[i] != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void vp::checkpoint::pages(uint8_t *data, size_t size)
+{
+    uint64_t saved_size = size;
+    this->value(saved_size);
+    if (saved_size != size)
+    {
+        throw std::runtime_error("Checkpoint memory size mismatch (expected: " + std::to_string(size) +
+            ", found: " + std::to_string(saved_size) + ")");
+    }
+
+    for (size_t offset = 0; offset < size; offset += CHECKPOINT_PAGE_SIZE)
+    {
+        uint8_t *page = data + offset;
+        size_t page_size = std::min((size_t)CHECKPOINT_PAGE_SIZE, size - offset);
+        // Only full pages are deduplicated, so that all pages in the list have
+        // the same size
+        bool full_page = page_size == CHECKPOINT_PAGE_SIZE;
+        uint8_t tag;
+
+        if (this->restore)
+        {
+            this->read(&tag, 1);
+
+            if (tag == CHECKPOINT_PAGE_ZERO)
+            {
+                if (!page_is_zero(page, page_size))
+                {
+                    memset(page, 0, page_size);
+                }
+            }
+            else if (tag == CHECKPOINT_PAGE_DUP)
+            {
+                uint32_t id;
+                this->value(id);
+                if (id >= this->page_list.size() || !full_page)
+                {
+                    throw std::runtime_error("Invalid checkpoint page (path: " + this->path + ")");
+                }
+                if (memcmp(page, this->page_list[id], page_size) != 0)
+                {
+                    memcpy(page, this->page_list[id], page_size);
+                }
+            }
+            else
+            {
+                uint8_t buffer[CHECKPOINT_PAGE_SIZE];
+                this->read(buffer, page_size);
+                if (memcmp(page, buffer, page_size) != 0)
+                {
+                    memcpy(page, buffer, page_size);
+                }
+                if (full_page)
+                {
+                    this->page_list.push_back(page);
+                }
+            }
+        }
+        else
+        {
+            if (page_is_zero(page, page_size))
+            {
+                tag = CHECKPOINT_PAGE_ZERO;
+                this->write(&tag, 1);
+                continue;
+            }
+
+            if (full_page)
+            {
+                uint64_t hash = this->page_hash(page, page_size);
+                auto range = this->page_hashes.equal_range(hash);
+                bool found = false;
+                for (auto it = range.first; it != range.second; it++)
+                {
+                    if (memcmp(page, this->page_list[it->second], page_size) == 0)
+                    {
+                        uint32_t id = it->second;
+                        tag = CHECKPOINT_PAGE_DUP;
+                        this->write(&tag, 1);
+                        this->write(&id, sizeof(id));
+                        found = true;
+                        break;
+                    }
+                }
+
+                if (found)
+                {
+                    continue;
+                }
+
+                this->page_hashes.insert({hash, (uint32_t)this->page_list.size()});
+                this->page_list.push_back(page);
+            }
+
+            tag = CHECKPOINT_PAGE_DATA;
+            this->write(&tag, 1);
+            this->write(page, page_size);
+        }
+    }
+}
@@ -26,6 +26,17 @@
 
 void vp::power::power_source::setup(double temp, double volt, double freq)
 {
+    // Power numbers are only estimated from the tables when the operating point changes,
+    // so that they are directly available when power is accounted
+    if (temp == this->setup_temp && volt == this->setup_volt && freq == this->setup_freq)
+    {
+        return;
+    }
+
+    this->setup_temp = temp;
+    this->setup_volt = volt;
+    this->setup_freq = freq;
+
     // When temperature, voltage or frequency is modified, only impact dynamic energy quantum,
     // dynamic background power or leakage if they are defined, which is the case if they are not -1
     if (this->quantum != -1)
@@ -161,6 +172,8 @@ void vp::power::power_source::check()
     bool leakage_power_is_on = this->is_on && this->is_leakage_power_started;
     bool dynamic_power_is_on = this->is_on && this->is_dynamic_power_on && this->is_dynamic_power_started;
 
+    this->quantum_is_on = this->is_on && this->is_dynamic_power_on && this->quantum != -1;
+
     if (this->dynamic_power_is_on_sync != dynamic_power_is_on)
     {
         if (this->background_power)
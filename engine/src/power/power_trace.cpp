@@ -55,6 +55,10 @@ int vp::power::power_trace::init(component *top, std::string name, vp::power::po
 
     this->trace_event = this->top->event_new((void *)this, vp::power::power_trace::trace_handler);
 
+    this->pending_energy = 0;
+    this->has_pending_energy = false;
+    this->pending_energy_event = this->top->event_new((void *)this, vp::power::power_trace::pending_energy_handler);
+
     return 0;
 }
 
@@ -71,6 +75,16 @@ void vp::power::power_trace::trace_handler(void *__this, vp::clock_event *event)
 
 
 
+void vp::power::power_trace::pending_energy_handler(void *__this, vp::clock_event *event)
+{
+    // This handler is executed in the cycle where quanta of energy were accounted, to
+    // report their sum at once
+    vp::power::power_trace *_this = (vp::power::power_trace *)__this;
+    _this->flush_pending_energy();
+}
+
+
+
 void vp::power::power_trace::report_start()
 {
     this->account_dynamic_power();
@@ -83,9 +83,17 @@ void Gv_proxy::send_reply(std::string msg)
 }
 
 
+// The payload of the given size must be written right after this header, for example
+// when it is streamed in several parts
+void Gv_proxy::send_payload_header(FILE *reply_file, std::string req, uint64_t size)
+{
+    fprintf(reply_file, "req=%s;payload=%ld\n", req.c_str(), size);
+}
+
+
 bool Gv_proxy::send_payload(FILE *reply_file, std::string req, uint8_t *payload, int size)
 {
-    fprintf(reply_file, "req=%s;payload=%d\n", req.c_str(), size);
+    this->send_payload_header(reply_file, req, size);
     int write_size = fwrite(payload, 1, size, reply_file);
     fflush(reply_file);
     return write_size != size;
@@ -203,6 +211,37 @@ void Gv_proxy::proxy_loop(int socket_fd, int reply_fd)
                     fflush(reply_sock);
                     lock.unlock();
                 }
+                else if (words[0] == "checkpoint")
+                {
+                    if (words.size() != 3 || (words[1] != "save" && words[1] != "restore"))
+                    {
+                        fprintf(stderr, "This command requires 2 arguments: checkpoint [save|restore] path");
+                    }
+                    else
+                    {
+                        std::string msg = "ok";
+                        try
+                        {
+                            if (words[1] == "save")
+                            {
+                                this->top->checkpoint_save(words[2]);
+                            }
+                            else
+                            {
+                                this->top->checkpoint_restore(words[2]);
+                            }
+                        }
+                        catch (std::exception &e)
+                        {
+                            msg = std::string("error: ") + e.what();
+                        }
+
+                        std::unique_lock<std::mutex> lock(this->mutex);
+                        fprintf(reply_sock, "req=%s;msg=%s\n", req.c_str(), msg.c_str());
+                        fflush(reply_sock);
+                        lock.unlock();
+                    }
+                }
                 else if (words[0] == "trace")
                 {
                     if (words.size() != 3)
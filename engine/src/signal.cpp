@@ -21,6 +21,7 @@
 
 #include <vp/vp.hpp>
 #include <vp/signal.hpp>
+#include <vp/checkpoint.hpp>
 
 vp::signal::signal(block *parent, int64_t reset)
 {
@@ -35,3 +36,8 @@ void vp::signal::reset(bool active)
         this->value = this->reset_value;
     }
 }
+
+void vp::signal::checkpoint(vp::checkpoint *cp)
+{
+    cp->value(this->value);
+}
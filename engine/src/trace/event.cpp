@@ -22,8 +22,10 @@
 #include "vp/vp.hpp"
 #include "vp/trace/event_dumper.hpp"
 #include <string.h>
+#include <atomic>
 
-static int vcd_id = 0;
+// Shared by all the simulator instances of the process, which can create events concurrently
+static std::atomic<int> vcd_id(0);
 
 
 
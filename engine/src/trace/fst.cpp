@@ -32,6 +32,29 @@ vp::Fst_file::Fst_file(vp::Event_dumper *dumper, string path)
     dumper->comp->get_engine()->fatal("Error while opening FST file (path: %s)\n", path.c_str());
   }
   fstWriterSetTimescale(this->writer, -12);
+
+  // Value changes are compressed by a separate thread, so that the dumper thread
+  // can continue unpacking events while the previous section is compressed.
+  // Packing a section takes several times longer than producing it, so the
+  // signals of each section are also shared between several threads.
+  js::config *config = dumper->comp->get_js_config();
+  fstWriterSetParallelMode(this->writer, config->get_child_bool("**/events/fst_parallel"));
+  int pack_threads = config->get_child_int("**/events/fst_threads");
+  fstWriterSetPackThreads(this->writer, pack_threads > 1 ? pack_threads : 1);
+
+  std::string pack = config->get_child_str("**/events/fst_pack");
+  if (pack == "lz4")
+  {
+    fstWriterSetPackType(this->writer, FST_WR_PT_LZ4);
+  }
+  else if (pack == "fastlz")
+  {
+    fstWriterSetPackType(this->writer, FST_WR_PT_FASTLZ);
+  }
+  else if (pack != "" && pack != "zlib")
+  {
+    dumper->comp->get_engine()->fatal("Invalid FST pack type (pack: %s)\n", pack.c_str());
+  }
 }
 
 
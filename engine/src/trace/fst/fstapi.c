@@ -776,6 +776,7 @@ pthread_mutex_t mutex;
 pthread_t thread;
 pthread_attr_t thread_attr;
 struct fstWriterContext *xc_parent;
+unsigned int pack_threads;
 #endif
 
 size_t fst_orig_break_size;
@@ -1229,6 +1230,317 @@ if(xc)
  * only to be called directly by fst code...otherwise must
  * be synced up with time changes
  */
+/*
+ * Builds the value change chain of a handle backwards at the end of scratchpad,
+ * which must be vchg_siz bytes long, and compresses it. Returns the data to
+ * emit for the handle, with its length in *len and the varint preceding it in
+ * *hdr (the uncompressed length, or 0 when the data is not compressed). Only
+ * the curval checkpoint of the handle is modified, so that different handles
+ * can be packed concurrently.
+ */
+static unsigned char *fstWriterPackChain(struct fstWriterContext *xc, uint32_t *vm4ip, unsigned char *scratchpad,
+        unsigned char **packmem, unsigned int *packmemlen, unsigned int *len, unsigned int *hdr, off_t *unc_memreq)
+{
+unsigned char *vchg_mem = xc->vchg_mem;
+unsigned char *scratchpnt;
+uint32_t offs = vm4ip[2];
+uint32_t next_offs;
+unsigned int wrlen;
+
+scratchpnt = scratchpad + xc->vchg_siz;         /* build this buffer backwards */
+if(vm4ip[1] <= 1)
+        {
+        if(vm4ip[1] == 1)
+                {
+                wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
+#ifndef FST_REMOVE_DUPLICATE_VC
+                xc->curval_mem[vm4ip[0]] = vchg_mem[offs + 4 + wrlen]; /* checkpoint variable */
+#endif
+                while(offs)
+                        {
+                        unsigned char val;
+                        uint32_t time_delta, rcv;
+                        next_offs = fstGetUint32(vchg_mem + offs);
+                        offs += 4;
+
+                        time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
+                        val = vchg_mem[offs+wrlen];
+                        offs = next_offs;
+
+                        switch(val)
+                                {
+                                case '0':
+                                case '1':               rcv = ((val&1)<<1) | (time_delta<<2);
+                                                        break; /* pack more delta bits in for 0/1 vchs */
+
+                                case 'x': case 'X':     rcv = FST_RCV_X | (time_delta<<4); break;
+                                case 'z': case 'Z':     rcv = FST_RCV_Z | (time_delta<<4); break;
+                                case 'h': case 'H':     rcv = FST_RCV_H | (time_delta<<4); break;
+                                case 'u': case 'U':     rcv = FST_RCV_U | (time_delta<<4); break;
+                                case 'w': case 'W':     rcv = FST_RCV_W | (time_delta<<4); break;
+                                case 'l': case 'L':     rcv = FST_RCV_L | (time_delta<<4); break;
+                                default:                rcv = FST_RCV_D | (time_delta<<4); break;
+                                }
+
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, rcv);
+                        }
+                }
+                else
+                {
+                /* variable length */
+                /* fstGetUint32 (next_offs) + fstGetVarint32 (time_delta) + fstGetVarint32 (len) + payload */
+                unsigned char *pnt;
+                uint32_t record_len;
+                uint32_t time_delta;
+
+                while(offs)
+                        {
+                        next_offs = fstGetUint32(vchg_mem + offs);
+                        offs += 4;
+                        pnt = vchg_mem + offs;
+                        offs = next_offs;
+                        time_delta = fstGetVarint32(pnt, (int *)&wrlen);
+                        pnt += wrlen;
+                        record_len = fstGetVarint32(pnt, (int *)&wrlen);
+                        pnt += wrlen;
+
+                        scratchpnt -= record_len;
+                        memcpy(scratchpnt, pnt, record_len);
+
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, record_len);
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1)); /* reserve | 1 case for future expansion */
+                        }
+                }
+        }
+        else
+        {
+        wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
+#ifndef FST_REMOVE_DUPLICATE_VC
+        memcpy(xc->curval_mem + vm4ip[0], vchg_mem + offs + 4 + wrlen, vm4ip[1]); /* checkpoint variable */
+#endif
+        while(offs)
+                {
+                unsigned int idx;
+                char is_binary = 1;
+                unsigned char *pnt;
+                uint32_t time_delta;
+
+                next_offs = fstGetUint32(vchg_mem + offs);
+                offs += 4;
+
+                time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
+
+                pnt = vchg_mem+offs+wrlen;
+                offs = next_offs;
+
+                for(idx=0;idx<vm4ip[1];idx++)
+                        {
+                        if((pnt[idx] == '0') || (pnt[idx] == '1'))
+                                {
+                                continue;
+                                }
+                                else
+                                {
+                                is_binary = 0;
+                                break;
+                                }
+                        }
+
+                if(is_binary)
+                        {
+                        unsigned char acc = 0;
+                        /* new algorithm */
+                        idx = ((vm4ip[1]+7) & ~7);
+                        switch(vm4ip[1] & 7)
+                                {
+                                case 0: do {    acc  = (pnt[idx+7-8] & 1) << 0; /* fallthrough */
+                                case 7:         acc |= (pnt[idx+6-8] & 1) << 1; /* fallthrough */
+                                case 6:         acc |= (pnt[idx+5-8] & 1) << 2; /* fallthrough */
+                                case 5:         acc |= (pnt[idx+4-8] & 1) << 3; /* fallthrough */
+                                case 4:         acc |= (pnt[idx+3-8] & 1) << 4; /* fallthrough */
+                                case 3:         acc |= (pnt[idx+2-8] & 1) << 5; /* fallthrough */
+                                case 2:         acc |= (pnt[idx+1-8] & 1) << 6; /* fallthrough */
+                                case 1:         acc |= (pnt[idx+0-8] & 1) << 7;
+                                                *(--scratchpnt) = acc;
+                                                idx -= 8;
+                                        } while(idx);
+                                }
+
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1));
+                        }
+                        else
+                        {
+                        scratchpnt -= vm4ip[1];
+                        memcpy(scratchpnt, pnt, vm4ip[1]);
+
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1) | 1);
+                        }
+                }
+        }
+
+wrlen = scratchpad + xc->vchg_siz - scratchpnt;
+*unc_memreq += wrlen;
+if(wrlen > 32)
+        {
+        unsigned long destlen = wrlen;
+        unsigned char *dmem;
+
+        if(!xc->fastpack)
+                {
+                if(wrlen <= *packmemlen)
+                        {
+                        dmem = *packmem;
+                        }
+                        else
+                        {
+                        free(*packmem);
+                        dmem = *packmem = (unsigned char *)malloc(compressBound(*packmemlen = wrlen));
+                        }
+
+                if(compress2(dmem, &destlen, scratchpnt, wrlen, 4) == Z_OK)
+                        {
+                        *len = destlen;
+                        *hdr = wrlen;
+                        return(dmem);
+                        }
+                }
+                else
+                {
+                unsigned int rc;
+
+                /* this is extremely conservative: fastlz needs +5% for worst case, lz4 needs siz+(siz/255)+16 */
+                if(((wrlen * 2) + 2) <= *packmemlen)
+                        {
+                        dmem = *packmem;
+                        }
+                        else
+                        {
+                        free(*packmem);
+                        dmem = *packmem = (unsigned char *)malloc(*packmemlen = (wrlen * 2) + 2);
+                        }
+
+                rc = (xc->fourpack) ? LZ4_compress((char *)scratchpnt, (char *)dmem, wrlen) : fastlz_compress(scratchpnt, wrlen, dmem);
+                if(rc < destlen)
+                        {
+                        *len = rc;
+                        *hdr = wrlen;
+                        return(dmem);
+                        }
+                }
+        }
+
+*len = wrlen;
+*hdr = 0;
+return(scratchpnt);
+}
+
+
+#ifdef FST_WRITER_PARALLEL
+struct fstWriterPackResult
+{
+unsigned char *mem;
+unsigned int len;
+unsigned int hdr;
+};
+
+struct fstWriterPackShard
+{
+struct fstWriterContext *xc;
+struct fstWriterPackResult *results;
+fstHandle *next_handle;
+off_t unc_memreq;
+pthread_t thread;
+};
+
+#define FST_WRITER_PACK_BLOCK   (64)
+
+/*
+ * Shard worker, packing blocks of handles until all of them are taken. The
+ * results are copied, since scratchpad and packmem are reused for the next
+ * handle.
+ */
+static void *fstWriterPackShardRoutine(void *ctx)
+{
+struct fstWriterPackShard *shard = (struct fstWriterPackShard *)ctx;
+struct fstWriterContext *xc = shard->xc;
+unsigned char *scratchpad = (unsigned char *)malloc(xc->vchg_siz);
+unsigned int packmemlen = 1024;
+unsigned char *packmem = (unsigned char *)malloc(packmemlen);
+
+for(;;)
+        {
+        fstHandle first = __atomic_fetch_add(shard->next_handle, FST_WRITER_PACK_BLOCK, __ATOMIC_RELAXED);
+        fstHandle last = first + FST_WRITER_PACK_BLOCK;
+        fstHandle i;
+
+        if(first >= xc->maxhandle) break;
+        if(last > xc->maxhandle) last = xc->maxhandle;
+
+        for(i=first;i<last;i++)
+                {
+                uint32_t *vm4ip = &(xc->valpos_mem[4*i]);
+
+                if(vm4ip[2])
+                        {
+                        struct fstWriterPackResult *result = &shard->results[i];
+                        unsigned char *mem = fstWriterPackChain(xc, vm4ip, scratchpad, &packmem, &packmemlen,
+                                &result->len, &result->hdr, &shard->unc_memreq);
+
+                        result->mem = (unsigned char *)malloc(result->len ? result->len : 1);
+                        memcpy(result->mem, mem, result->len);
+                        }
+                }
+        }
+
+free(packmem);
+free(scratchpad);
+
+return(NULL);
+}
+
+
+/*
+ * Packs the value changes of all the handles with pack_threads threads,
+ * the calling one included. Returns the results indexed by handle.
+ */
+static struct fstWriterPackResult *fstWriterPackShards(struct fstWriterContext *xc, off_t *unc_memreq)
+{
+unsigned int nb_shards = xc->pack_threads;
+struct fstWriterPackShard *shards = (struct fstWriterPackShard *)calloc(nb_shards, sizeof(struct fstWriterPackShard));
+struct fstWriterPackResult *results = (struct fstWriterPackResult *)calloc(xc->maxhandle ? xc->maxhandle : 1, sizeof(struct fstWriterPackResult));
+fstHandle next_handle = 0;
+unsigned int i;
+
+for(i=0;i<nb_shards;i++)
+        {
+        shards[i].xc = xc;
+        shards[i].results = results;
+        shards[i].next_handle = &next_handle;
+
+        /* a shard which can't get a thread is done by the calling one */
+        if(i && pthread_create(&shards[i].thread, NULL, fstWriterPackShardRoutine, &shards[i]))
+                {
+                nb_shards = i;
+                break;
+                }
+        }
+
+fstWriterPackShardRoutine(&shards[0]);
+*unc_memreq += shards[0].unc_memreq;
+
+for(i=1;i<nb_shards;i++)
+        {
+        pthread_join(shards[i].thread, NULL);
+        *unc_memreq += shards[i].unc_memreq;
+        }
+
+free(shards);
+
+return(results);
+}
+#endif
+
+
 #ifdef FST_WRITER_PARALLEL
 static void fstWriterFlushContextPrivate2(void *ctx)
 #else
@@ -1239,13 +1551,11 @@ static void fstWriterFlushContextPrivate(void *ctx)
 int cnt = 0;
 #endif
 unsigned int i;
-unsigned char *vchg_mem;
 FILE *f;
 off_t fpos, indxpos, endpos;
 uint32_t prevpos;
 int zerocnt;
 unsigned char *scratchpad;
-unsigned char *scratchpnt;
 unsigned char *tmem;
 off_t tlen;
 off_t unc_memreq = 0; /* for reader */
@@ -1258,6 +1568,9 @@ struct fstWriterContext *xc2 = xc->xc_parent;
 #else
 struct fstWriterContext *xc2 = xc;
 #endif
+#ifdef FST_WRITER_PARALLEL
+struct fstWriterPackResult *results = NULL;
+#endif
 
 #ifndef FST_DYNAMIC_ALIAS_DISABLE
 Pvoid_t PJHSArray = (Pvoid_t) NULL;
@@ -1277,297 +1590,73 @@ xc->already_in_flush = 1; /* should really do this with a semaphore */
 xc->section_header_only = 0;
 scratchpad = (unsigned char *)malloc(xc->vchg_siz);
 
-vchg_mem = xc->vchg_mem;
-
 f = xc->handle;
 fstWriterVarint(f, xc->maxhandle);      /* emit current number of handles */
 fputc(xc->fourpack ? '4' : (xc->fastpack ? 'F' : 'Z'), f);
 fpos = 1;
 
-packmemlen = 1024;                      /* maintain a running "longest" allocation to */
-packmem = (unsigned char *)malloc(packmemlen);           /* prevent continual malloc...free every loop iter */
+#ifdef FST_WRITER_PARALLEL
+if(xc->pack_threads > 1)
+        {
+        packmem = NULL;
+        results = fstWriterPackShards(xc, &unc_memreq);
+        }
+        else
+#endif
+        {
+        packmemlen = 1024;                      /* maintain a running "longest" allocation to */
+        packmem = (unsigned char *)malloc(packmemlen);           /* prevent continual malloc...free every loop iter */
+        }
 
+/* chains are emitted in handle order whatever the way they are packed, so that aliases are the same */
 for(i=0;i<xc->maxhandle;i++)
         {
         vm4ip = &(xc->valpos_mem[4*i]);
 
         if(vm4ip[2])
                 {
-                uint32_t offs = vm4ip[2];
-                uint32_t next_offs;
-                unsigned int wrlen;
+                unsigned char *dmem;
+                unsigned int destlen, wrlen;
 
-                vm4ip[2] = fpos;
-
-                scratchpnt = scratchpad + xc->vchg_siz;         /* build this buffer backwards */
-                if(vm4ip[1] <= 1)
+#ifdef FST_WRITER_PARALLEL
+                if(results)
                         {
-                        if(vm4ip[1] == 1)
-                                {
-                                wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
-#ifndef FST_REMOVE_DUPLICATE_VC
-                                xc->curval_mem[vm4ip[0]] = vchg_mem[offs + 4 + wrlen]; /* checkpoint variable */
-#endif
-                                while(offs)
-                                        {
-                                        unsigned char val;
-                                        uint32_t time_delta, rcv;
-                                        next_offs = fstGetUint32(vchg_mem + offs);
-                                        offs += 4;
-
-                                        time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
-                                        val = vchg_mem[offs+wrlen];
-                                        offs = next_offs;
-
-                                        switch(val)
-                                                {
-                                                case '0':
-                                                case '1':               rcv = ((val&1)<<1) | (time_delta<<2);
-                                                                        break; /* pack more delta bits in for 0/1 vchs */
-
-                                                case 'x': case 'X':     rcv = FST_RCV_X | (time_delta<<4); break;
-                                                case 'z': case 'Z':     rcv = FST_RCV_Z | (time_delta<<4); break;
-                                                case 'h': case 'H':     rcv = FST_RCV_H | (time_delta<<4); break;
-                                                case 'u': case 'U':     rcv = FST_RCV_U | (time_delta<<4); break;
-                                                case 'w': case 'W':     rcv = FST_RCV_W | (time_delta<<4); break;
-                                                case 'l': case 'L':     rcv = FST_RCV_L | (time_delta<<4); break;
-                                                default:                rcv = FST_RCV_D | (time_delta<<4); break;
-                                                }
-
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, rcv);
-                                        }
-                                }
-                                else
-                                {
-                                /* variable length */
-                                /* fstGetUint32 (next_offs) + fstGetVarint32 (time_delta) + fstGetVarint32 (len) + payload */
-                                unsigned char *pnt;
-                                uint32_t record_len;
-                                uint32_t time_delta;
-
-                                while(offs)
-                                        {
-                                        next_offs = fstGetUint32(vchg_mem + offs);
-                                        offs += 4;
-                                        pnt = vchg_mem + offs;
-                                        offs = next_offs;
-                                        time_delta = fstGetVarint32(pnt, (int *)&wrlen);
-                                        pnt += wrlen;
-                                        record_len = fstGetVarint32(pnt, (int *)&wrlen);
-                                        pnt += wrlen;
-
-                                        scratchpnt -= record_len;
-                                        memcpy(scratchpnt, pnt, record_len);
-
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, record_len);
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1)); /* reserve | 1 case for future expansion */
-                                        }
-                                }
+                        dmem = results[i].mem;
+                        destlen = results[i].len;
+                        wrlen = results[i].hdr;
                         }
                         else
-                        {
-                        wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
-#ifndef FST_REMOVE_DUPLICATE_VC
-                        memcpy(xc->curval_mem + vm4ip[0], vchg_mem + offs + 4 + wrlen, vm4ip[1]); /* checkpoint variable */
 #endif
-                        while(offs)
-                                {
-                                unsigned int idx;
-                                char is_binary = 1;
-                                unsigned char *pnt;
-                                uint32_t time_delta;
-
-                                next_offs = fstGetUint32(vchg_mem + offs);
-                                offs += 4;
-
-                                time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
-
-                                pnt = vchg_mem+offs+wrlen;
-                                offs = next_offs;
-
-                                for(idx=0;idx<vm4ip[1];idx++)
-                                        {
-                                        if((pnt[idx] == '0') || (pnt[idx] == '1'))
-                                                {
-                                                continue;
-                                                }
-                                                else
-                                                {
-                                                is_binary = 0;
-                                                break;
-                                                }
-                                        }
-
-                                if(is_binary)
-                                        {
-                                        unsigned char acc = 0;
-                                        /* new algorithm */
-                                        idx = ((vm4ip[1]+7) & ~7);
-                                        switch(vm4ip[1] & 7)
-                                                {
-                                                case 0: do {    acc  = (pnt[idx+7-8] & 1) << 0; /* fallthrough */
-                                                case 7:         acc |= (pnt[idx+6-8] & 1) << 1; /* fallthrough */
-                                                case 6:         acc |= (pnt[idx+5-8] & 1) << 2; /* fallthrough */
-                                                case 5:         acc |= (pnt[idx+4-8] & 1) << 3; /* fallthrough */
-                                                case 4:         acc |= (pnt[idx+3-8] & 1) << 4; /* fallthrough */
-                                                case 3:         acc |= (pnt[idx+2-8] & 1) << 5; /* fallthrough */
-                                                case 2:         acc |= (pnt[idx+1-8] & 1) << 6; /* fallthrough */
-                                                case 1:         acc |= (pnt[idx+0-8] & 1) << 7;
-                                                                *(--scratchpnt) = acc;
-                                                                idx -= 8;
-                                                        } while(idx);
-                                                }
-
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1));
-                                        }
-                                        else
-                                        {
-                                        scratchpnt -= vm4ip[1];
-                                        memcpy(scratchpnt, pnt, vm4ip[1]);
-
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1) | 1);
-                                        }
-                                }
-                        }
-
-                wrlen = scratchpad + xc->vchg_siz - scratchpnt;
-                unc_memreq += wrlen;
-                if(wrlen > 32)
                         {
-                        unsigned long destlen = wrlen;
-                        unsigned char *dmem;
-                        unsigned int rc;
-
-                        if(!xc->fastpack)
-                                {
-                                if(wrlen <= packmemlen)
-                                        {
-                                        dmem = packmem;
-                                        }
-                                        else
-                                        {
-                                        free(packmem);
-                                        dmem = packmem = (unsigned char *)malloc(compressBound(packmemlen = wrlen));
-                                        }
+                        dmem = fstWriterPackChain(xc, vm4ip, scratchpad, &packmem, &packmemlen, &destlen, &wrlen, &unc_memreq);
+                        }
 
-                                rc = compress2(dmem, &destlen, scratchpnt, wrlen, 4);
-                                if(rc == Z_OK)
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, dmem, destlen, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, wrlen);
-                                                fpos += destlen;
-                                                fstFwrite(dmem, destlen, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                        else
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, scratchpnt, wrlen, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, 0);
-                                                fpos += wrlen;
-                                                fstFwrite(scratchpnt, wrlen, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                }
-                                else
-                                {
-                                /* this is extremely conservative: fastlz needs +5% for worst case, lz4 needs siz+(siz/255)+16 */
-                                if(((wrlen * 2) + 2) <= packmemlen)
-                                        {
-                                        dmem = packmem;
-                                        }
-                                        else
-                                        {
-                                        free(packmem);
-                                        dmem = packmem = (unsigned char *)malloc(packmemlen = (wrlen * 2) + 2);
-                                        }
+                vm4ip[2] = fpos;
 
-                                rc = (xc->fourpack) ? LZ4_compress((char *)scratchpnt, (char *)dmem, wrlen) : fastlz_compress(scratchpnt, wrlen, dmem);
-                                if(rc < destlen)
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, dmem, rc, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, wrlen);
-                                                fpos += rc;
-                                                fstFwrite(dmem, rc, 1, f);
 #ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                        else
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, scratchpnt, wrlen, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, 0);
-                                                fpos += wrlen;
-                                                fstFwrite(scratchpnt, wrlen, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                }
+                PPvoid_t pv = JudyHSIns(&PJHSArray, dmem, destlen, NULL);
+                if(*pv)
+                        {
+                        uint32_t pvi = (intptr_t)(*pv);
+                        vm4ip[2] = -pvi;
                         }
                         else
                         {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                        PPvoid_t pv = JudyHSIns(&PJHSArray, scratchpnt, wrlen, NULL);
-                        if(*pv)
-                                {
-                                uint32_t pvi = (intptr_t)(*pv);
-                                vm4ip[2] = -pvi;
-                                }
-                                else
-                                {
-                                *pv = (void *)(intptr_t)(i+1);
+                        *pv = (void *)(intptr_t)(i+1);
 #endif
-                                fpos += fstWriterVarint(f, 0);
-                                fpos += wrlen;
-                                fstFwrite(scratchpnt, wrlen, 1, f);
+                        fpos += fstWriterVarint(f, wrlen);
+                        fpos += destlen;
+                        fstFwrite(dmem, destlen, 1, f);
 #ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                }
+                        }
 #endif
+
+#ifdef FST_WRITER_PARALLEL
+                if(results)
+                        {
+                        free(results[i].mem);
                         }
+#endif
 
                 /* vm4ip[3] = 0; ...redundant with clearing below */
 #ifdef FST_DEBUG
@@ -1576,6 +1665,10 @@ for(i=0;i<xc->maxhandle;i++)
                 }
         }
 
+#ifdef FST_WRITER_PARALLEL
+free(results);
+#endif
+
 #ifndef FST_DYNAMIC_ALIAS_DISABLE
 JudyHSFreeArray(&PJHSArray, NULL);
 #endif
@@ -2493,6 +2586,21 @@ if(xc)
 }
 
 
+void fstWriterSetPackThreads(void *ctx, unsigned int count)
+{
+#ifdef FST_WRITER_PARALLEL
+struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
+if(xc)
+        {
+        xc->pack_threads = count;
+        }
+#else
+(void)ctx;
+(void)count;
+#endif
+}
+
+
 void fstWriterSetDumpSizeLimit(void *ctx, uint64_t numbytes)
 {
 struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
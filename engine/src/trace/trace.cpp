@@ -174,31 +174,77 @@ void vp::trace::set_event_active(bool active)
     }
 }
 
-char *vp::trace_engine::get_event_buffer(int bytes)
+void vp::trace_engine::push_ready_buffer(char *buffer)
 {
-    if (current_buffer == NULL || bytes > TRACE_EVENT_BUFFER_SIZE - current_buffer_size)
+    if (buffer == this->drop_buffer)
+    {
+        // The events of this buffer were written while no buffer was free, just
+        // throw them away.
+        this->nb_dropped_buffers++;
+        return;
+    }
+
+    // The ring is as big as the maximum number of buffers so this can not fail
+    ready_event_buffers.push(buffer);
+
+    // Only wake-up the dumper thread if it is sleeping, so that we usually don't
+    // need to take the lock
+    if (this->dumper_waiting.load())
     {
         pthread_mutex_lock(&mutex);
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&mutex);
+    }
+}
+
+char *vp::trace_engine::pop_free_buffer()
+{
+    char *buffer = event_buffers.pop();
+    if (buffer)
+    {
+        return buffer;
+    }
 
+    // The dumper thread is late, apply the backpressure policy
+    if (this->buffer_policy == vp::TRACE_BUFFER_POLICY_GROW && this->nb_buffers < TRACE_EVENT_MAX_BUFFER)
+    {
+        this->nb_buffers++;
+        return new char[TRACE_EVENT_BUFFER_SIZE];
+    }
+    else if (this->buffer_policy == vp::TRACE_BUFFER_POLICY_DROP)
+    {
+        return this->drop_buffer;
+    }
+
+    this->nb_producer_stalls++;
+
+    pthread_mutex_lock(&mutex);
+    this->producer_waiting.store(true);
+    while ((buffer = event_buffers.pop()) == NULL)
+    {
+        pthread_cond_wait(&cond, &mutex);
+    }
+    this->producer_waiting.store(false);
+    pthread_mutex_unlock(&mutex);
+
+    return buffer;
+}
+
+char *vp::trace_engine::get_event_buffer(int bytes)
+{
+    if (current_buffer == NULL || bytes > TRACE_EVENT_BUFFER_SIZE - current_buffer_size)
+    {
         if (current_buffer && bytes > TRACE_EVENT_BUFFER_SIZE - current_buffer_size)
         {
             if ((unsigned int)(TRACE_EVENT_BUFFER_SIZE - current_buffer_size) > sizeof(vp::trace *))
                 *(vp::trace **)(current_buffer + current_buffer_size) = NULL;
 
-            ready_event_buffers.push_back(current_buffer);
+            this->push_ready_buffer(current_buffer);
             current_buffer = NULL;
-
-            pthread_cond_broadcast(&cond);
         }
 
-        while (event_buffers.size() == 0)
-        {
-            pthread_cond_wait(&cond, &mutex);
-        }
-        current_buffer = event_buffers[0];
-        event_buffers.erase(event_buffers.begin());
+        current_buffer = this->pop_free_buffer();
         current_buffer_size = 0;
-        pthread_mutex_unlock(&mutex);
     }
 
     char *result = current_buffer + current_buffer_size;
@@ -213,10 +259,17 @@ void vp::trace_engine::stop()
     this->check_pending_events(-1);
     this->flush();
     pthread_mutex_lock(&mutex);
-    this->end = 1;
+    this->end.store(1);
     pthread_cond_broadcast(&cond);
     pthread_mutex_unlock(&mutex);
     this->thread->join();
+
+    if (this->nb_producer_stalls || this->nb_dropped_buffers)
+    {
+        fprintf(stderr, "Event dumper was late (stalls: %ld, dropped buffers: %ld)\n",
+            this->nb_producer_stalls, this->nb_dropped_buffers);
+    }
+
     fflush(NULL);
 }
 
@@ -228,16 +281,12 @@ void vp::trace_engine::flush()
 
     if (current_buffer_size)
     {
-        pthread_mutex_lock(&mutex);
-
         if (current_buffer)
         {
             *(vp::trace **)(current_buffer + current_buffer_size) = NULL;
-            ready_event_buffers.push_back(current_buffer);
+            this->push_ready_buffer(current_buffer);
             current_buffer = NULL;
         }
-        pthread_cond_broadcast(&cond);
-        pthread_mutex_unlock(&mutex);
     }
 }
 
@@ -465,27 +514,27 @@ void vp::trace_engine::vcd_routine()
     {
         char *event_buffer, *event_buffer_start;
 
-        pthread_mutex_lock(&this->mutex);
-
-        // Wait for a buffer of event of the end of simulation
-        while (this->ready_event_buffers.size() == 0 && !end)
-        {
-            pthread_cond_wait(&this->cond, &this->mutex);
-        }
-
-        // In case of the end of simulation, just leave
-        if (this->ready_event_buffers.size() == 0 && end)
+        // Pop the first buffer, or wait for a buffer of event of the end of simulation
+        event_buffer = this->ready_event_buffers.pop();
+        if (event_buffer == NULL)
         {
+            pthread_mutex_lock(&this->mutex);
+            this->dumper_waiting.store(true);
+            while ((event_buffer = this->ready_event_buffers.pop()) == NULL && !end.load())
+            {
+                pthread_cond_wait(&this->cond, &this->mutex);
+            }
+            this->dumper_waiting.store(false);
             pthread_mutex_unlock(&this->mutex);
-            break;
+
+            // In case of the end of simulation, just leave
+            if (event_buffer == NULL)
+            {
+                break;
+            }
         }
 
-        // Pop the first buffer
-        event_buffer = ready_event_buffers[0];
         event_buffer_start = event_buffer;
-        ready_event_buffers.erase(ready_event_buffers.begin());
-
-        pthread_mutex_unlock(&this->mutex);
 
         // And go through the events to unpack them
         while (event_buffer - event_buffer_start < (int)(TRACE_EVENT_BUFFER_SIZE - sizeof(vp::trace *)))
@@ -561,10 +610,13 @@ void vp::trace_engine::vcd_routine()
         }
 
         // Now push back the buffer of events into the list of free buffers
-        pthread_mutex_lock(&this->mutex);
-        event_buffers.push_back(event_buffer_start);
-        pthread_cond_broadcast(&cond);
-        pthread_mutex_unlock(&this->mutex);
+        event_buffers.push(event_buffer_start);
+        if (this->producer_waiting.load())
+        {
+            pthread_mutex_lock(&this->mutex);
+            pthread_cond_broadcast(&cond);
+            pthread_mutex_unlock(&this->mutex);
+        }
     }
 
     this->flush_event_traces(last_timestamp);
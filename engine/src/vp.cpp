@@ -48,6 +48,7 @@
 #include <vp/proxy.hpp>
 #include <vp/queue.hpp>
 #include <vp/signal.hpp>
+#include <vp/checkpoint.hpp>
 
 
 extern "C" long long int dpi_time_ps();
@@ -66,9 +67,6 @@ char vp_error[VP_ERROR_SIZE];
 
 
 
-static Gv_proxy *proxy = NULL;
-
-
 
 
 
@@ -159,6 +157,23 @@ void vp::component::set_gv_conf(struct gv_conf *gv_conf)
 
 
 
+std::string vp::component::get_config_path()
+{
+    if (this->config_path == "" && this->parent != NULL)
+    {
+        this->config_path = this->parent->get_config_path();
+    }
+
+    return this->config_path;
+}
+
+
+void vp::component::set_config_path(std::string path)
+{
+    this->config_path = path;
+}
+
+
 js::config *vp::component::get_vp_config()
 {
     if (this->vp_config == NULL)
@@ -315,6 +330,115 @@ void vp::component::reset_all(bool active, bool from_itf)
 
 }
 
+void vp::component::checkpoint_save(std::string path)
+{
+    vp::checkpoint cp(path, false);
+    this->checkpoint_all(&cp);
+    this->checkpoint_events_all(&cp);
+}
+
+
+void vp::component::checkpoint_restore(std::string path)
+{
+    vp::checkpoint cp(path, true);
+    this->checkpoint_all(&cp);
+    this->checkpoint_events_all(&cp);
+}
+
+
+void vp::component::checkpoint_all(vp::checkpoint *cp)
+{
+    cp->section(this->get_path());
+
+    for (auto reg : this->regs)
+    {
+        reg->checkpoint(cp);
+    }
+
+    this->block::checkpoint_all(cp);
+
+    for (auto &x : this->childs)
+    {
+        x->checkpoint_all(cp);
+    }
+}
+
+
+// Pending clock events are handled once the state of all components has been
+// restored, since clock engines drop all their events when they are restored.
+// All events are registered to the component they were created with, and are
+// identified by their creation order. Each one is saved with its remaining number
+// of cycles and its payload, its arguments being pointers which are not saved.
+void vp::component::checkpoint_events_all(vp::checkpoint *cp)
+{
+    cp->section(this->get_path());
+
+    uint32_t nb_events = 0;
+
+    std::vector<clock_event *> events = this->events;
+    events.insert(events.end(), this->ext_events.begin(), this->ext_events.end());
+
+    if (cp->is_restore())
+    {
+        cp->value(nb_events);
+
+        for (uint32_t i = 0; i < nb_events; i++)
+        {
+            uint32_t index;
+            int64_t cycles;
+            cp->value(index);
+            cp->value(cycles);
+
+            if (index >= events.size() || this->clock == NULL)
+            {
+                throw std::runtime_error("Checkpoint does not match the platform (path: " + this->get_path() + ")");
+            }
+
+            clock_event *event = events[index];
+            cp->data(event->get_payload(), event->get_payload_size());
+            this->event_enqueue(event, cycles);
+        }
+    }
+    else
+    {
+        if (this->clock)
+        {
+            this->clock->sync();
+        }
+
+        for (clock_event *event: events)
+        {
+            if (event->is_enqueued())
+            {
+                nb_events++;
+            }
+        }
+
+        cp->value(nb_events);
+
+        for (uint32_t i = 0; i < events.size(); i++)
+        {
+            clock_event *event = events[i];
+            if (event->is_enqueued())
+            {
+                int64_t cycles = event->get_cycle() - this->clock->get_cycles();
+                if (cycles < 0)
+                {
+                    cycles = 0;
+                }
+                cp->value(i);
+                cp->value(cycles);
+                cp->data(event->get_payload(), event->get_payload_size());
+            }
+        }
+    }
+
+    for (auto &x : this->childs)
+    {
+        x->checkpoint_events_all(cp);
+    }
+}
+
 void vp::component_clock::reset_sync(void *__this, bool active)
 {
     component *_this = (component *)__this;
@@ -336,14 +460,28 @@ void vp::component_clock::pre_build(component *comp)
 }
 
 
+// Defined here as it is used by the clock engines, which are part of this library
+thread_local vp::time_engine *vp::time_engine::current_partition = NULL;
+
+
 int64_t vp::time_engine::get_next_event_time()
 {
-    if (this->first_client)
+    int64_t next = -1;
+
+    if (this->first_client())
     {
-        return this->first_client->next_event_time;
+        next = this->first_client()->next_event_time;
     }
 
-    return this->time;
+    for (time_engine *partition: this->partitions)
+    {
+        if (partition->first_client() && (next == -1 || partition->first_client()->next_event_time < next))
+        {
+            next = partition->first_client()->next_event_time;
+        }
+    }
+
+    return next == -1 ? this->time : next;
 }
 
 
@@ -352,18 +490,7 @@ bool vp::time_engine::dequeue(time_engine_client *client)
     if (!client->is_enqueued)
         return false;
 
-    client->is_enqueued = false;
-
-    time_engine_client *current = this->first_client, *prev = NULL;
-    while (current && current != client)
-    {
-        prev = current;
-        current = current->next;
-    }
-    if (prev)
-        prev->next = client->next;
-    else
-        this->first_client = client->next;
+    this->client_remove(client);
 
     return true;
 }
@@ -392,23 +519,18 @@ bool vp::time_engine::enqueue(time_engine_client *client, int64_t time)
     {
         if (client->next_event_time <= full_time)
             return false;
-        this->dequeue(client);
-    }
 
-    client->is_enqueued = true;
+        // The client is already in the heap, just move it up, the same way
+        // it would be if it was pushed again.
+        client->next_event_time = full_time;
+        client->heap_seq = this->client_seq++;
+        this->client_sift_up(client->heap_index);
 
-    time_engine_client *current = first_client, *prev = NULL;
-    client->next_event_time = full_time;
-    while (current && current->next_event_time < client->next_event_time)
-    {
-        prev = current;
-        current = current->next;
+        return true;
     }
-    if (prev)
-        prev->next = client;
-    else
-        first_client = client;
-    client->next = current;
+
+    client->next_event_time = full_time;
+    this->client_push(client);
 
     return true;
 }
@@ -423,6 +545,18 @@ bool vp::clock_engine::dequeue_from_engine()
     return true;
 }
 
+void vp::clock_engine::check_partition()
+{
+    vp::time_engine *partition = vp::time_engine::current_partition;
+
+    if (partition != NULL && partition != this->engine)
+    {
+        this->get_trace()->fatal("Pushing event to a clock engine of another partition of the parallel mode (clock: %s)\n",
+            this->get_path().c_str());
+    }
+}
+
+
 void vp::clock_engine::reenqueue_to_engine()
 {
     this->engine->enqueue(this, this->next_event_time);
@@ -441,6 +575,16 @@ void vp::clock_engine::apply_frequency(int frequency)
         {
             int64_t cycles = (this->next_event_time - this->get_time()) / period;
             this->next_event_time = cycles * this->period;
+
+            // The engine may be waiting for an event several cycles ahead, move the time
+            // of the current cycle so that the next event falls exactly on its cycle
+            // with the new period.
+            if (this->has_events())
+            {
+                int64_t event_cycles = this->get_next_event()->get_cycle() - this->get_cycles();
+                this->stop_time = this->get_time() + this->next_event_time - event_cycles * this->period;
+            }
+
             this->reenqueue_to_engine();
         }
         else if (period == 0)
@@ -451,6 +595,7 @@ void vp::clock_engine::apply_frequency(int frequency)
             {
                 // Compute the time of the next event based on the new frequency
                 this->next_event_time = (this->get_next_event()->get_cycle() - this->get_cycles()) * this->period;
+                this->stop_time = this->get_time();
 
                 this->reenqueue_to_engine();
             }
@@ -481,7 +626,7 @@ void vp::clock_engine::update()
     {
         int64_t cycles = (diff + this->period - 1) / this->period;
         this->stop_time += cycles * this->period;
-        this->cycles += cycles;
+        this->advance_cycles(cycles);
     }
 }
 
@@ -537,22 +682,15 @@ vp::clock_event *vp::clock_engine::enqueue_other(vp::clock_event *event, int64_t
 
 vp::clock_event *vp::clock_engine::get_next_event()
 {
-    // There is no quick way of getting the next event.
-    // We have to first check if there is an event in the circular buffer
-    // and if not in the delayed queue
+    // The next event is in the first non-empty slot of the circular buffer,
+    // which is given by the slot bitmap, or if it is empty, in the delayed queue.
 
     if (this->nb_enqueued_to_cycle)
     {
-        for (int i = 0; i < CLOCK_EVENT_QUEUE_SIZE; i++)
-        {
-            int cycle = (current_cycle + i) & CLOCK_EVENT_QUEUE_MASK;
-            vp::clock_event *event = event_queue[cycle];
-            if (event)
-            {
-                return event;
-            }
-        }
-        vp_assert(false, 0, "Didn't find any event in circular buffer while it is not empty\n");
+        vp_assert(this->event_queue_mask, 0, "Didn't find any event in circular buffer while it is not empty\n");
+
+        int cycle = (current_cycle + this->get_next_cycle_distance()) & CLOCK_EVENT_QUEUE_MASK;
+        return event_queue[cycle];
     }
 
     return this->delayed_queue;
@@ -563,12 +701,30 @@ void vp::clock_engine::cancel(vp::clock_event *event)
     if (!event->is_enqueued())
         return;
 
-    // There is no way to know if the event is enqueued into the circular buffer
-    // or in the delayed queue so first go through the delayed queue and if it is
-    // not found, look in the circular buffer
-
-    // First the delayed queue
+    // The event cycle tells in which slot of the circular buffer it should be
+    // if it is there, so first look at this slot, then in the events of the end
+    // of the cycle, in the delayed queue and finally in the whole circular buffer
+    // in case the cycle is out of sync.
+    int64_t cycle_diff = event->cycle - this->get_cycles();
     vp::clock_event *current = delayed_queue, *prev = NULL;
+
+    if (cycle_diff >= 0 && cycle_diff < CLOCK_EVENT_QUEUE_SIZE)
+    {
+        if (this->cancel_from_cycle((current_cycle + cycle_diff) & CLOCK_EVENT_QUEUE_MASK, event))
+            goto end;
+    }
+
+    // Then the events of the end of the current cycle
+    for (vp::clock_event **prev_next = &this->cycle_end_events; *prev_next; prev_next = &(*prev_next)->next)
+    {
+        if (*prev_next == event)
+        {
+            *prev_next = event->next;
+            goto end;
+        }
+    }
+
+    // Then the delayed queue
     while (current)
     {
         if (current == event)
@@ -588,24 +744,8 @@ void vp::clock_engine::cancel(vp::clock_event *event)
     // Then in the circular buffer
     for (int i = 0; i < CLOCK_EVENT_QUEUE_SIZE; i++)
     {
-        vp::clock_event *current = event_queue[i], *prev = NULL;
-        while (current)
-        {
-            if (current == event)
-            {
-                if (prev)
-                    prev->next = event->next;
-                else
-                    event_queue[i] = event->next;
-
-                this->nb_enqueued_to_cycle--;
-
-                goto end;
-            }
-
-            prev = current;
-            current = current->next;
-        }
+        if (this->cancel_from_cycle(i, event))
+            goto end;
     }
 
     vp_assert(0, NULL, "Didn't find event in any queue while canceling event\n");
@@ -617,6 +757,33 @@ end:
         this->dequeue_from_engine();
 }
 
+bool vp::clock_engine::cancel_from_cycle(int cycle, vp::clock_event *event)
+{
+    vp::clock_event *current = event_queue[cycle], *prev = NULL;
+    while (current)
+    {
+        if (current == event)
+        {
+            if (prev)
+                prev->next = event->next;
+            else
+                event_queue[cycle] = event->next;
+
+            if (event_queue[cycle] == NULL)
+                event_queue_mask &= ~(1U << cycle);
+
+            this->nb_enqueued_to_cycle--;
+
+            return true;
+        }
+
+        prev = current;
+        current = current->next;
+    }
+
+    return false;
+}
+
 void vp::clock_engine::flush_delayed_queue()
 {
     clock_event *event = delayed_queue;
@@ -639,11 +806,32 @@ void vp::clock_engine::flush_delayed_queue()
     }
 }
 
+void vp::clock_engine::exec_cycle_end_events()
+{
+    while (this->cycle_end_events)
+    {
+        clock_event *event = this->cycle_end_events;
+        this->cycle_end_events = event->next;
+        event->enqueued = false;
+        event->meth(event->_this, event);
+    }
+}
+
 int64_t vp::clock_engine::exec()
 {
     vp_assert(this->has_events(), NULL, "Executing clock engine while it has no event\n");
     vp_assert(this->get_next_event(), NULL, "Executing clock engine while it has no next event\n");
 
+    // We may have been waiting for several cycles if the slots in-between were
+    // empty, first catch up with the current time.
+    int64_t diff = this->get_time() - this->stop_time;
+    if (unlikely(diff > 0))
+    {
+        int64_t cycles = (diff + this->period - 1) / this->period;
+        this->stop_time += cycles * this->period;
+        this->advance_cycles(cycles);
+    }
+
     this->cycles_trace.event_real(this->cycles);
 
     // The clock engine has a circular buffer of events to be executed.
@@ -670,21 +858,45 @@ int64_t vp::clock_engine::exec()
 
         current->meth(current->_this, current);
         current = event_queue[current_cycle];
+
+        // The cycle end events may enqueue events to the current cycle, which
+        // must then be executed before the cycle is over
+        if (unlikely(current == NULL && this->cycle_end_events != NULL))
+        {
+            this->exec_cycle_end_events();
+            current = event_queue[current_cycle];
+        }
     }
 
+    event_queue_mask &= ~(1U << current_cycle);
+
     // Now we need to tell the time engine when is the next event.
     // The most likely is that there is an event in the circular buffer,
-    // in which case we just return the clock period, as we will go through
-    // each element of the circular buffer, even if the next event is further in
-    // the buffer.
+    // in which case we directly return the time to the first non-empty slot,
+    // so that empty cycles are skipped.
     if (likely(nb_enqueued_to_cycle))
     {
-        cycles++;
-        current_cycle = (current_cycle + 1) & CLOCK_EVENT_QUEUE_MASK;
-        if (unlikely(current_cycle == 0))
-            this->must_flush_delayed_queue = true;
+        int64_t next_cycles = this->get_next_cycle_distance();
+
+        // Don't go beyond the first event of the delayed queue, and make sure it
+        // is moved to the circular buffer when we reach it.
+        if (unlikely(delayed_queue != NULL))
+        {
+            int64_t delayed_cycles = delayed_queue->cycle - get_cycles();
+            if (delayed_cycles < next_cycles)
+            {
+                next_cycles = delayed_cycles < 1 ? 1 : delayed_cycles;
+                this->must_flush_delayed_queue = true;
+            }
+        }
 
-        return period;
+        // Only the next cycle is accounted now, the remaining ones are caught up
+        // when we are executed again, or if we get synchronized before, in case
+        // events are enqueued from another engine.
+        this->advance_cycles(1);
+        this->stop_time = this->get_time() + period;
+
+        return next_cycles * period;
     }
     else
     {
@@ -711,17 +923,81 @@ int64_t vp::clock_engine::exec()
     }
 }
 
+void vp::clock_engine::checkpoint(vp::checkpoint *cp)
+{
+    if (!cp->is_restore())
+    {
+        this->sync();
+    }
+
+    cp->value(this->cycles);
+    cp->value(this->period);
+    cp->value(this->freq);
+
+    if (cp->is_restore())
+    {
+        // Drop all pending events, the components owning them will enqueue
+        // them again with their remaining number of cycles.
+        for (int i = 0; i < CLOCK_EVENT_QUEUE_SIZE; i++)
+        {
+            for (clock_event *event = this->event_queue[i]; event; event = event->next)
+            {
+                event->enqueued = false;
+            }
+            this->event_queue[i] = NULL;
+        }
+
+        for (clock_event *event = this->delayed_queue; event; event = event->next)
+        {
+            event->enqueued = false;
+        }
+
+        this->delayed_queue = NULL;
+        this->event_queue_mask = 0;
+        this->nb_enqueued_to_cycle = 0;
+        this->current_cycle = 0;
+        this->must_flush_delayed_queue = true;
+        this->stop_time = this->get_time();
+
+        this->dequeue_from_engine();
+    }
+}
+
 vp::clock_event::clock_event(component_clock *comp, clock_event_meth_t *meth)
     : comp(comp), _this((void *)static_cast<vp::component *>((vp::component_clock *)(comp))), meth(meth), enqueued(false)
 {
     comp->add_clock_event(this);
 }
 
+vp::clock_event::clock_event(component_clock *comp, void *_this, clock_event_meth_t *meth)
+    : comp(comp), _this(_this), meth(meth), enqueued(false)
+{
+    comp->add_ext_clock_event(this);
+}
+
 void vp::component_clock::add_clock_event(clock_event *event)
 {
     this->events.push_back(event);
 }
 
+void vp::component_clock::add_ext_clock_event(clock_event *event)
+{
+    this->ext_events.push_back(event);
+}
+
+void vp::component_clock::remove_clock_event(clock_event *event)
+{
+    for (std::vector<clock_event *> *events: { &this->events, &this->ext_events })
+    {
+        auto it = std::find(events->begin(), events->end(), event);
+        if (it != events->end())
+        {
+            events->erase(it);
+            return;
+        }
+    }
+}
+
 vp::time_engine *vp::component::get_time_engine()
 {
     if (this->time_engine_ptr == NULL)
@@ -732,6 +1008,17 @@ vp::time_engine *vp::component::get_time_engine()
     return this->time_engine_ptr;
 }
 
+vp::time_engine *vp::component::get_partition_engine()
+{
+    vp::clock_engine *clock = dynamic_cast<vp::clock_engine *>(this);
+    if (clock == NULL)
+    {
+        clock = this->get_clock();
+    }
+
+    return clock ? clock->get_engine() : NULL;
+}
+
 
 
 vp::master_port::master_port(vp::component *owner)
@@ -1239,6 +1526,16 @@ void vp::reg::reset(bool active)
     }
 }
 
+void vp::reg::checkpoint(vp::checkpoint *cp)
+{
+    cp->data((void *)this->value_bytes, this->nb_bytes);
+
+    if (cp->is_restore() && this->reg_event.get_event_active())
+    {
+        this->reg_event.event((uint8_t *)this->value_bytes);
+    }
+}
+
 void vp::reg_1::init(vp::component *top, std::string name, uint8_t *reset_val)
 {
     reg::init(top, name, 1, (uint8_t *)&this->value, reset_val);
@@ -1320,6 +1617,28 @@ void vp::slave_port::final_bind()
         this->finalize();
 }
 
+bool vp::port::is_partition_cross()
+{
+    if (this->remote_port == NULL)
+        return false;
+
+    vp::time_engine *engine = this->get_owner()->get_partition_engine();
+    vp::time_engine *remote_engine = this->remote_port->get_owner()->get_partition_engine();
+
+    if (engine == NULL || remote_engine == NULL || engine == remote_engine)
+        return false;
+
+    this->partition_engine = engine;
+    this->remote_partition_id = remote_engine->get_partition_id();
+
+    return true;
+}
+
+void vp::port::partition_defer(std::function<void()> callback)
+{
+    this->partition_engine->defer(this->remote_partition_id, callback);
+}
+
 extern "C" char *vp_get_error()
 {
     return vp_error;
@@ -1610,10 +1929,11 @@ void vp::component::dump_traces_recursive(FILE *file)
 }
 
 
+// Several instances can be created in the same process, all the state of an instance
+// must then be kept in its components and not in global variables, the model libraries
+// being shared by all of them.
 vp::component *vp::__gv_create(std::string config_path, struct gv_conf *gv_conf)
 {
-    setenv("PULP_CONFIG_FILE", config_path.c_str(), 1);
-
     js::config *js_config = js::import_config_from_file(config_path);
     if (js_config == NULL)
     {
@@ -1660,6 +1980,7 @@ vp::component *vp::__gv_create(std::string config_path, struct gv_conf *gv_conf)
 
     instance->set_vp_config(gv_config);
     instance->set_gv_conf(gv_conf);
+    instance->set_config_path(config_path);
 
     return (vp::component *)top;
 }
@@ -1690,7 +2011,8 @@ extern "C" void gv_start(void *arg)
     {
         int in_port = instance->gv_conf.open_proxy ? 0 : instance->get_vp_config()->get_child_int("proxy/port");
         int out_port;
-        proxy = new Gv_proxy(instance, instance->gv_conf.req_pipe, instance->gv_conf.reply_pipe);
+        Gv_proxy *proxy = new Gv_proxy(instance, instance->gv_conf.req_pipe, instance->gv_conf.reply_pipe);
+        top->proxy = proxy;
         if (proxy->open(in_port, &out_port))
         {
             instance->throw_error("Failed to start proxy");
@@ -1974,7 +2296,7 @@ extern "C" int gv_run(void *arg)
     vp::top *top = (vp::top *)arg;
     vp::component *instance = (vp::component *)top->top_instance;
 
-    if (!proxy)
+    if (!top->proxy)
     {
         instance->run();
     }
@@ -2000,9 +2322,9 @@ extern "C" void gv_stop(void *arg, int retval)
     vp::top *top = (vp::top *)arg;
     vp::component *instance = (vp::component *)top->top_instance;
 
-    if (proxy)
+    if (top->proxy)
     {
-        proxy->stop(retval);
+        top->proxy->stop(retval);
     }
 
     instance->stop_all();
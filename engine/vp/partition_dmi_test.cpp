@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Master acting like a core which uses direct memory accesses whenever they
+ * are granted. It checks that they are granted by a memory of its own
+ * partition of the parallel mode, through the "local" port, and refused by a
+ * memory of another partition, through the "remote" port, which must then be
+ * accessed with requests. It is driven by partition_dmi_test.py.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <stdio.h>
+
+class partition_dmi_test : public vp::component
+{
+
+public:
+  partition_dmi_test(js::config *config);
+
+  int build();
+  void reset(bool active);
+
+private:
+  static void handler(void *__this, vp::clock_event *event);
+  static void grant(void *__this, vp::io_req *req);
+  static void response(void *__this, vp::io_req *req);
+
+  void send_req(bool is_write);
+  void finish();
+
+  vp::trace trace;
+  vp::io_master local;
+  vp::io_master remote;
+  vp::clock_event *event;
+
+  vp::io_req req;
+  uint32_t data;
+  int nb_errors;
+  bool stopped;
+};
+
+partition_dmi_test::partition_dmi_test(js::config *config)
+: vp::component(config)
+{
+
+}
+
+void partition_dmi_test::finish()
+{
+  printf("Partition DMI test done, %d errors\n", this->nb_errors);
+
+  // Keep an event pending, otherwise the engine may see that it ran out of
+  // events before handling the stop request, and report a failure. The stop
+  // request is only handled at the end of the quantum, so the event may still
+  // be executed.
+  this->stopped = true;
+  this->event_enqueue(this->event, 1);
+  this->get_clock()->stop_engine(this->nb_errors != 0);
+}
+
+void partition_dmi_test::send_req(bool is_write)
+{
+  this->req.init();
+  this->req.set_addr(0);
+  this->req.set_size(4);
+  this->req.set_is_write(is_write);
+  this->req.set_data((uint8_t *)&this->data);
+
+  // The memory is in another partition, so the request can only be answered
+  // asynchronously, at the end of the quantum
+  vp::io_req_status_e status = this->remote.req(&this->req);
+  if (status != vp::IO_REQ_DENIED)
+  {
+    printf("Request to the remote memory not deferred (status: %d)\n", status);
+    this->nb_errors++;
+    this->finish();
+  }
+}
+
+void partition_dmi_test::grant(void *__this, vp::io_req *req)
+{
+}
+
+void partition_dmi_test::response(void *__this, vp::io_req *req)
+{
+  partition_dmi_test *_this = (partition_dmi_test *)__this;
+
+  if (req->status != vp::IO_REQ_OK)
+  {
+    printf("Request to the remote memory failed (status: %d)\n", req->status);
+    _this->nb_errors++;
+    _this->finish();
+  }
+  else if (req->get_is_write())
+  {
+    _this->data = 0;
+    _this->send_req(false);
+  }
+  else
+  {
+    if (_this->data != 0x12345678)
+    {
+      printf("Remote memory read mismatch (expected: 0x12345678, read: 0x%x)\n", _this->data);
+      _this->nb_errors++;
+    }
+    _this->finish();
+  }
+}
+
+void partition_dmi_test::handler(void *__this, vp::clock_event *event)
+{
+  partition_dmi_test *_this = (partition_dmi_test *)__this;
+  vp::io_dmi dmi;
+
+  if (_this->stopped)
+    return;
+
+  if (_this->local.dmi_req(0, &dmi) != vp::IO_REQ_OK || dmi.data == NULL)
+  {
+    printf("Direct access to the memory of the same partition refused\n");
+    _this->nb_errors++;
+  }
+
+  if (_this->remote.dmi_req(0, &dmi) != vp::IO_REQ_INVALID || dmi.data != NULL)
+  {
+    printf("Direct access to the memory of another partition granted\n");
+    _this->nb_errors++;
+  }
+
+  _this->data = 0x12345678;
+  _this->send_req(true);
+}
+
+int partition_dmi_test::build()
+{
+  traces.new_trace("trace", &trace, vp::DEBUG);
+
+  this->remote.set_grant_meth(&partition_dmi_test::grant);
+  this->remote.set_resp_meth(&partition_dmi_test::response);
+
+  new_master_port("local", &this->local);
+  new_master_port("remote", &this->remote);
+
+  this->event = this->event_new(partition_dmi_test::handler);
+
+  this->nb_errors = 0;
+  this->stopped = false;
+
+  return 0;
+}
+
+void partition_dmi_test::reset(bool active)
+{
+  if (!active)
+  {
+    this->event_enqueue(this->event, 1);
+  }
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+  return new partition_dmi_test(config);
+}
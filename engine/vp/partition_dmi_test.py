@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+#
+# Checks that direct memory accesses are not granted across partitions of the
+# parallel mode. The vp.partition_dmi_test master and a first memory are
+# simulated by the main partition, while a second memory, with its own clock
+# domain, is simulated by another partition.
+#
+# Example:
+#   GVSOC_PATH=<install>/models ./partition_dmi_test.py
+#
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def get_config():
+
+    memory = {
+        'vp_component': 'memory.memory_impl', 'size': 0x10000, 'width_bits': 0,
+        'stim_file': '', 'power_trace': False, 'align': 0, 'check': False, 'latency': 0,
+        'atomics': False
+    }
+
+    return {
+        'gvsoc': {
+            'sa-mode': True,
+            'traces': {'level': 'info', 'include_regex': [], 'format': 'long'},
+            'events': {'include_regex': [], 'include_raw': []},
+            'parallel': {'partitions': ['/remote_clock'], 'quantum': 100000}
+        },
+        'target': {
+            'vp_component': 'utils.composite_impl',
+            'clock': {'vp_component': 'vp.clock_domain_impl', 'frequency': 100000000},
+            'remote_clock': {'vp_component': 'vp.clock_domain_impl', 'frequency': 100000000},
+            'test': {'vp_component': 'vp.partition_dmi_test'},
+            'local_mem': memory,
+            'remote_mem': memory,
+            'components': ['clock', 'remote_clock', 'test', 'local_mem', 'remote_mem'],
+            'bindings': [
+                ['clock->out', 'test->clock'],
+                ['clock->out', 'local_mem->clock'],
+                ['remote_clock->out', 'remote_mem->clock'],
+                ['test->local', 'local_mem->input'],
+                ['test->remote', 'remote_mem->input']
+            ]
+        }
+    }
+
+
+parser = argparse.ArgumentParser(description='Check direct memory accesses across partitions')
+
+parser.add_argument("--launcher", dest="launcher", default="gvsoc_launcher",
+    help="Path to gvsoc_launcher")
+
+args = parser.parse_args()
+
+with tempfile.TemporaryDirectory() as tmpdir:
+    config_path = os.path.join(tmpdir, 'partition_dmi_test.json')
+    with open(config_path, 'w') as file:
+        json.dump(get_config(), file, indent=2)
+
+    if subprocess.run([args.launcher, '--config=' + config_path]).returncode != 0:
+        sys.exit('Partition DMI test failed')
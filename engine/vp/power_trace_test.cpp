@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Component checking the accounting of energy quanta summed per cycle against
+ * the direct accounting. The same quanta are accounted to the "batched" power
+ * trace with account_quantum and to the "baseline" power trace with
+ * inc_dynamic_energy. Several quanta are accounted in the same cycle by its own
+ * events, and others are received on the "input" port from a driver, which is
+ * the same component in driver mode, in another clock domain. The reported
+ * energies must be the same, and power_trace_test.py checks that the
+ * traces dumped to VCD have the same values at the same timestamps. The quanta
+ * from the driver must also not change the timing of the events of the
+ * component.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/wire.hpp>
+#include <stdio.h>
+
+// Number of cycles during which quanta are accounted
+#define NB_CYCLES 200
+
+// Gives access to the accounting methods, which are reserved to the power
+// framework
+class test_power_trace : public vp::power::power_trace
+{
+public:
+  void account(double energy, bool batched)
+  {
+    if (batched)
+      this->account_quantum(energy);
+    else
+      this->inc_dynamic_energy(energy);
+  }
+
+  double get_energy()
+  {
+    double dynamic, leakage;
+    this->get_report_energy(&dynamic, &leakage);
+    return dynamic;
+  }
+};
+
+class power_trace_test : public vp::component
+{
+
+public:
+  power_trace_test(js::config *config);
+
+  int build();
+  void reset(bool active);
+
+private:
+  static void handler(void *__this, vp::clock_event *event);
+  static void second_handler(void *__this, vp::clock_event *event);
+  static void driver_handler(void *__this, vp::clock_event *event);
+  static void sync(void *__this, int value);
+
+  void account(int power);
+  void check();
+
+  vp::trace trace;
+  vp::wire_master<int> output;
+  vp::wire_slave<int> input;
+  test_power_trace batched;
+  test_power_trace baseline;
+  vp::clock_event *event;
+  vp::clock_event *event2;
+
+  bool driver;
+  int cycle;
+  int64_t start_time;
+  int nb_errors;
+};
+
+power_trace_test::power_trace_test(js::config *config)
+: vp::component(config)
+{
+
+}
+
+// Quanta are multiples of the period so that the instant powers are integers,
+// which are summed exactly in any order
+void power_trace_test::account(int power)
+{
+  double energy = (double)power * this->get_period();
+
+  this->batched.account(energy, true);
+  this->baseline.account(energy, false);
+}
+
+void power_trace_test::sync(void *__this, int value)
+{
+  power_trace_test *_this = (power_trace_test *)__this;
+  _this->account(value);
+}
+
+void power_trace_test::check()
+{
+  double batched = this->batched.get_energy();
+  double baseline = this->baseline.get_energy();
+
+  if (batched != baseline)
+  {
+    printf("Energy mismatch (batched: %f, baseline: %f)\n", batched, baseline);
+    this->nb_errors++;
+  }
+
+  printf("Power trace test done, %d errors\n", this->nb_errors);
+
+  // Keep an event pending, otherwise the engine may see that it ran out of
+  // events before handling the stop request, and report a failure
+  this->event_enqueue(this->event, 1);
+  this->get_clock()->stop_engine(this->nb_errors != 0);
+}
+
+void power_trace_test::handler(void *__this, vp::clock_event *event)
+{
+  power_trace_test *_this = (power_trace_test *)__this;
+
+  if (_this->cycle == NB_CYCLES)
+  {
+    _this->cycle++;
+    _this->check();
+    return;
+  }
+
+  if (_this->cycle > NB_CYCLES)
+    return;
+
+  if (_this->start_time == -1)
+  {
+    _this->start_time = _this->get_time();
+  }
+  else if ((_this->get_time() - _this->start_time) % _this->get_period() != 0)
+  {
+    printf("Event executed out of the clock cycles (time: %ld, first event: %ld)\n",
+      _this->get_time(), _this->start_time);
+    _this->nb_errors++;
+  }
+
+  // The other event of the cycle is executed after this one, so the quanta are
+  // accounted from two events. Some cycles are skipped so that the power goes
+  // back to zero in between.
+  int delay = _this->cycle % 5 == 0 ? 3 : 1;
+
+  _this->account(1 + _this->cycle % 3);
+  _this->account(2);
+
+  _this->event_enqueue(_this->event2, 0);
+  _this->event_enqueue(_this->event, delay);
+
+  _this->cycle += delay;
+}
+
+void power_trace_test::second_handler(void *__this, vp::clock_event *event)
+{
+  power_trace_test *_this = (power_trace_test *)__this;
+  _this->account(5);
+}
+
+void power_trace_test::driver_handler(void *__this, vp::clock_event *event)
+{
+  power_trace_test *_this = (power_trace_test *)__this;
+
+  if (_this->cycle < NB_CYCLES / 3)
+  {
+    _this->output.sync(7 + _this->cycle % 2);
+    _this->event_enqueue(_this->event, 1);
+    _this->cycle++;
+  }
+}
+
+int power_trace_test::build()
+{
+  traces.new_trace("trace", &trace, vp::DEBUG);
+
+  this->driver = this->get_js_config()->get_child_bool("driver");
+
+  this->input.set_sync_meth(&power_trace_test::sync);
+
+  new_master_port("output", &this->output);
+  new_slave_port("input", &this->input);
+
+  this->power.new_power_trace("batched", &this->batched);
+  this->power.new_power_trace("baseline", &this->baseline);
+
+  if (this->driver)
+  {
+    this->event = this->event_new(power_trace_test::driver_handler);
+    this->event2 = NULL;
+  }
+  else
+  {
+    this->event = this->event_new(power_trace_test::handler);
+    this->event2 = this->event_new(power_trace_test::second_handler);
+  }
+
+  this->cycle = 0;
+  this->start_time = -1;
+  this->nb_errors = 0;
+
+  return 0;
+}
+
+void power_trace_test::reset(bool active)
+{
+  if (!active)
+  {
+    this->event_enqueue(this->event, 1);
+  }
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+  return new power_trace_test(config);
+}
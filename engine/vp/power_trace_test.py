@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+#
+# Checks that the energy quanta summed per cycle by the vp.power_trace_test
+# component produce the same power traces as when they are accounted directly.
+# The traces are dumped to VCD, and must have the same values at the same
+# timestamps. A driver in another clock domain accounts quanta while the clock
+# engine of the component is not executing its events, which must not change
+# the timing of the component.
+#
+# Example:
+#   GVSOC_PATH=<install>/models ./power_trace_test.py
+#
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def get_config(vcd_path):
+
+    return {
+        'gvsoc': {
+            'sa-mode': True,
+            'debug-mode': True,
+            'traces': {'level': 'info', 'include_regex': [], 'format': 'long'},
+            'events': {
+                'include_regex': ['/test/batched@' + vcd_path, '/test/baseline@' + vcd_path],
+                'include_raw': [], 'format': 'vcd'
+            }
+        },
+        'target': {
+            'vp_component': 'utils.composite_impl',
+            'clock': {'vp_component': 'vp.clock_domain_impl', 'frequency': 100000000},
+            'driver_clock': {'vp_component': 'vp.clock_domain_impl', 'frequency': 30000000},
+            'test': {'vp_component': 'vp.power_trace_test', 'driver': False},
+            'driver': {'vp_component': 'vp.power_trace_test', 'driver': True},
+            'components': ['clock', 'driver_clock', 'test', 'driver'],
+            'bindings': [
+                ['clock->out', 'test->clock'],
+                ['driver_clock->out', 'driver->clock'],
+                ['driver->output', 'test->input']
+            ]
+        }
+    }
+
+
+# Returns the value changes of each real signal, as lists of (timestamp, value)
+# where only the last value of each timestamp is kept
+def parse_vcd(path):
+    names = {}
+    changes = {}
+    timestamp = 0
+
+    with open(path) as file:
+        for line in file:
+            fields = line.split()
+            if len(fields) == 0:
+                continue
+            if fields[0] == '$var' and fields[1] == 'real':
+                names[fields[3]] = fields[4]
+                changes[fields[4]] = []
+            elif fields[0].startswith('#'):
+                timestamp = int(fields[0][1:])
+            elif fields[0].startswith('r') and len(fields) == 2 and fields[1] in names:
+                signal = changes[names[fields[1]]]
+                value = float(fields[0][1:])
+                if len(signal) != 0 and signal[-1][0] == timestamp:
+                    signal.pop()
+                if len(signal) == 0 or signal[-1][1] != value:
+                    signal.append((timestamp, value))
+
+    return changes
+
+
+parser = argparse.ArgumentParser(description='Check power traces of energy quanta summed per cycle')
+
+parser.add_argument("--launcher", dest="launcher", default="gvsoc_launcher",
+    help="Path to gvsoc_launcher")
+
+args = parser.parse_args()
+
+with tempfile.TemporaryDirectory() as tmpdir:
+    config_path = os.path.join(tmpdir, 'power_trace_test.json')
+    vcd_path = os.path.join(tmpdir, 'power_trace_test.vcd')
+    with open(config_path, 'w') as file:
+        json.dump(get_config(vcd_path), file, indent=2)
+
+    if subprocess.run([args.launcher, '--config=' + config_path], cwd=tmpdir).returncode != 0:
+        sys.exit('Power trace test failed')
+
+    changes = parse_vcd(vcd_path)
+    batched = changes.get('batched')
+    baseline = changes.get('baseline')
+
+    if batched is None or baseline is None or len(baseline) <= 1:
+        sys.exit('Power traces not found in VCD file')
+
+    for index, (expected, got) in enumerate(zip(baseline, batched)):
+        if expected != got:
+            sys.exit('Power trace mismatch at change %d (baseline: %s, batched: %s)' % (index, expected, got))
+
+    if len(batched) != len(baseline):
+        sys.exit('Power trace mismatch (baseline: %d changes, batched: %d changes)' % (len(baseline), len(batched)))
+
+    print('Checked %d power trace changes' % len(baseline))
@@ -22,6 +22,7 @@
 #include <vp/vp.hpp>
 #include "vp/time/time_engine.hpp"
 #include "vp/time/time_scheduler.hpp"
+#include <vp/checkpoint.hpp>
 #include <pthread.h>
 #include <signal.h>
 
@@ -30,7 +31,12 @@ extern "C" void dpi_wait_event_timeout_ps(long long int delay);
 extern "C" long long int dpi_time_ps();
 extern "C" void dpi_create_task(void *arg0, void *arg1);
 
+// Signals are process-wide, a single thread is catching them and stopping all the
+// engines of the simulator instances running in this process.
 static pthread_t sigint_thread;
+static pthread_once_t sigint_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t sigint_engines_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<vp::time_engine *> sigint_engines;
 
 #ifdef __VP_USE_SYSTEMC
 
@@ -66,6 +72,15 @@ private:
     vp::time_engine *top;
 };
 
+// Client pushed into each partition at the end of the quantum, the partition
+// stops executing clients when it reaches it.
+class Time_engine_quantum_end : public vp::time_engine_client
+{
+public:
+    Time_engine_quantum_end(vp::time_engine *engine) : vp::time_engine_client(NULL) { this->engine = engine; }
+    int64_t exec() { return 0; }
+};
+
 class time_domain : public vp::time_engine
 {
 
@@ -117,7 +132,6 @@ static void sigint_handler(int s)
 // so that the python world can properly close everything
 static void *signal_routine(void *arg)
 {
-    vp::time_engine *engine = (vp::time_engine *)arg;
     sigset_t sigs_to_catch;
     int caught;
     sigemptyset(&sigs_to_catch);
@@ -125,11 +139,25 @@ static void *signal_routine(void *arg)
     do
     {
         sigwait(&sigs_to_catch, &caught);
-        engine->stop_engine(-1, true);
+        pthread_mutex_lock(&sigint_engines_mutex);
+        for (vp::time_engine *engine: sigint_engines)
+        {
+            engine->stop_engine(-1, true);
+        }
+        pthread_mutex_unlock(&sigint_engines_mutex);
     } while (1);
     return NULL;
 }
 
+// Called once by the first engine thread, which is blocking SIGINT, so that the
+// signal thread inherits it and can wait for it
+static void sigint_init()
+{
+    pthread_create(&sigint_thread, NULL, signal_routine, NULL);
+
+    signal(SIGINT, sigint_handler);
+}
+
 #ifdef __VP_USE_SYSTEMC
 static void *engine_routine_sc_stub(void *arg)
 {
@@ -163,9 +191,11 @@ static void *engine_routine(void *arg)
     sigemptyset(&sigs_to_block);
     sigaddset(&sigs_to_block, SIGINT);
     pthread_sigmask(SIG_BLOCK, &sigs_to_block, NULL);
-    pthread_create(&sigint_thread, NULL, signal_routine, (void *)engine);
+    pthread_once(&sigint_once, sigint_init);
 
-    signal(SIGINT, sigint_handler);
+    pthread_mutex_lock(&sigint_engines_mutex);
+    sigint_engines.push_back(engine);
+    pthread_mutex_unlock(&sigint_engines_mutex);
 
     engine->run_loop();
 #endif
@@ -173,7 +203,7 @@ static void *engine_routine(void *arg)
 }
 
 vp::time_engine::time_engine(js::config *config)
-    : vp::component(config), first_client(NULL)
+    : vp::component(config)
 {
     pthread_mutex_init(&mutex, NULL);
     pthread_cond_init(&cond, NULL);
@@ -185,6 +215,33 @@ vp::time_engine::time_engine(js::config *config)
 }
 
 
+vp::time_engine::~time_engine()
+{
+    this->parallel_quit();
+}
+
+
+void vp::time_engine::stop()
+{
+    this->parallel_quit();
+}
+
+
+// Partitions are not executed by run_loop but by partition_loop, which is always
+// allowed to run, stops being handled by the parent engine.
+vp::time_engine::time_engine(vp::time_engine *parent, int partition_id)
+    : vp::component(NULL), parent(parent), partition_id(partition_id)
+{
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cond, NULL);
+
+    run_req = true;
+    stop_req = false;
+    pause_req = false;
+    running = false;
+}
+
+
 
 // This is called by the python thread once he wants to start the time engine.
 // This for now just takes care of stopping the engine when it is asked
@@ -229,7 +286,10 @@ int vp::time_engine::join()
         pthread_cond_wait(&cond, &mutex);
     }
 
-    if (finished)
+    // In parallel mode, the stop request is only seen at the end of the quantum,
+    // the engine may then also have run out of events, in which case the stop
+    // status must still be reported
+    if (finished && !stop_req)
         goto end;
 
     // In case we get a stop request, first try to kindly stop the engine.
@@ -256,15 +316,23 @@ int vp::time_engine::join()
                 running = false;
                 pthread_cancel(run_thread);
                 stop_status = -1;
+                this->parallel_cancelled = true;
             }
         }
     }
 
     result = stop_status;
 
+end:
+    // Released on both paths, as parallel_quit takes the lock
     pthread_mutex_unlock(&mutex);
 
-end:
+    if (this->partitions.size())
+    {
+        this->parallel_report();
+        this->parallel_quit();
+    }
+
     return result;
 }
 
@@ -297,6 +365,8 @@ void vp::time_engine::start()
 
     this->stop_event = new Time_engine_stop_event(this);
 
+    this->parallel_init();
+
     if (sa_mode)
     {
     #ifdef __VP_USE_SYSTEMV
@@ -311,8 +381,368 @@ void vp::time_engine::start()
 
 void vp::time_engine::wait_ready()
 {
-    while (!first_client)
+    while (!first_client())
+    {
+    }
+}
+
+void vp::time_engine::checkpoint(vp::checkpoint *cp)
+{
+    int64_t time = this->time;
+    cp->value(time);
+
+    if (cp->is_restore())
+    {
+        int64_t delta = time - this->time;
+
+        // Shifting all clients by the same amount keeps the heap ordered
+        for (time_engine_client *client: this->clients)
+        {
+            client->next_event_time += delta;
+        }
+        this->time = time;
+
+        for (time_engine *partition: this->partitions)
+        {
+            if (partition != this)
+            {
+                for (time_engine_client *client: partition->clients)
+                {
+                    client->next_event_time += delta;
+                }
+                partition->time += delta;
+            }
+        }
+    }
+}
+
+
+
+static inline int64_t get_host_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+void vp::time_engine::parallel_init()
+{
+    js::config *config = this->get_js_config()->get("**/gvsoc/parallel");
+    js::config *paths = config ? config->get("partitions") : NULL;
+
+    if (paths == NULL || paths->get_elems().size() == 0)
+        return;
+
+#if defined(__VP_USE_SYSTEMC) || defined(__VP_USE_SYSTEMV)
+    fprintf(stderr, "Parallel mode is not supported with SystemC or SystemVerilog, ignoring it\n");
+    return;
+#endif
+
+    js::config *quantum = config->get("quantum");
+    this->quantum = quantum ? quantum->get_int() : 1000000;
+    if (this->quantum <= 0)
     {
+        this->quantum = 1000000;
+    }
+
+    this->partitions.push_back(this);
+    this->partition_paths.push_back("");
+
+    for (js::config *path: paths->get_elems())
+    {
+        this->partitions.push_back(new time_engine(this, this->partitions.size()));
+        this->partition_paths.push_back(path->get_str());
+    }
+
+    for (time_engine *partition: this->partitions)
+    {
+        partition->deferred.resize(this->partitions.size());
+        partition->quantum_end_client = new Time_engine_quantum_end(partition);
+    }
+
+    // Each clock engine goes to the partition with the longest path containing it,
+    // or stays in this one. This must be done before the ports are finalized, so that
+    // they see which bindings are crossing partitions.
+    std::function<void(vp::component *)> assign = [&](vp::component *comp)
+    {
+        vp::time_engine_client *clock = dynamic_cast<vp::clock_engine *>(comp);
+        if (clock)
+        {
+            std::string comp_path = comp->get_path();
+            int partition_id = 0;
+            size_t match_size = 0;
+
+            for (size_t i=1; i<this->partition_paths.size(); i++)
+            {
+                std::string &path = this->partition_paths[i];
+                if ((comp_path == path || comp_path.compare(0, path.size() + 1, path + "/") == 0) &&
+                    path.size() > match_size)
+                {
+                    partition_id = i;
+                    match_size = path.size();
+                }
+            }
+
+            time_engine *partition = this->partitions[partition_id];
+            partition->nb_clock_engines++;
+
+            if (partition != this)
+            {
+                bool is_enqueued = clock->is_enqueued;
+                int64_t next_event_time = clock->next_event_time;
+
+                this->dequeue(clock);
+                clock->engine = partition;
+
+                if (is_enqueued)
+                {
+                    clock->next_event_time = next_event_time;
+                    partition->client_push(clock);
+                }
+            }
+        }
+
+        for (vp::component *child: comp->get_childs())
+        {
+            assign(child);
+        }
+    };
+
+    assign(this);
+}
+
+
+void *vp::time_engine::partition_routine(void *arg)
+{
+    vp::time_engine *engine = (vp::time_engine *)arg;
+    engine->partition_loop();
+    return NULL;
+}
+
+
+void vp::time_engine::partition_loop()
+{
+    vp::time_engine::current_partition = this;
+
+    while (1)
+    {
+        pthread_barrier_wait(&this->parent->quantum_start_barrier);
+
+        if (this->parent->parallel_stop)
+            break;
+
+        this->exec_quantum(this->parent->quantum_end);
+        pthread_barrier_wait(&this->parent->quantum_end_barrier);
+    }
+}
+
+
+void vp::time_engine::exec_quantum(int64_t end)
+{
+    int64_t start = get_host_time_ns();
+
+    // The client marking the end of the quantum is pushed first so that clients
+    // enqueued at the same time are executed before. It also prevents clients
+    // from advancing the time beyond the end of the quantum.
+    this->quantum_end_client->next_event_time = end;
+    this->client_push(this->quantum_end_client);
+
+    while (1)
+    {
+        time_engine_client *current = this->client_pop();
+
+        if (current == this->quantum_end_client)
+            break;
+
+        this->time = current->next_event_time;
+
+        current->running = true;
+        int64_t time = current->exec();
+        current->running = false;
+
+        if (time > 0)
+        {
+            current->next_event_time = this->time + time;
+            this->client_push(current);
+        }
+    }
+
+    this->time = end;
+
+    this->busy_time += get_host_time_ns() - start;
+}
+
+
+void vp::time_engine::flush_deferred()
+{
+    bool pending = true;
+
+    // No partition is running, calls are delivered in order of partition and
+    // then of destination, so that the simulation is deterministic.
+    while (pending)
+    {
+        pending = false;
+
+        for (time_engine *partition: this->partitions)
+        {
+            for (auto &queue: partition->deferred)
+            {
+                if (queue.size() == 0)
+                    continue;
+
+                // Delivered calls can defer new ones, which are then delivered
+                // by the next iteration
+                std::vector<std::function<void()>> calls;
+                calls.swap(queue);
+
+                for (auto &call: calls)
+                {
+                    call();
+                }
+
+                this->nb_deferred += calls.size();
+                pending = true;
+            }
+        }
+    }
+}
+
+
+void vp::time_engine::parallel_run()
+{
+    if (!this->parallel_started)
+    {
+        this->parallel_started = true;
+
+        pthread_barrier_init(&this->quantum_start_barrier, NULL, this->partitions.size());
+        pthread_barrier_init(&this->quantum_end_barrier, NULL, this->partitions.size());
+
+        for (size_t i=1; i<this->partitions.size(); i++)
+        {
+            pthread_t thread;
+            pthread_create(&thread, NULL, &time_engine::partition_routine, (void *)this->partitions[i]);
+            this->partition_threads.push_back(thread);
+        }
+    }
+
+    int64_t start = get_host_time_ns();
+
+    while (this->run_req)
+    {
+        // Calls deferred while the engine was not running, for example during reset,
+        // must be delivered before the next event is searched
+        this->flush_deferred();
+
+        int64_t next = -1;
+        for (time_engine *partition: this->partitions)
+        {
+            time_engine_client *client = partition->first_client();
+            if (client && (next == -1 || client->next_event_time < next))
+            {
+                next = client->next_event_time;
+            }
+        }
+
+        if (next == -1)
+            break;
+
+        // The quantum starts at the first event so that idle periods are skipped
+        for (time_engine *partition: this->partitions)
+        {
+            if (partition->time < next)
+            {
+                partition->time = next;
+            }
+        }
+
+        this->quantum_end = next + this->quantum;
+
+        pthread_barrier_wait(&this->quantum_start_barrier);
+        vp::time_engine::current_partition = this;
+        this->exec_quantum(this->quantum_end);
+        vp::time_engine::current_partition = NULL;
+        pthread_barrier_wait(&this->quantum_end_barrier);
+
+        this->nb_quanta++;
+    }
+
+    this->flush_deferred();
+
+    this->parallel_time += get_host_time_ns() - start;
+}
+
+
+// Stop the partition threads. They are waiting for the next quantum, and see
+// the stop flag when they are released.
+void vp::time_engine::parallel_quit()
+{
+    if (!this->parallel_started)
+        return;
+
+    // The partition threads are only waiting for the next quantum when the engine
+    // thread is not executing one
+    pthread_mutex_lock(&mutex);
+    bool is_running = this->running;
+    pthread_mutex_unlock(&mutex);
+
+    if (is_running)
+        return;
+
+    this->parallel_started = false;
+
+    if (this->parallel_cancelled)
+    {
+        // The engine thread may have been cancelled in the middle of a quantum,
+        // the other threads can not be released safely.
+        for (pthread_t thread: this->partition_threads)
+        {
+            pthread_detach(thread);
+        }
+        this->partition_threads.clear();
+        return;
+    }
+
+    this->parallel_stop = true;
+    pthread_barrier_wait(&this->quantum_start_barrier);
+
+    for (pthread_t thread: this->partition_threads)
+    {
+        pthread_join(thread, NULL);
+    }
+    this->partition_threads.clear();
+
+    pthread_barrier_destroy(&this->quantum_start_barrier);
+    pthread_barrier_destroy(&this->quantum_end_barrier);
+}
+
+
+void vp::time_engine::parallel_report()
+{
+    double wall_time = this->parallel_time / 1e9;
+    int64_t busy_time = 0;
+
+    for (time_engine *partition: this->partitions)
+    {
+        busy_time += partition->busy_time;
+    }
+
+    // The speedup is estimated as the time a single thread would have needed to
+    // execute all partitions, compared to the time spent in parallel.
+    printf("Parallel simulation report:\n");
+    printf("  Partitions: %ld, quantum: %ld ps, quanta: %ld\n", this->partitions.size(),
+        this->quantum, this->nb_quanta);
+    printf("  Cross-partition calls: %ld, each delayed by up to %ld ps\n", this->nb_deferred,
+        this->quantum);
+    printf("  Wall time: %.3f s, estimated speedup: %.2fx\n", wall_time,
+        wall_time > 0 ? busy_time / 1e9 / wall_time : 0.0);
+
+    for (size_t i=0; i<this->partitions.size(); i++)
+    {
+        time_engine *partition = this->partitions[i];
+        printf("  Partition %ld (%s): %d clock engines, busy %.3f s (%.1f%%)\n", i,
+            i == 0 ? "default" : this->partition_paths[i].c_str(), partition->nb_clock_engines,
+            partition->busy_time / 1e9, wall_time > 0 ? partition->busy_time / 1e7 / wall_time : 0.0);
     }
 }
 
@@ -395,12 +825,15 @@ void vp::time_engine::run_loop()
 
         pthread_mutex_unlock(&mutex);
 
-        time_engine_client *current = first_client;
+        time_engine_client *current = first_client();
 
-        if (current)
+        if (this->partitions.size())
         {
-            first_client = current->next;
-            current->is_enqueued = false;
+            this->parallel_run();
+        }
+        else if (current)
+        {
+            this->client_pop();
 
 #if defined(__VP_USE_SYSTEMC) || defined(__VP_USE_SYSTEMV)
             while(1)
@@ -446,20 +879,7 @@ void vp::time_engine::run_loop()
                 {
                     time += this->time;
                     current->next_event_time = time;
-                    time_engine_client *client = first_client, *prev = NULL;
-
-                    while (client && client->next_event_time < time)
-                    {
-                        prev = client;
-                        client = client->next;
-                    }
-                    if (prev)
-                        prev->next = current;
-                    else
-                        first_client = current;
-
-                    current->next = client;
-                    current->is_enqueued = true;
+                    this->client_push(current);
                 }
 
                 if (!run_req)
@@ -470,7 +890,7 @@ void vp::time_engine::run_loop()
                 // enqueues a new event.
                 while (1)
                 {
-                    if (!first_client)
+                    if (!first_client())
                     {
                         if (stop_req || locked)
                         {
@@ -491,44 +911,43 @@ void vp::time_engine::run_loop()
                         // or wait unil the systemC part enqueues something before
 
 #if defined(__VP_USE_SYSTEMV)
-                        int64_t diff = first_client->next_event_time - dpi_time_ps();
+                        int64_t diff = first_client()->next_event_time - dpi_time_ps();
                         // Be careful on xcelium the time is sometimes rounded to the upper picosecond
                         //vp_assert(diff >= -1, NULL, "SystemV time is after vp time\n");
                         if (diff > 0)
-                            dpi_wait_event_timeout_ps(first_client->next_event_time - dpi_time_ps());
+                            dpi_wait_event_timeout_ps(first_client()->next_event_time - dpi_time_ps());
                         this->time = dpi_time_ps();
-                        if (this->time >= first_client->next_event_time)
+                        if (this->time >= first_client()->next_event_time)
                         {
-                            this->time = first_client->next_event_time;
+                            this->time = first_client()->next_event_time;
                             break;
                         }
 #else
-                        vp_assert(first_client->next_event_time >= (int64_t)sc_time_stamp().to_double(), NULL, "SystemC time is after vp time\n");
-                        wait(first_client->next_event_time - (int64_t)sc_time_stamp().to_double(), SC_PS, sync_event);
+                        vp_assert(first_client()->next_event_time >= (int64_t)sc_time_stamp().to_double(), NULL, "SystemC time is after vp time\n");
+                        wait(first_client()->next_event_time - (int64_t)sc_time_stamp().to_double(), SC_PS, sync_event);
 
                         int64_t current_sc_time = (int64_t)sc_time_stamp().to_double();
 
-                        if (current_sc_time == first_client->next_event_time)
+                        if (current_sc_time == first_client()->next_event_time)
                             break;
 #endif
 
                     }
                 }
 
-                current = first_client;
+                current = first_client();
                 if (current)
                 {
-                    vp_assert(first_client->next_event_time >= get_time(), NULL, "event time is before vp time\n");
+                    vp_assert(current->next_event_time >= get_time(), NULL, "event time is before vp time\n");
 
-                    first_client = current->next;
-                    current->is_enqueued = false;
+                    this->client_pop();
                 }
 
 #else
 
                 int64_t time = current->exec();
 
-                time_engine_client *next = first_client;
+                time_engine_client *next = first_client();
 
                 // Shortcut to quickly continue with the same client
                 if (likely(time > 0))
@@ -543,32 +962,19 @@ void vp::time_engine::run_loop()
                         }
                         else
                         {
-                            current->next = first_client;
-                            first_client = current;
                             current->next_event_time = time;
-                            current->is_enqueued = true;
+                            this->client_push(current);
                             current->running = false;
                             break;
                         }
                     }
                 }
 
-                // Otherwise remove it, reenqueue it and continue with the next one.
-                // We can optimize a bit the operation as we already know
-                // who to schedule next.
-
+                // Otherwise reenqueue it and continue with the next one.
                 if (time > 0)
                 {
                     current->next_event_time = time;
-                    time_engine_client *client = next->next, *prev = next;
-                    while (client && client->next_event_time < time)
-                    {
-                        prev = client;
-                        client = client->next;
-                    }
-                    current->next = client;
-                    prev->next = current;
-                    current->is_enqueued = true;
+                    this->client_push(current);
                 }
 
                 current->running = false;
@@ -576,13 +982,12 @@ void vp::time_engine::run_loop()
                 if (!run_req)
                     break;
 
-                current = first_client;
+                current = first_client();
                 if (current)
                 {
-                    vp_assert(first_client->next_event_time >= get_time(), NULL, "event time is before vp time\n");
+                    vp_assert(current->next_event_time >= get_time(), NULL, "event time is before vp time\n");
 
-                    first_client = current->next;
-                    current->is_enqueued = false;
+                    this->client_pop();
                 }
 
 #endif
@@ -599,7 +1004,7 @@ void vp::time_engine::run_loop()
 
         running = false;
 
-        while (!first_client && retain_count && !locked)
+        while (!this->has_clients() && this->get_retain_count() && !locked)
         {
 #if defined(__VP_USE_SYSTEMV)
             pthread_mutex_unlock(&mutex);
@@ -614,9 +1019,9 @@ void vp::time_engine::run_loop()
 #endif
         }
 
-        current = first_client;
+        current = first_client();
 
-        if (first_client == NULL && !locked && !retain_count)
+        if (!this->has_clients() && !locked && !this->get_retain_count())
         {
 #ifdef __VP_USE_SYSTEMC
             sc_stop();
@@ -644,6 +1049,12 @@ void vp::time_engine::register_exec_notifier(Notifier *notifier)
 
 void vp::time_engine::stop_exec()
 {
+    if (this->parent)
+    {
+        this->parent->stop_exec();
+        return;
+    }
+
     pthread_mutex_lock(&mutex);
     pthread_cond_broadcast(&cond);
     this->pause_req = true;
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Component executing one clock event per cycle, used to measure how many
+ * events per second the time engine can schedule depending on the number of
+ * clock domains. It is driven by time_engine_bench.py, which puts one of them
+ * in each clock domain.
+ */
+
+#include <vp/vp.hpp>
+#include <stdio.h>
+#include <chrono>
+
+// All the instances are loaded from the same library, so they can share the
+// global counters
+static int64_t nb_events = 0;
+static bool started = false;
+static bool stopped = false;
+static std::chrono::steady_clock::time_point start_time;
+
+class time_engine_bench : public vp::component
+{
+
+public:
+  time_engine_bench(js::config *config);
+
+  int build();
+  void reset(bool active);
+
+private:
+  static void handler(void *__this, vp::clock_event *event);
+
+  vp::clock_event *event;
+  int64_t nb_cycles;
+};
+
+time_engine_bench::time_engine_bench(js::config *config)
+: vp::component(config)
+{
+
+}
+
+void time_engine_bench::handler(void *__this, vp::clock_event *event)
+{
+  time_engine_bench *_this = (time_engine_bench *)__this;
+
+  nb_events++;
+
+  // Keep the event enqueued even when stopping, otherwise the engine may see
+  // that it ran out of events before handling the stop request
+  _this->event_enqueue(_this->event, 1);
+
+  if (!stopped && _this->get_clock()->get_cycles() >= _this->nb_cycles)
+  {
+    stopped = true;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    printf("Executed %ld events in %.3f s (%.0f events/s)\n", nb_events, elapsed, nb_events / elapsed);
+
+    _this->get_clock()->stop_engine(0);
+  }
+}
+
+int time_engine_bench::build()
+{
+  this->event = this->event_new(time_engine_bench::handler);
+
+  this->nb_cycles = this->get_js_config()->get_child_int("nb_cycles");
+
+  return 0;
+}
+
+void time_engine_bench::reset(bool active)
+{
+  if (!active)
+  {
+    if (!started)
+    {
+      started = true;
+      start_time = std::chrono::steady_clock::now();
+    }
+
+    this->event_enqueue(this->event, 1);
+  }
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+  return new time_engine_bench(config);
+}
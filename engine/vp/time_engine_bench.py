@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Measures the number of events per second executed by the time engine
+# depending on the number of clock domains. For each number of domains, a
+# system made of clock domains with different frequencies, each one with a
+# vp.time_engine_bench component executing one event per cycle, is simulated
+# with gvsoc_launcher. The total number of events is the same for all the
+# measures.
+#
+# Example:
+#   GVSOC_PATH=<install>/models ./time_engine_bench.py --domains 2 16 256
+#
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def get_config(nb_domains, nb_cycles):
+
+    components = []
+    bindings = []
+
+    target = {
+        'vp_component': 'utils.composite_impl'
+    }
+
+    for i in range(0, nb_domains):
+        clock = 'clock%d' % i
+        bench = 'bench%d' % i
+        components += [clock, bench]
+
+        # Frequencies are all different so that the domains keep being
+        # reordered in the time engine
+        target[clock] = {'vp_component': 'vp.clock_domain_impl', 'frequency': 100000000 + i * 1370000}
+        target[bench] = {'vp_component': 'vp.time_engine_bench', 'nb_cycles': nb_cycles}
+        bindings.append(['%s->out' % clock, '%s->clock' % bench])
+
+    target['components'] = components
+    target['bindings'] = bindings
+
+    return {
+        'gvsoc': {
+            'sa-mode': True,
+            'traces': {'level': 'info', 'include_regex': [], 'format': 'long'},
+            'events': {'include_regex': [], 'include_raw': []}
+        },
+        'target': target
+    }
+
+
+parser = argparse.ArgumentParser(description='Measure the time engine throughput')
+
+parser.add_argument("--launcher", dest="launcher", default="gvsoc_launcher",
+    help="Path to gvsoc_launcher")
+parser.add_argument("--domains", dest="domains", type=int, nargs='+', default=[2, 4, 16, 64, 256],
+    help="Numbers of clock domains to measure")
+parser.add_argument("--events", dest="events", type=int, default=10000000,
+    help="Approximate number of events executed for each measure")
+
+args = parser.parse_args()
+
+with tempfile.TemporaryDirectory() as tmpdir:
+    for nb_domains in args.domains:
+        config_path = os.path.join(tmpdir, 'time_engine_bench_%d.json' % nb_domains)
+        with open(config_path, 'w') as file:
+            json.dump(get_config(nb_domains, int(args.events / nb_domains)), file, indent=2)
+
+        print('%d domains: ' % nb_domains, end='', flush=True)
+        if subprocess.run([args.launcher, '--config=' + config_path]).returncode != 0:
+            sys.exit('Benchmark failed with %d domains' % nb_domains)
@@ -26,6 +26,7 @@
 #include <vector>
 #include <thread>
 #include <string.h>
+#include <algorithm>
 
 class trace_regex
 {
@@ -102,12 +103,41 @@ vp::trace_engine::trace_engine(js::config *config)
     pthread_mutex_init(&mutex, NULL);
     pthread_cond_init(&cond, NULL);
 
-    for (int i = 0; i < TRACE_EVENT_NB_BUFFER; i++)
+    this->nb_buffers = TRACE_EVENT_NB_BUFFER;
+
+    js::config *events_config = config ? config->get("gvsoc/events") : NULL;
+    if (events_config)
+    {
+        std::string policy = events_config->get_child_str("buffer_policy");
+        if (policy == "drop")
+        {
+            this->buffer_policy = vp::TRACE_BUFFER_POLICY_DROP;
+        }
+        else if (policy == "grow")
+        {
+            this->buffer_policy = vp::TRACE_BUFFER_POLICY_GROW;
+        }
+        else if (policy != "" && policy != "block")
+        {
+            throw std::invalid_argument("Invalid events buffer policy: " + policy);
+        }
+
+        int nb_buffers = events_config->get_child_int("nb_buffers");
+        if (nb_buffers > 0)
+        {
+            this->nb_buffers = std::min(nb_buffers, TRACE_EVENT_MAX_BUFFER);
+        }
+    }
+
+    for (int i = 0; i < this->nb_buffers; i++)
+    {
+        event_buffers.push(new char[TRACE_EVENT_BUFFER_SIZE]);
+    }
+    if (this->buffer_policy == vp::TRACE_BUFFER_POLICY_DROP)
     {
-        event_buffers.push_back(new char[TRACE_EVENT_BUFFER_SIZE]);
+        this->drop_buffer = new char[TRACE_EVENT_BUFFER_SIZE];
     }
-    current_buffer = event_buffers[0];
-    event_buffers.erase(event_buffers.begin());
+    current_buffer = event_buffers.pop();
     current_buffer_size = 0;
     this->first_pending_event = NULL;
 
@@ -83,6 +83,11 @@ class Testbench(st.Component):
                 "nb_i2c": 3,
                 "nb_i2s": 3,
 
+                "audio_stream": {
+                    "block_size": 4096,
+                    "thread": False
+                },
+
                 "spislave_boot": {
                     "enabled": False,
                     "delay_ps": "1000000000",
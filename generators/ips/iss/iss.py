@@ -52,6 +52,14 @@ class Iss(st.Component):
         starts it (default: False).
     boot_addr : int, optional
         Address of the first instruction (default: 0)
+    dmi : bool, optional
+        True if the ISS can access memories directly when they grant it, instead of sending requests (default: True)
+    block_exec : bool, optional
+        True if the ISS can execute several instructions from the same clock event when nothing else is scheduled
+        in-between (default: True)
+    shared_decode : bool, optional
+        True if the decoded instructions should be shared with the other cores using the same ISA, instead of each
+        core decoding its own copy (default: False)
     
     """
 
@@ -71,7 +79,10 @@ class Iss(st.Component):
             cluster_id: int=0,
             core_id: int=0,
             fetch_enable: bool=False,
-            boot_addr: int=0):
+            boot_addr: int=0,
+            dmi: bool=True,
+            block_exec: bool=True,
+            shared_decode: bool=False):
 
         super(Iss, self).__init__(parent, name)
 
@@ -92,6 +103,9 @@ class Iss(st.Component):
             'core_id': core_id,
             'fetch_enable': fetch_enable,
             'boot_addr': boot_addr,
+            'dmi': dmi,
+            'block_exec': block_exec,
+            'shared_decode': shared_decode,
         })
 
 
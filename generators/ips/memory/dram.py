@@ -0,0 +1,91 @@
+#
+# Copyright (C) 2020 GreenWaves Technologies
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import gsystree as st
+
+class Dram(st.Component):
+    """
+    DRAM controller with bank and row-buffer timing
+
+    All timings are given in cycles of the clock of the component.
+
+    Attributes
+    ----------
+    size : int
+        The size of the memory.
+    stim_file: str
+        The path to a binary file which should be preloaded at beginning of the memory.
+    channels: int
+        Number of independent channels, each one with its own queue and data bus.
+    ranks: int
+        Number of ranks per channel.
+    banks: int
+        Number of banks per rank.
+    row_size: int
+        Size in bytes of a row.
+    bus_width: int
+        Number of bytes transferred per cycle on the data bus of a channel.
+    page_policy: str
+        "open" to keep rows open after an access, "closed" to precharge them immediately.
+    scheduler: str
+        "fr-fcfs" to serve first requests hitting an open row, "fcfs" to serve them in order.
+    queue_size: int
+        Number of requests of a channel queue considered by the FR-FCFS scheduler.
+    max_row_hits: int
+        Maximum number of consecutive row hits served before the oldest request, to avoid starvation.
+    bandwidth_period: int
+        Number of cycles over which the bandwidth trace event is computed.
+    timings: dict
+        tRCD, tRP, tCL, tRAS, tWR, tRFC and tREFI. Setting tREFI to 0 disables refresh.
+
+    """
+
+    def __init__(self, parent, name, size: int, stim_file: str=None, channels: int=1, ranks: int=1,
+            banks: int=8, row_size: int=2048, bus_width: int=8, page_policy: str='open',
+            scheduler: str='fr-fcfs', queue_size: int=32, max_row_hits: int=16,
+            bandwidth_period: int=1000, timings: dict=None):
+
+        super(Dram, self).__init__(parent, name)
+
+        dram_timings = {
+            'tRCD': 14,
+            'tRP': 14,
+            'tCL': 14,
+            'tRAS': 33,
+            'tWR': 15,
+            'tRFC': 280,
+            'tREFI': 7800
+        }
+
+        if timings is not None:
+            dram_timings.update(timings)
+
+        self.add_properties({
+            'vp_component': 'memory.dram_impl',
+            'size': size,
+            'stim_file': stim_file,
+            'channels': channels,
+            'ranks': ranks,
+            'banks': banks,
+            'row_size': row_size,
+            'bus_width': bus_width,
+            'page_policy': page_policy,
+            'scheduler': scheduler,
+            'queue_size': queue_size,
+            'max_row_hits': max_row_hits,
+            'bandwidth_period': bandwidth_period,
+            'timings': dram_timings
+        })
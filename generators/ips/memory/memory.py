@@ -28,10 +28,19 @@ class Memory(st.Component):
         The path to a binary file which should be preloaded at beginning of the memory.
     power_trigger: bool
         True if the memory should trigger power report generation based on dedicated accesses
+    width_bits: int
+        Log2 of the memory width in bytes, used to model bandwidth. 0 disables bandwidth modeling, which
+        also allows initiators to access the memory directly, and must be set explicitly by platforms
+        which do not need bandwidth modeling (default: 2)
+    mmap: bool
+        True if the memory should be allocated with mmap, so that only modified pages use host memory
+        and stimuli files are shared between simulators. Stimuli files of 1MB or more are then mapped, and must
+        not be modified while the simulation is running (default: True)
     
     """
 
-    def __init__(self, parent, name, size: int, stim_file: str=None, power_trigger: bool=False):
+    def __init__(self, parent, name, size: int, stim_file: str=None, power_trigger: bool=False, width_bits: int=2,
+            mmap: bool=True):
 
         super(Memory, self).__init__(parent, name)
 
@@ -40,5 +49,6 @@ class Memory(st.Component):
             'size': size,
             'stim_file': stim_file,
             'power_trigger': power_trigger,
-            'width_bits': 2
+            'width_bits': width_bits,
+            'mmap': mmap
         })
\ No newline at end of file
@@ -38,7 +38,19 @@ class Gvsoc(st.Component):
         self.add_property("events/files", [ ])
         self.add_property("events/traces", {})
         self.add_property("events/tags", [ "overview" ])
+        # What to do when the event dumper is late: block, drop or grow
+        self.add_property("events/buffer_policy", "block")
+        self.add_property("events/nb_buffers", 4)
+        # Compress FST value changes in a separate thread, with how many threads sharing the
+        # signals of a section, and with which algorithm (zlib, fastlz or lz4)
+        self.add_property("events/fst_parallel", True)
+        self.add_property("events/fst_threads", 4)
+        self.add_property("events/fst_pack", "lz4")
         self.add_property("events/gtkw", False)
+        # Component paths whose clock domains are simulated on separate threads, and the
+        # synchronization quantum between them in picoseconds
+        self.add_property("parallel/partitions", [])
+        self.add_property("parallel/quantum", 1000000)
 
         self.add_properties({
             "description": "GAP simulator.",
@@ -27,6 +27,10 @@
 
 #define GV_IOREQ_DESC_TYPE_REQUEST  0
 #define GV_IOREQ_DESC_TYPE_RESPONSE 1
+// Only used by the shared-memory ring to skip the end of the ring
+#define GV_IOREQ_DESC_TYPE_PAD      2
+// Only used by the shared-memory ring for the next chunks of a big payload
+#define GV_IOREQ_DESC_TYPE_DATA     3
 
 typedef struct {
   int64_t              type;
@@ -0,0 +1,424 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#ifndef __VP_LAUNCHER_RING_HPP_
+#define __VP_LAUNCHER_RING_HPP_
+
+#include "vp/launcher_internal.hpp"
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <atomic>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// Shared-memory transport used between the launcher and the injector, one ring
+// per direction. Each message is a gv_ioreq_desc_t followed by its payload, if
+// any, so that requests and responses never go through a syscall.
+// Payloads bigger than GV_IOREQ_RING_MAX_PAYLOAD are split into chunks, the
+// first one following the descriptor and the next ones sent as data messages,
+// which are received with gv_ioreq_ring_recv_payload.
+// The consumer drains all the available messages before going to sleep on an
+// eventfd, and producers only ring it when the consumer is sleeping, so that
+// syscalls are only done when one side is idle. In the same way, a producer
+// finding the ring full sleeps on a futex of the ring, which the consumer only
+// wakes up when the producer is sleeping.
+// Sleeping sides wake up periodically to check that the other side is still
+// there, so that they don't wait forever if it exited or closed the ring.
+
+#define GV_IOREQ_RING_SIZE      (1 << 20)
+// Number of polls done before the consumer goes to sleep
+#define GV_IOREQ_RING_SPIN      1024
+// Biggest payload chunk which is sent in one message
+#define GV_IOREQ_RING_MAX_PAYLOAD (GV_IOREQ_RING_SIZE / 4)
+// Time after which a sleeping side checks that the other side is still there
+#define GV_IOREQ_RING_TIMEOUT_MS 100
+
+typedef struct {
+  std::atomic<uint64_t> head;              // Total number of bytes written, only modified by the producer
+  uint8_t pad0[64 - sizeof(std::atomic<uint64_t>)];
+  std::atomic<uint64_t> tail;              // Total number of bytes read, only modified by the consumer
+  uint8_t pad1[64 - sizeof(std::atomic<uint64_t>)];
+  std::atomic<uint32_t> consumer_sleeping; // Set by the consumer when it is about to wait on the doorbell
+  uint8_t pad2[64 - sizeof(std::atomic<uint32_t>)];
+  std::atomic<uint32_t> producer_sleeping; // Set by the producer when it is about to wait for room
+  std::atomic<uint32_t> room_doorbell;     // Futex incremented by the consumer to wake-up the producer
+  uint8_t pad3[64 - 2 * sizeof(std::atomic<uint32_t>)];
+  std::atomic<int32_t> producer_pid;       // Processes using the ring, 0 until they opened it
+  std::atomic<int32_t> consumer_pid;
+  std::atomic<uint32_t> closed;            // Set when one side stopped using the ring
+  uint8_t pad4[64 - 3 * sizeof(std::atomic<uint32_t>)];
+  uint8_t data[GV_IOREQ_RING_SIZE];
+} gv_ioreq_ring_t;
+
+// Process-local view of one ring
+typedef struct {
+  gv_ioreq_ring_t *ring;
+  int doorbell;                            // eventfd used to wake-up the consumer
+  bool is_producer;                        // True if this process writes to this ring
+  int peer_pidfd;                          // pidfd of the other side, -1 until it is opened
+  pthread_mutex_t lock;                    // Serializes the producers of this process
+} gv_ioreq_ring_port_t;
+
+static inline uint64_t gv_ioreq_ring_payload_size(uint64_t size)
+{
+  return (size + 7) & ~7ULL;
+}
+
+// Size of the part of a payload which is sent with the descriptor
+static inline uint64_t gv_ioreq_ring_chunk_size(uint64_t size)
+{
+  return size < GV_IOREQ_RING_MAX_PAYLOAD ? size : GV_IOREQ_RING_MAX_PAYLOAD;
+}
+
+static inline int gv_ioreq_ring_ring_doorbell(gv_ioreq_ring_port_t *port)
+{
+  uint64_t value = 1;
+  while (write(port->doorbell, &value, sizeof(value)) != sizeof(value))
+  {
+    if (errno != EINTR) return -1;
+  }
+  return 0;
+}
+
+static inline void gv_ioreq_ring_futex_wait(std::atomic<uint32_t> *futex, uint32_t value, int timeout_ms)
+{
+  struct timespec timeout = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+  // The ring is shared between processes, so the futex must not be private
+  syscall(SYS_futex, (uint32_t *)futex, FUTEX_WAIT, value, &timeout, NULL, 0);
+}
+
+static inline void gv_ioreq_ring_futex_wake(std::atomic<uint32_t> *futex)
+{
+  syscall(SYS_futex, (uint32_t *)futex, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+// Tell if the other side of the ring may still send or receive messages, which
+// is not the case anymore once it closed the ring or exited
+static inline bool gv_ioreq_ring_peer_alive(gv_ioreq_ring_port_t *port)
+{
+  gv_ioreq_ring_t *ring = port->ring;
+
+  if (ring->closed.load(std::memory_order_acquire)) return false;
+
+  pid_t pid = port->is_producer ? ring->consumer_pid.load(std::memory_order_acquire) :
+    ring->producer_pid.load(std::memory_order_acquire);
+
+  // The other side has not opened the ring yet
+  if (pid == 0) return true;
+
+#ifdef SYS_pidfd_open
+  // A pidfd is used instead of the pid, since it is still valid once the process
+  // exited, even if it has not been reaped yet
+  if (port->peer_pidfd == -1)
+  {
+    port->peer_pidfd = syscall(SYS_pidfd_open, pid, 0);
+    if (port->peer_pidfd == -1) return errno != ESRCH;
+  }
+
+  struct pollfd fd = { port->peer_pidfd, POLLIN, 0 };
+  return poll(&fd, 1, 0) == 0;
+#else
+  return kill(pid, 0) == 0 || errno != ESRCH;
+#endif
+}
+
+// Set the consumer position, and wake-up the producer if it is waiting for room
+static inline void gv_ioreq_ring_set_tail(gv_ioreq_ring_t *ring, uint64_t tail)
+{
+  ring->tail.store(tail, std::memory_order_release);
+
+  // Pairs with the fence of the producer, so that either it sees the new tail,
+  // or we see that it is sleeping
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (ring->producer_sleeping.load(std::memory_order_relaxed))
+  {
+    ring->room_doorbell.fetch_add(1, std::memory_order_release);
+    gv_ioreq_ring_futex_wake(&ring->room_doorbell);
+  }
+}
+
+// Allocate the shared memory for both rings and return its file descriptor,
+// which is inherited by the platform process, or -1 on error.
+static inline int gv_ioreq_ring_alloc()
+{
+  int fd = memfd_create("gv_ioreq_ring", 0);
+  if (fd == -1) return -1;
+
+  if (ftruncate(fd, 2 * sizeof(gv_ioreq_ring_t)) == -1)
+  {
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+// Map ring number index (0 or 1) of the shared memory, as its producer or as its
+// consumer
+static inline int gv_ioreq_ring_open(gv_ioreq_ring_port_t *port, int shm_fd, int index, int doorbell, bool is_producer)
+{
+  void *mem = mmap(NULL, 2 * sizeof(gv_ioreq_ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+  if (mem == MAP_FAILED) return -1;
+
+  port->ring = &((gv_ioreq_ring_t *)mem)[index];
+  port->doorbell = doorbell;
+  port->is_producer = is_producer;
+  port->peer_pidfd = -1;
+  pthread_mutex_init(&port->lock, NULL);
+
+  if (is_producer)
+    port->ring->producer_pid.store(getpid(), std::memory_order_release);
+  else
+    port->ring->consumer_pid.store(getpid(), std::memory_order_release);
+
+  return 0;
+}
+
+// Stop using the ring, and wake-up the other side so that it stops waiting for it
+static inline void gv_ioreq_ring_close(gv_ioreq_ring_port_t *port)
+{
+  gv_ioreq_ring_t *ring = port->ring;
+
+  ring->closed.store(1, std::memory_order_release);
+
+  ring->room_doorbell.fetch_add(1, std::memory_order_release);
+  gv_ioreq_ring_futex_wake(&ring->room_doorbell);
+  gv_ioreq_ring_ring_doorbell(port);
+}
+
+// Tell if there is room for a message of size msg_size, after skipping skip bytes
+static inline bool gv_ioreq_ring_has_room(gv_ioreq_ring_t *ring, uint64_t head, uint64_t skip, uint64_t msg_size)
+{
+  return head + skip + msg_size - ring->tail.load(std::memory_order_acquire) <= GV_IOREQ_RING_SIZE;
+}
+
+// Push one message, with a payload of at most GV_IOREQ_RING_MAX_PAYLOAD bytes,
+// waiting if the ring is full. Must be called with the port locked. Returns -1
+// if the consumer is gone while waiting or could not be woken up.
+static inline int gv_ioreq_ring_push(gv_ioreq_ring_port_t *port, gv_ioreq_desc_t *desc, void *payload, uint64_t payload_size)
+{
+  gv_ioreq_ring_t *ring = port->ring;
+  uint64_t msg_size = sizeof(gv_ioreq_desc_t) + gv_ioreq_ring_payload_size(payload_size);
+
+  uint64_t head = ring->head.load(std::memory_order_relaxed);
+  uint64_t pos = head % GV_IOREQ_RING_SIZE;
+  uint64_t to_end = GV_IOREQ_RING_SIZE - pos;
+  // Messages are never split, the end of the ring is skipped if the message
+  // does not fit
+  uint64_t skip = to_end < msg_size ? to_end : 0;
+
+  for (int i = 0; i < GV_IOREQ_RING_SPIN && !gv_ioreq_ring_has_room(ring, head, skip, msg_size); i++)
+  {
+  }
+
+  while (!gv_ioreq_ring_has_room(ring, head, skip, msg_size))
+  {
+    uint32_t doorbell = ring->room_doorbell.load(std::memory_order_acquire);
+    ring->producer_sleeping.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (!gv_ioreq_ring_has_room(ring, head, skip, msg_size))
+    {
+      if (!gv_ioreq_ring_peer_alive(port))
+      {
+        ring->producer_sleeping.store(0, std::memory_order_relaxed);
+        return -1;
+      }
+
+      gv_ioreq_ring_futex_wait(&ring->room_doorbell, doorbell, GV_IOREQ_RING_TIMEOUT_MS);
+    }
+
+    ring->producer_sleeping.store(0, std::memory_order_relaxed);
+  }
+
+  if (skip)
+  {
+    // The consumer skips the end by itself if there is no room for a descriptor
+    if (skip >= sizeof(gv_ioreq_desc_t))
+    {
+      ((gv_ioreq_desc_t *)&ring->data[pos])->type = GV_IOREQ_DESC_TYPE_PAD;
+    }
+    head += skip;
+    pos = 0;
+  }
+
+  memcpy(&ring->data[pos], (void *)desc, sizeof(gv_ioreq_desc_t));
+  if (payload_size)
+  {
+    memcpy(&ring->data[pos + sizeof(gv_ioreq_desc_t)], payload, payload_size);
+  }
+
+  ring->head.store(head + msg_size, std::memory_order_release);
+
+  // Pairs with the fence of the consumer, so that either it sees the new head,
+  // or we see that it is sleeping
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (ring->consumer_sleeping.load(std::memory_order_relaxed))
+  {
+    return gv_ioreq_ring_ring_doorbell(port);
+  }
+
+  return 0;
+}
+
+// Send a message with its payload, waiting if the ring is full. The chunks of
+// a big payload are sent with the port locked, so that they are never
+// interleaved with other messages. Returns -1 if the consumer could not be
+// woken up.
+static inline int gv_ioreq_ring_send(gv_ioreq_ring_port_t *port, gv_ioreq_desc_t *desc, void *payload, uint64_t payload_size)
+{
+  int err = 0;
+
+  pthread_mutex_lock(&port->lock);
+
+  uint64_t chunk_size = gv_ioreq_ring_chunk_size(payload_size);
+  err = gv_ioreq_ring_push(port, desc, payload, chunk_size);
+
+  gv_ioreq_desc_t data_desc;
+  memset(&data_desc, 0, sizeof(data_desc));
+  data_desc.type = GV_IOREQ_DESC_TYPE_DATA;
+
+  for (uint64_t offset = chunk_size; !err && offset < payload_size; offset += chunk_size)
+  {
+    chunk_size = gv_ioreq_ring_chunk_size(payload_size - offset);
+    data_desc.size = chunk_size;
+    err = gv_ioreq_ring_push(port, &data_desc, (uint8_t *)payload + offset, chunk_size);
+  }
+
+  pthread_mutex_unlock(&port->lock);
+
+  return err;
+}
+
+// Get the next message without waiting, or NULL if the ring is empty.
+// The payload follows the descriptor. The message must be released once it has
+// been handled.
+static inline gv_ioreq_desc_t *gv_ioreq_ring_get(gv_ioreq_ring_port_t *port)
+{
+  gv_ioreq_ring_t *ring = port->ring;
+  uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+
+  while (tail != ring->head.load(std::memory_order_acquire))
+  {
+    uint64_t pos = tail % GV_IOREQ_RING_SIZE;
+    uint64_t to_end = GV_IOREQ_RING_SIZE - pos;
+    gv_ioreq_desc_t *desc = (gv_ioreq_desc_t *)&ring->data[pos];
+
+    if (to_end < sizeof(gv_ioreq_desc_t) || desc->type == GV_IOREQ_DESC_TYPE_PAD)
+    {
+      tail += to_end;
+      gv_ioreq_ring_set_tail(ring, tail);
+      continue;
+    }
+
+    return desc;
+  }
+
+  return NULL;
+}
+
+// Get the next message, waiting for it if the ring is empty. Returns NULL on error
+// or if the producer is gone.
+static inline gv_ioreq_desc_t *gv_ioreq_ring_wait(gv_ioreq_ring_port_t *port)
+{
+  gv_ioreq_ring_t *ring = port->ring;
+
+  while (1)
+  {
+    for (int i = 0; i < GV_IOREQ_RING_SPIN; i++)
+    {
+      gv_ioreq_desc_t *desc = gv_ioreq_ring_get(port);
+      if (desc) return desc;
+    }
+
+    ring->consumer_sleeping.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    gv_ioreq_desc_t *desc = gv_ioreq_ring_get(port);
+    if (desc || !gv_ioreq_ring_peer_alive(port))
+    {
+      ring->consumer_sleeping.store(0, std::memory_order_relaxed);
+      return desc;
+    }
+
+    struct pollfd fd = { port->doorbell, POLLIN, 0 };
+    int ready = poll(&fd, 1, GV_IOREQ_RING_TIMEOUT_MS);
+
+    uint64_t value;
+    bool failed = (ready == -1 && errno != EINTR) ||
+      (ready == 1 && read(port->doorbell, &value, sizeof(value)) != sizeof(value));
+
+    ring->consumer_sleeping.store(0, std::memory_order_relaxed);
+
+    if (failed) return NULL;
+  }
+}
+
+// Release the message returned by gv_ioreq_ring_get or gv_ioreq_ring_wait,
+// with the size of the payload chunk following its descriptor.
+static inline void gv_ioreq_ring_release(gv_ioreq_ring_port_t *port, uint64_t payload_size)
+{
+  gv_ioreq_ring_t *ring = port->ring;
+  uint64_t msg_size = sizeof(gv_ioreq_desc_t) + gv_ioreq_ring_payload_size(payload_size);
+  gv_ioreq_ring_set_tail(ring, ring->tail.load(std::memory_order_relaxed) + msg_size);
+}
+
+// Copy the payload of the message returned by gv_ioreq_ring_get or
+// gv_ioreq_ring_wait to data, which can be NULL if the payload is not needed,
+// waiting for the next chunks if it was split, and release the message.
+// The descriptor must not be used anymore after this call.
+// Returns -1 if the next chunks could not be received.
+static inline int gv_ioreq_ring_recv_payload(gv_ioreq_ring_port_t *port, gv_ioreq_desc_t *desc, void *data, uint64_t payload_size)
+{
+  uint64_t chunk_size = gv_ioreq_ring_chunk_size(payload_size);
+  if (data && chunk_size)
+  {
+    memcpy(data, (void *)(desc + 1), chunk_size);
+  }
+  gv_ioreq_ring_release(port, chunk_size);
+
+  for (uint64_t offset = chunk_size; offset < payload_size; offset += chunk_size)
+  {
+    desc = gv_ioreq_ring_wait(port);
+    if (desc == NULL || desc->type != GV_IOREQ_DESC_TYPE_DATA) return -1;
+
+    chunk_size = desc->size;
+    if (chunk_size == 0 || chunk_size > payload_size - offset) return -1;
+    if (data)
+    {
+      memcpy((uint8_t *)data + offset, (void *)(desc + 1), chunk_size);
+    }
+    gv_ioreq_ring_release(port, chunk_size);
+  }
+
+  return 0;
+}
+
+#endif
@@ -21,6 +21,7 @@
 
 #include "vp/launcher.h"
 #include "vp/launcher_internal.hpp"
+#include "vp/launcher_ring.hpp"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -44,13 +45,13 @@ typedef struct {
 } gv_launcher_t;
 
 typedef struct {
-  int rcv_pipe[2];
-  int snd_pipe[2];
+  gv_ioreq_ring_port_t snd_port;  // Ring 0, from the launcher to the platform
+  gv_ioreq_ring_port_t rcv_port;  // Ring 1, from the platform to the launcher
   pthread_t thread;
   gv_launcher_t *gv;
-  FILE *snd_file;
   gv_ioreq_request_t callback;
   void *context;
+  int error;                      // Set when the platform could not be notified of a message
 } gv_ioreq_binding_t;
 
 static pid_t child_id = -1;
@@ -133,52 +134,83 @@ static void ioreq_response(void *context, gv_ioreq_t *req)
   gv_ioreq_desc_t *desc = (gv_ioreq_desc_t *)context;
   gv_ioreq_binding_t *binding = (gv_ioreq_binding_t *)desc->binding;
   desc->type = GV_IOREQ_DESC_TYPE_RESPONSE;
+  desc->user_req = *req;
   desc->latency = req->latency;
   desc->timestamp += req->latency;
-  if (fwrite((void *)desc, sizeof(*desc), 1, binding->snd_file) != 1) return;
-  if (!desc->is_write && fwrite(desc->data, desc->size, 1, binding->snd_file) != 1) return;
-  fflush(binding->snd_file);
+  // The response is in the ring even if the platform could not be woken up,
+  // the binding is then marked as failed so that the next requests report it
+  if (gv_ioreq_ring_send(&binding->snd_port, desc, desc->data, desc->is_write ? 0 : desc->size))
+  {
+    fprintf(stderr, "Failed to send IO response to the platform (addr: 0x%lx, size: 0x%lx)\n", desc->addr, desc->size);
+    binding->error = 1;
+  }
   free(desc->data);
   free((void *)desc);
 }
 
-static void *ioreq_routine(void *arg)
+// Handle the messages from the platform until it is gone or an error occurs
+static void ioreq_receive(gv_ioreq_binding_t *binding)
 {
-  gv_ioreq_binding_t *binding = (gv_ioreq_binding_t *)arg;
+  while(1) {
+    gv_ioreq_desc_t *desc = gv_ioreq_ring_wait(&binding->rcv_port);
+    if (desc == NULL) return;
+
+    // Handle all the messages available before waiting again
+    do {
+      if (desc->type == GV_IOREQ_DESC_TYPE_RESPONSE)
+      {
+        // Fabric side sent us a response fro a host->fabric request
+        gv_ioreq_desc_t req = *desc;
+        if (gv_ioreq_ring_recv_payload(&binding->rcv_port, desc, req.is_write ? NULL : req.data, req.is_write ? 0 : req.size))
+        {
+          return;
+        }
+
+        if (req.response_cb != NULL) {
+          req.response_cb(req.response_context, &req.user_req);
+        }
+      }
+      else
+      {
+        // The request is handled asynchronously, copy it out of the ring
+        gv_ioreq_desc_t *req = (gv_ioreq_desc_t *)malloc(sizeof(gv_ioreq_desc_t));
+        if (req == NULL) return;
+        *req = *desc;
+
+        req->data = malloc(req->size);
+        if (req->data == NULL) return;
+
+        if (gv_ioreq_ring_recv_payload(&binding->rcv_port, desc, req->is_write ? req->data : NULL, req->is_write ? req->size : 0))
+        {
+          return;
+        }
+
+        gv_ioreq_binding_t *binding = (gv_ioreq_binding_t *)req->binding;
+        if (binding->callback != NULL) {
+          binding->callback(binding->context, (void *)req->data, (void *)req->addr, req->size, req->is_write,
+            ioreq_response, (void *)req);
+        }
+      }
 
-  FILE *f = fdopen(binding->rcv_pipe[0], "r");
-  if (f == NULL) return NULL;
+      desc = gv_ioreq_ring_get(&binding->rcv_port);
+    } while (desc);
+  }
+}
 
-  gv_ioreq_desc_t *req = NULL;
+static void *ioreq_routine(void *arg)
+{
+  gv_ioreq_binding_t *binding = (gv_ioreq_binding_t *)arg;
 
-  while(1) {
-    if (req == NULL) req = (gv_ioreq_desc_t *)malloc(sizeof(gv_ioreq_desc_t));
-    if (req == NULL) return NULL;
+  ioreq_receive(binding);
 
-    if (fread((void *)req, sizeof(*req), 1, f) != 1) return NULL;
+  // The platform may be waiting for a response or for room in the rings, tell it
+  // that nothing will be received or sent anymore, and report it to the next
+  // requests
+  binding->error = 1;
+  gv_ioreq_ring_close(&binding->rcv_port);
+  gv_ioreq_ring_close(&binding->snd_port);
 
-    if (req->type == GV_IOREQ_DESC_TYPE_RESPONSE)
-    {
-      // Fabric side sent us a response fro a host->fabric request
-      if (!req->is_write && fread(req->data, req->size, 1, f) != 1) return NULL;
-      if (req->response_cb != NULL) {
-        req->response_cb(req->response_context, &req->user_req);
-      }
-    }
-    else
-    {
-      req->data = malloc(req->size);
-      if (req->data == NULL) return NULL;
-
-      if (req->is_write && fread(req->data, req->size, 1, f) != 1) return NULL;
-      gv_ioreq_binding_t *binding = (gv_ioreq_binding_t *)req->binding;
-      if (binding->callback != NULL) {
-        binding->callback(binding->context, (void *)req->data, (void *)req->addr, req->size, req->is_write,
-          ioreq_response, (void *)req);
-        req = NULL;
-      }
-    }
-  }
+  return NULL;
 }
 
 
@@ -191,14 +223,32 @@ void *gv_ioreq_binding(void *handle, char *path, void *base, size_t size, gv_ior
 
   binding->callback = callback;
   binding->context = context;
+  binding->error = 0;
+
+  // The shared memory and the doorbells are inherited by the platform process
+  int shm_fd = gv_ioreq_ring_alloc();
+  if (shm_fd == -1) return NULL;
+
+  int snd_doorbell = eventfd(0, 0);
+  int rcv_doorbell = eventfd(0, 0);
+  if (snd_doorbell == -1 || rcv_doorbell == -1) return NULL;
 
-  if(pipe(binding->snd_pipe) == -1) return NULL;
-  if(pipe(binding->rcv_pipe) == -1) return NULL;
+  if (gv_ioreq_ring_open(&binding->snd_port, shm_fd, 0, snd_doorbell, true)) return NULL;
+  if (gv_ioreq_ring_open(&binding->rcv_port, shm_fd, 1, rcv_doorbell, false)) return NULL;
 
-  std::string str = "--config-opt=**/" + std::string(path) + "/rcv_fd=" + std::to_string(binding->snd_pipe[0]);
+  std::string str = "--config-opt=**/" + std::string(path) + "/shm_fd=" + std::to_string(shm_fd);
   add_option(gv, strdup((char *)str.c_str()));
 
-  str = "--config-opt=**/" + std::string(path) + "/snd_fd=" + std::to_string(binding->rcv_pipe[1]);
+  str = "--config-opt=**/" + std::string(path) + "/rcv_doorbell=" + std::to_string(snd_doorbell);
+  add_option(gv, strdup((char *)str.c_str()));
+
+  str = "--config-opt=**/" + std::string(path) + "/snd_doorbell=" + std::to_string(rcv_doorbell);
+  add_option(gv, strdup((char *)str.c_str()));
+
+  str = "--config-opt=**/" + std::string(path) + "/rcv_fd=-1";
+  add_option(gv, strdup((char *)str.c_str()));
+
+  str = "--config-opt=**/" + std::string(path) + "/snd_fd=-1";
   add_option(gv, strdup((char *)str.c_str()));
 
   str = "--config-opt=**/" + std::string(path) + "/external_binding/base=" + std::to_string((int64_t)base);
@@ -211,8 +261,6 @@ void *gv_ioreq_binding(void *handle, char *path, void *base, size_t size, gv_ior
   add_option(gv, strdup((char *)str.c_str()));
 
   binding->gv = (gv_launcher_t *)handle;
-  binding->snd_file = fdopen(binding->snd_pipe[1], "w");
-  if (binding->snd_file == NULL) return NULL;
 
   pthread_create(&binding->thread, NULL, ioreq_routine, (void *)binding);
   
@@ -223,14 +271,18 @@ int gv_ioreq(void *_binding, int64_t timestamp, void *data, void *addr, size_t s
 {
   gv_ioreq_binding_t *binding = (gv_ioreq_binding_t *)_binding;
 
+  if (binding->error) return -1;
+
   gv_ioreq_desc_t desc = { .type=GV_IOREQ_DESC_TYPE_REQUEST, .addr=(uint64_t)addr, .size=(uint64_t)size, .is_write=(int64_t)is_write, .timestamp=timestamp,
     .response_cb=callback, .response_context=context
   };
   desc.data = data;
-  if (fwrite((void *)&desc, sizeof(desc), 1, binding->snd_file) != 1) return -1;
-  if (is_write && fwrite(data, size, 1, binding->snd_file) != 1) return -1;
 
-  fflush(binding->snd_file);
+  if (gv_ioreq_ring_send(&binding->snd_port, &desc, data, is_write ? size : 0))
+  {
+    binding->error = 1;
+    return -1;
+  }
 
   return 0;
 }
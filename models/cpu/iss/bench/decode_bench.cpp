@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures the decoder throughput over all the instructions of an ISA.
+ *
+ * The decoder trees generated with the ISA are walked to build, for each
+ * active instruction, the bits fixed by the path leading to it. Several
+ * opcodes are then derived from each instruction by filling the other bits
+ * at random, and only the ones actually decoded as this instruction are kept.
+ *
+ * Each opcode is decoded once per pass, with an empty store of decoded
+ * opcodes, so that every decode goes through the decoder tree, like after a
+ * cache flush or when a large binary is executed for the first time. The
+ * same opcodes are then decoded again from the store.
+ *
+ * With --no-tables, the dispatch tables generated with the ISA are removed
+ * before decoding, so that the decoder scans the groups linearly.
+ */
+
+#include "sa_iss.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+typedef struct
+{
+  iss_decoder_item_t *item;
+  iss_opcode_t value;       // Value of the bits fixed by the decoder tree
+  iss_opcode_t mask;        // Bits fixed by the decoder tree
+} decode_bench_insn_t;
+
+static inline int64_t get_time_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "Usage: %s [--isa ISA] [--variants N] [--passes N] [--no-tables]\n", name);
+  exit(1);
+}
+
+static void get_insns(iss_t *iss, iss_decoder_item_t *item, iss_opcode_t value, iss_opcode_t mask, std::vector<decode_bench_insn_t> &insns)
+{
+  if (item->is_insn)
+  {
+    if (iss->cpu.active_insns[item->u.insn.id])
+      insns.push_back({ item, value, mask });
+    return;
+  }
+
+  iss_opcode_t group_mask = ((1ULL << item->u.group.width) - 1) << item->u.group.bit;
+
+  for (int i=0; i<item->u.group.nb_groups; i++)
+  {
+    iss_decoder_item_t *group_item = item->u.group.groups[i];
+    iss_opcode_t group_opcode = group_item->opcode;
+
+    if (group_item->opcode_others)
+    {
+      // Take the first value of the field which does not select another
+      // sub-item
+      for (group_opcode=0; group_opcode < (1ULL << item->u.group.width); group_opcode++)
+      {
+        bool found = false;
+        for (int j=0; j<item->u.group.nb_groups; j++)
+        {
+          iss_decoder_item_t *other = item->u.group.groups[j];
+          if (!other->opcode_others && other->opcode == group_opcode)
+            found = true;
+        }
+        if (!found)
+          break;
+      }
+
+      if (group_opcode == (1ULL << item->u.group.width))
+        continue;
+    }
+
+    get_insns(iss, group_item, value | (group_opcode << item->u.group.bit), mask | group_mask, insns);
+  }
+}
+
+// Removes the dispatch tables of the groups, so that their sub-items are scanned
+static void remove_tables(iss_decoder_item_t *item)
+{
+  if (item->is_insn)
+    return;
+
+  item->u.group.table = NULL;
+
+  for (int i=0; i<item->u.group.nb_groups; i++)
+  {
+    remove_tables(item->u.group.groups[i]);
+  }
+}
+
+// Empties the store so that the next decodes go through the decoder tree again
+static void reset_store(iss_t *iss)
+{
+  iss_decoded_opcode_store_t *store = iss->cpu.decoded_opcodes;
+  for (int i=0; i<store->nb_entries; i++)
+  {
+    free(store->entries[i]);
+    store->entries[i] = NULL;
+  }
+  store->nb_used = 0;
+}
+
+static int64_t decode_all(iss_t *iss, iss_insn_t *insn, std::vector<iss_opcode_t> &opcodes)
+{
+  int64_t start = get_time_ns();
+  for (iss_opcode_t opcode: opcodes)
+  {
+    insn->cold->opcode = opcode;
+    iss_decode_pc_noexec(iss, insn);
+  }
+  return get_time_ns() - start;
+}
+
+int main(int argc, char *argv[])
+{
+  std::string isa = "rv32imcXpulpv2";
+  int nb_variants = 16;
+  int nb_passes = 20;
+  bool use_tables = true;
+
+  for (int i=1; i<argc; i++)
+  {
+    std::string opt = argv[i];
+    if (opt == "--no-tables")
+    {
+      use_tables = false;
+      continue;
+    }
+
+    if (i + 1 >= argc)
+      usage(argv[0]);
+
+    i++;
+    if (opt == "--isa")
+      isa = argv[i];
+    else if (opt == "--variants")
+      nb_variants = atoi(argv[i]);
+    else if (opt == "--passes")
+      nb_passes = atoi(argv[i]);
+    else
+      usage(argv[0]);
+  }
+
+  if (nb_variants <= 0 || nb_passes <= 0)
+    usage(argv[0]);
+
+  iss_t *iss = new iss_t;
+  iss->fast_mode = 0;
+  iss->hit_exit = 0;
+  iss->exit_status = 0;
+  iss->mem_size = 0x10000;
+  iss->mem_array = (unsigned char *)calloc(1, iss->mem_size);
+  iss->cpu.config.isa = strdup(isa.c_str());
+  iss->cpu.config.shared_decode = false;
+
+  if (iss_open(iss))
+    return 1;
+
+  iss_start(iss);
+
+  std::vector<decode_bench_insn_t> insns;
+  for (int i=0; i<__iss_isa_set.nb_isa; i++)
+  {
+    get_insns(iss, __iss_isa_set.isa_set[i].tree, 0, 0, insns);
+  }
+
+  iss_insn_t *insn = insn_cache_get(iss, 0);
+  std::vector<iss_opcode_t> opcodes;
+  std::unordered_set<iss_opcode_t> opcodes_set;
+  std::unordered_set<iss_decoder_item_t *> decoded_items;
+  uint32_t seed = 1;
+
+  for (decode_bench_insn_t &desc: insns)
+  {
+    iss_opcode_t size_mask = desc.item->u.insn.size == 2 ? 0xffff : 0xffffffff;
+
+    for (int i=0; i<nb_variants; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      iss_opcode_t opcode = (desc.value | (((iss_opcode_t)seed ^ (seed >> 16)) & ~desc.mask)) & size_mask;
+
+      // An instruction may be shadowed by another one matching first, the
+      // opcode is then not counted for this instruction
+      insn->cold->decoder_item = NULL;
+      insn->cold->opcode = opcode;
+      iss_decode_pc_noexec(iss, insn);
+      if (insn->cold->decoder_item != desc.item || !opcodes_set.insert(opcode).second)
+        continue;
+
+      opcodes.push_back(opcode);
+      decoded_items.insert(desc.item);
+    }
+  }
+
+  printf("%s: %ld instructions, %ld decoded, %ld opcodes\n", isa.c_str(), insns.size(),
+    decoded_items.size(), opcodes.size());
+
+  if (!use_tables)
+  {
+    for (int i=0; i<__iss_isa_set.nb_isa; i++)
+    {
+      remove_tables(__iss_isa_set.isa_set[i].tree);
+    }
+  }
+
+  int64_t cold_time = 0;
+  int64_t warm_time = 0;
+  for (int i=0; i<nb_passes; i++)
+  {
+    reset_store(iss);
+    cold_time += decode_all(iss, insn, opcodes);
+    warm_time += decode_all(iss, insn, opcodes);
+  }
+
+  int64_t nb_decodes = (int64_t)opcodes.size() * nb_passes;
+  printf("decoder tree  %8.2f Mdecodes/s (%s)\n", nb_decodes / (cold_time / 1e3),
+    use_tables ? "dispatch tables" : "linear scan");
+  printf("opcode store  %8.2f Mdecodes/s\n", nb_decodes / (warm_time / 1e3));
+
+  return 0;
+}
@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures the MIPS of the ISS fast loop, together with the host cache misses
+ * it causes, on a program made of the same kinds of kernels as CoreMark:
+ * a linked list walk, a matrix multiplication, a state machine scanning a
+ * string and a CRC.
+ *
+ * The program is assembled by the benchmark itself, so that it does not need
+ * any RISC-V toolchain, and its checksum is reported so that runs of
+ * different ISS versions can be checked against each other.
+ * The host cache misses are read from the kernel performance counters, they
+ * are reported as not available when the kernel does not give access to them.
+ */
+
+#include "sa_iss.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#define EXEC_BENCH_CODE   0x1000
+#define EXEC_BENCH_LIST   0x10000
+#define EXEC_BENCH_MAT_A  0x20000
+#define EXEC_BENCH_MAT_B  0x21000
+#define EXEC_BENCH_MAT_C  0x22000
+#define EXEC_BENCH_STRING 0x30000
+
+#define EXEC_BENCH_LIST_SIZE   256
+#define EXEC_BENCH_MAT_SIZE    16
+#define EXEC_BENCH_STRING_SIZE 256
+
+enum {
+  ZERO=0, RA=1, SP=2, T0=5, T1=6, T2=7, S0=8, S1=9, A0=10, A7=17, S2=18, S3=19, S4=20, S5=21,
+  S6=22, S7=23, S8=24, S9=25, S10=26, S11=27, T3=28, T4=29, T5=30, T6=31
+};
+
+// Minimal RV32IM assembler, with labels resolved at the end
+class exec_bench_asm
+{
+public:
+  void r(int funct7, int rs2, int rs1, int funct3, int rd, int opcode)
+  {
+    code.push_back((funct7 << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode);
+  }
+
+  void i(int imm, int rs1, int funct3, int rd, int opcode)
+  {
+    code.push_back(((imm & 0xfff) << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode);
+  }
+
+  void add(int rd, int rs1, int rs2)  { r(0x00, rs2, rs1, 0, rd, 0x33); }
+  void mul(int rd, int rs1, int rs2)  { r(0x01, rs2, rs1, 0, rd, 0x33); }
+  void xor_(int rd, int rs1, int rs2) { r(0x00, rs2, rs1, 4, rd, 0x33); }
+  void addi(int rd, int rs1, int imm) { i(imm, rs1, 0, rd, 0x13); }
+  void andi(int rd, int rs1, int imm) { i(imm, rs1, 7, rd, 0x13); }
+  void slli(int rd, int rs1, int sh)  { i(sh, rs1, 1, rd, 0x13); }
+  void srli(int rd, int rs1, int sh)  { i(sh, rs1, 5, rd, 0x13); }
+  void lw(int rd, int rs1, int imm)   { i(imm, rs1, 2, rd, 0x03); }
+  void lbu(int rd, int rs1, int imm)  { i(imm, rs1, 4, rd, 0x03); }
+  void ecall()                        { code.push_back(0x00000073); }
+
+  void sw(int rs2, int rs1, int imm)
+  {
+    code.push_back((((imm >> 5) & 0x7f) << 25) | (rs2 << 20) | (rs1 << 15) | (2 << 12) | ((imm & 0x1f) << 7) | 0x23);
+  }
+
+  void li(int rd, int32_t imm)
+  {
+    if (imm >= -2048 && imm < 2048)
+    {
+      addi(rd, ZERO, imm);
+    }
+    else
+    {
+      code.push_back(((imm + 0x800) & 0xfffff000) | (rd << 7) | 0x37);
+      addi(rd, rd, imm & 0xfff);
+    }
+  }
+
+  void beq(int rs1, int rs2, std::string label)  { branch(0, rs1, rs2, label); }
+  void bne(int rs1, int rs2, std::string label)  { branch(1, rs1, rs2, label); }
+  void blt(int rs1, int rs2, std::string label)  { branch(4, rs1, rs2, label); }
+  void j(std::string label)                      { branch(-1, 0, 0, label); }
+
+  void label(std::string name) { labels[name] = code.size(); }
+
+  std::vector<uint32_t> &assemble()
+  {
+    for (auto &fixup: fixups)
+    {
+      int offset = (labels.at(fixup.second) - fixup.first) * 4;
+      uint32_t &insn = code[fixup.first];
+      if ((insn & 0x7f) == 0x6f)
+      {
+        insn |= (((offset >> 20) & 1) << 31) | (((offset >> 1) & 0x3ff) << 21) | (((offset >> 11) & 1) << 20) |
+          (((offset >> 12) & 0xff) << 12);
+      }
+      else
+      {
+        insn |= (((offset >> 12) & 1) << 31) | (((offset >> 5) & 0x3f) << 25) | (((offset >> 1) & 0xf) << 8) |
+          (((offset >> 11) & 1) << 7);
+      }
+    }
+    return code;
+  }
+
+private:
+  void branch(int funct3, int rs1, int rs2, std::string label)
+  {
+    fixups.push_back({ code.size(), label });
+    if (funct3 == -1)
+      code.push_back(0x6f);
+    else
+      code.push_back((rs2 << 20) | (rs1 << 15) | (funct3 << 12) | 0x63);
+  }
+
+  std::vector<uint32_t> code;
+  std::map<std::string, int> labels;
+  std::vector<std::pair<int, std::string>> fixups;
+};
+
+static void gen_program(exec_bench_asm &a, int nb_iterations)
+{
+  a.li(S0, nb_iterations);
+  a.li(S11, 0);
+  a.li(S7, EXEC_BENCH_MAT_A);
+  a.li(S8, EXEC_BENCH_MAT_B);
+  a.li(S9, EXEC_BENCH_MAT_C);
+  a.li(S10, EXEC_BENCH_MAT_SIZE);
+
+  a.label("outer");
+
+  // Linked list walk
+  a.li(T0, EXEC_BENCH_LIST);
+  a.label("list");
+  a.lw(T1, T0, 4);
+  a.add(S11, S11, T1);
+  a.xor_(S11, S11, T0);
+  a.lw(T0, T0, 0);
+  a.bne(T0, ZERO, "list");
+
+  // Matrix multiplication
+  a.li(S1, 0);
+  a.label("mat_i");
+  a.li(S2, 0);
+  a.label("mat_j");
+  a.li(S3, 0);
+  a.li(T3, 0);
+  a.label("mat_k");
+  a.slli(T4, S1, 4);
+  a.add(T4, T4, S3);
+  a.slli(T4, T4, 2);
+  a.add(T5, T4, S7);
+  a.lw(T5, T5, 0);
+  a.slli(T4, S3, 4);
+  a.add(T4, T4, S2);
+  a.slli(T4, T4, 2);
+  a.add(T6, T4, S8);
+  a.lw(T6, T6, 0);
+  a.mul(T5, T5, T6);
+  a.add(T3, T3, T5);
+  a.addi(S3, S3, 1);
+  a.blt(S3, S10, "mat_k");
+  a.slli(T4, S1, 4);
+  a.add(T4, T4, S2);
+  a.slli(T4, T4, 2);
+  a.add(T4, T4, S9);
+  a.sw(T3, T4, 0);
+  a.add(S11, S11, T3);
+  a.addi(S2, S2, 1);
+  a.blt(S2, S10, "mat_j");
+  a.addi(S1, S1, 1);
+  a.blt(S1, S10, "mat_i");
+
+  // State machine counting numbers and identifiers
+  a.li(T0, EXEC_BENCH_STRING);
+  a.li(T1, EXEC_BENCH_STRING + EXEC_BENCH_STRING_SIZE);
+  a.li(S4, 0);
+  a.label("sm");
+  a.lbu(T2, T0, 0);
+  a.li(T3, '0');
+  a.blt(T2, T3, "sm_sep");
+  a.li(T3, '9' + 1);
+  a.blt(T2, T3, "sm_digit");
+  a.li(T3, 2);
+  a.beq(S4, T3, "sm_next");
+  a.li(S4, 2);
+  a.addi(S5, S5, 1);
+  a.j("sm_next");
+  a.label("sm_digit");
+  a.bne(S4, ZERO, "sm_next");
+  a.li(S4, 1);
+  a.addi(S6, S6, 1);
+  a.j("sm_next");
+  a.label("sm_sep");
+  a.li(S4, 0);
+  a.label("sm_next");
+  a.add(S11, S11, S4);
+  a.addi(T0, T0, 1);
+  a.bne(T0, T1, "sm");
+  a.add(S11, S11, S5);
+  a.add(S11, S11, S6);
+
+  // CRC of the checksum
+  a.li(T2, 16);
+  a.li(T4, 0xa001);
+  a.label("crc");
+  a.andi(T3, S11, 1);
+  a.srli(S11, S11, 1);
+  a.beq(T3, ZERO, "crc_next");
+  a.xor_(S11, S11, T4);
+  a.label("crc_next");
+  a.addi(T2, T2, -1);
+  a.bne(T2, ZERO, "crc");
+
+  a.addi(S0, S0, -1);
+  a.bne(S0, ZERO, "outer");
+
+  a.li(A0, 0);
+  a.li(A7, 93);
+  a.ecall();
+}
+
+static void gen_data(iss_t *iss)
+{
+  uint32_t seed = 1;
+
+  // The nodes are linked in a random order so that the walk jumps around,
+  // except the first one which is the head of the list
+  std::vector<int> order(EXEC_BENCH_LIST_SIZE);
+  for (int i=0; i<EXEC_BENCH_LIST_SIZE; i++)
+  {
+    order[i] = i;
+  }
+  for (int i=EXEC_BENCH_LIST_SIZE-1; i>1; i--)
+  {
+    seed = seed * 1103515245 + 12345;
+    std::swap(order[i], order[1 + (seed >> 8) % i]);
+  }
+  for (int i=0; i<EXEC_BENCH_LIST_SIZE; i++)
+  {
+    uint32_t node = EXEC_BENCH_LIST + order[i] * 8;
+    uint32_t next = i + 1 < EXEC_BENCH_LIST_SIZE ? EXEC_BENCH_LIST + order[i + 1] * 8 : 0;
+    storeWord(iss, node, next);
+    storeWord(iss, node + 4, i * 7);
+  }
+
+  for (int i=0; i<EXEC_BENCH_MAT_SIZE*EXEC_BENCH_MAT_SIZE; i++)
+  {
+    storeWord(iss, EXEC_BENCH_MAT_A + i * 4, i % 13 - 6);
+    storeWord(iss, EXEC_BENCH_MAT_B + i * 4, i % 7 + 1);
+  }
+
+  static const char chars[] = "0123456789abcdefxyz ,;";
+  for (int i=0; i<EXEC_BENCH_STRING_SIZE; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    storeByte(iss, EXEC_BENCH_STRING + i, chars[(seed >> 8) % (sizeof(chars) - 1)]);
+  }
+}
+
+static int open_counter(uint64_t cache)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void print_counter(const char *name, int fd, uint64_t nb_insns)
+{
+  uint64_t value;
+  if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value))
+  {
+    printf("%-12s n/a\n", name);
+  }
+  else
+  {
+    printf("%-12s %12lu (%.4f per instruction)\n", name, (unsigned long)value, (double)value / nb_insns);
+  }
+}
+
+static inline int64_t get_time_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "Usage: %s [--iterations N]\n", name);
+  exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+  int nb_iterations = 2000;
+
+  for (int i=1; i<argc; i++)
+  {
+    if (i + 1 >= argc)
+      usage(argv[0]);
+
+    std::string opt = argv[i++];
+    if (opt == "--iterations")
+      nb_iterations = atoi(argv[i]);
+    else
+      usage(argv[0]);
+  }
+
+  if (nb_iterations <= 0)
+    usage(argv[0]);
+
+  iss_t *iss = new iss_t;
+  iss->fast_mode = 0;
+  iss->hit_exit = 0;
+  iss->exit_status = 0;
+  iss->mem_size = 0x100000;
+  iss->mem_array = (unsigned char *)calloc(1, iss->mem_size);
+  iss->cpu.config.isa = strdup("rv32imcXpulpv2");
+  iss->cpu.config.shared_decode = false;
+
+  exec_bench_asm a;
+  gen_program(a, nb_iterations);
+  std::vector<uint32_t> &code = a.assemble();
+  for (size_t i=0; i<code.size(); i++)
+  {
+    storeWord(iss, EXEC_BENCH_CODE + i * 4, code[i]);
+  }
+  gen_data(iss);
+
+  if (iss_open(iss))
+    return 1;
+
+  iss_start(iss);
+  iss_pc_set(iss, EXEC_BENCH_CODE);
+  // Like in the standalone ISS, the entry instruction must be fetched first
+  prefetcher_fetch(iss, iss->cpu.current_insn);
+
+  int counters[] = {
+    open_counter(PERF_COUNT_HW_CACHE_L1D),
+    open_counter(PERF_COUNT_HW_CACHE_L1I),
+    open_counter(PERF_COUNT_HW_CACHE_LL)
+  };
+
+  for (int fd: counters)
+  {
+    if (fd >= 0)
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+
+  uint64_t nb_insns = 0;
+  int64_t start = get_time_ns();
+
+  // Same loop as the standalone ISS
+  do
+  {
+    iss->fast_mode = iss_exec_switch_to_fast(iss);
+
+    if (iss->fast_mode)
+    {
+      do
+      {
+        iss_exec_step(iss);
+        nb_insns++;
+      } while(iss->fast_mode);
+    }
+    else
+    {
+      iss_exec_step_check_all(iss);
+      nb_insns++;
+    }
+  } while (iss->hit_exit == 0);
+
+  int64_t duration = get_time_ns() - start;
+
+  for (int fd: counters)
+  {
+    if (fd >= 0)
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+  }
+
+  printf("Executed %lu instructions in %.3f s (%.2f MIPS), checksum 0x%x\n", (unsigned long)nb_insns,
+    duration / 1e9, nb_insns / (duration / 1e3), (unsigned int)iss_get_reg(iss, S11));
+  print_counter("L1D misses", counters[0], nb_insns);
+  print_counter("L1I misses", counters[1], nb_insns);
+  print_counter("LLC misses", counters[2], nb_insns);
+
+  return iss->exit_status;
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures the instruction cache lookups on a large code footprint, like a
+ * binary executed in place from a flash of several MB.
+ *
+ * All the blocks of the footprint are first looked up once, like when the
+ * binary is executed for the first time. The number of hash table entries
+ * checked to find each block is then reported, together with the length of
+ * the chains which the previous table, made of 4096 lists indexed by the low
+ * bits of the block address, would have walked for the same blocks.
+ * Finally, the lookup throughput is measured on branch targets drawn
+ * at random in the whole footprint, which defeats the memo of the last
+ * blocks, and in a small set of blocks, like a loop calling a few functions.
+ */
+
+#include "sa_iss.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#define INSN_CACHE_BENCH_OLD_NB_BLOCKS 4096
+
+static inline int64_t get_time_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "Usage: %s [--footprint MB] [--base ADDR] [--lookups N] [--hot-blocks N]\n", name);
+  exit(1);
+}
+
+// Number of hash table entries checked to find the block of this address
+static int insn_cache_probes(iss_t *iss, iss_addr_t pc)
+{
+  iss_addr_t pc_base = pc & ~((1 << (ISS_INSN_BLOCK_SIZE_LOG2 + ISS_INSN_PC_BITS)) - 1);
+  iss_insn_cache_t *cache = &iss->cpu.insn_cache;
+  unsigned int index = insn_cache_hash(cache, pc_base);
+  iss_insn_block_t *block;
+  int nb_probes = 1;
+
+  while ((block = cache->blocks[index]) != NULL && block->pc != pc_base)
+  {
+    index = (index + 1) & (cache->nb_blocks - 1);
+    nb_probes++;
+  }
+
+  return nb_probes;
+}
+
+static void lookups(iss_t *iss, const char *name, iss_addr_t base, iss_addr_t size, int64_t nb_lookups)
+{
+  uint32_t seed = 1;
+  iss_addr_t sum = 0;
+
+  int64_t start = get_time_ns();
+  for (int64_t i=0; i<nb_lookups; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    iss_addr_t pc = base + (((uint64_t)seed * size >> 32) & ~(iss_addr_t)3);
+    sum += insn_cache_get(iss, pc)->addr;
+  }
+  int64_t duration = get_time_ns() - start;
+
+  // The sum is only there so that the lookups are not optimized away
+  printf("%-16s %8.2f Mlookups/s (checksum 0x%lx)\n", name, nb_lookups / (duration / 1e3), (unsigned long)sum);
+}
+
+int main(int argc, char *argv[])
+{
+  iss_addr_t base = 0x20000000;
+  int footprint_mb = 4;
+  int64_t nb_lookups = 20000000;
+  int nb_hot_blocks = 6;
+
+  for (int i=1; i<argc; i++)
+  {
+    if (i + 1 >= argc)
+      usage(argv[0]);
+
+    std::string opt = argv[i++];
+    if (opt == "--footprint")
+      footprint_mb = atoi(argv[i]);
+    else if (opt == "--base")
+      base = strtoul(argv[i], NULL, 0);
+    else if (opt == "--lookups")
+      nb_lookups = atoll(argv[i]);
+    else if (opt == "--hot-blocks")
+      nb_hot_blocks = atoi(argv[i]);
+    else
+      usage(argv[0]);
+  }
+
+  if (footprint_mb <= 0 || nb_lookups <= 0 || nb_hot_blocks <= 0)
+    usage(argv[0]);
+
+  iss_t *iss = new iss_t;
+  iss->fast_mode = 0;
+  iss->hit_exit = 0;
+  iss->exit_status = 0;
+  iss->mem_size = 0x10000;
+  iss->mem_array = (unsigned char *)calloc(1, iss->mem_size);
+  iss->cpu.config.isa = strdup("rv32imcXpulpv2");
+  iss->cpu.config.shared_decode = false;
+
+  if (iss_open(iss))
+    return 1;
+
+  iss_start(iss);
+
+  iss_addr_t block_size = 1 << (ISS_INSN_BLOCK_SIZE_LOG2 + ISS_INSN_PC_BITS);
+  iss_addr_t size = (iss_addr_t)footprint_mb << 20;
+  int nb_blocks = size / block_size;
+
+  for (iss_addr_t pc=base; pc<base + size; pc+=block_size)
+  {
+    insn_cache_get(iss, pc);
+  }
+
+  int64_t total_probes = 0;
+  int max_probes = 0;
+  std::vector<int> old_chains(INSN_CACHE_BENCH_OLD_NB_BLOCKS);
+
+  for (iss_addr_t pc=base; pc<base + size; pc+=block_size)
+  {
+    int nb_probes = insn_cache_probes(iss, pc);
+    total_probes += nb_probes;
+    if (nb_probes > max_probes)
+      max_probes = nb_probes;
+
+    old_chains[pc & (INSN_CACHE_BENCH_OLD_NB_BLOCKS - 1)]++;
+  }
+
+  // With lists, finding the n-th block of a list walks n blocks
+  int64_t old_total = 0;
+  int old_max = 0;
+  for (int len: old_chains)
+  {
+    old_total += (int64_t)len * (len + 1) / 2;
+    if (len > old_max)
+      old_max = len;
+  }
+
+  printf("%d MB footprint, %d blocks of %d bytes, %d table entries\n", footprint_mb, nb_blocks,
+    (int)block_size, iss->cpu.insn_cache.nb_blocks);
+  printf("open addressing  %6.2f probes on average, %6d at most\n", (double)total_probes / nb_blocks, max_probes);
+  printf("previous lists   %6.2f blocks on average, %6d at most\n", (double)old_total / nb_blocks, old_max);
+
+  lookups(iss, "random targets", base, size, nb_lookups);
+  lookups(iss, "hot blocks", base, (iss_addr_t)nb_hot_blocks * block_size, nb_lookups);
+
+  return 0;
+}
@@ -26,4 +26,12 @@ int insn_cache_init(iss_t *iss);
 void iss_cache_flush(iss_t *iss);
 iss_insn_t *insn_cache_get(iss_t *iss, iss_addr_t pc);
 
+// Index of the hash table entry where the lookup of the block starting at
+// this address begins
+static inline unsigned int insn_cache_hash(iss_insn_cache_t *cache, iss_addr_t pc_base)
+{
+  uint64_t block_id = (uint64_t)pc_base >> (ISS_INSN_BLOCK_SIZE_LOG2 + ISS_INSN_PC_BITS);
+  return (unsigned int)((block_id * 0x9E3779B97F4A7C15ULL) >> 32) & (cache->nb_blocks - 1);
+}
+
 #endif
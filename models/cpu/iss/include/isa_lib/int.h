@@ -1364,6 +1364,11 @@ static inline unsigned int lib_VEC_PACK_SC_HL_16(iss_cpu_state_t *s, unsigned in
 #include <stdint.h>
 #include <math.h>
 #include <fenv.h>
+#include <string.h>
+#include <mutex>
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
 #pragma STDC FENV_ACCESS ON
 
 #define FF_INIT_1(a, e, m) \
@@ -1593,7 +1598,320 @@ static inline void restoreFFRoundingMode(unsigned int mode)
   fesetround(mode);
 }
 
+// Fast path using the host FPU for IEEE binary32 and binary16 operations in
+// round-to-nearest-even mode, which is the host mode.
+// The host result is only kept when it is a normal number or zero, and no
+// other exception than inexact was raised, since it is then identical to the
+// flexfloat one, including the flags. Otherwise the operation is emulated
+// again with flexfloat.
+// Binary16 operations are done on binary32 values, for which rounding twice
+// is innocuous for add, sub, mul, div and sqrt. The conversions use the F16C
+// instructions when the ISS is built with ISS_HOST_F16C.
+
+static inline bool lib_ff_fast_is_rne(iss_cpu_state_t *s, unsigned int round)
+{
+  return round == 0 || (round == 7 && s->fcsr.frm == 0);
+}
+
+static inline float lib_ff_fast_f32(unsigned int bits)
+{
+  float result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+static inline bool lib_ff_fast_f16_valid(unsigned int bits)
+{
+  // Infinity and NaN operands are left to flexfloat
+  return ((bits >> 10) & 0x1f) != 0x1f;
+}
+
+static inline float lib_ff_fast_f16_to_f32(unsigned int bits)
+{
+#ifdef __F16C__
+  return _cvtsh_ss(bits & 0xffff);
+#else
+  unsigned int exp = (bits >> 10) & 0x1f;
+  unsigned int frac = bits & 0x3ff;
+  float result;
+
+  if (exp == 0)
+  {
+    result = (float)frac * (1.0f / (1 << 24));
+  }
+  else
+  {
+    result = lib_ff_fast_f32(((exp + 127 - 15) << 23) | (frac << 13));
+  }
+
+  return (bits & 0x8000) ? -result : result;
+#endif
+}
+
+// Convert the binary32 result to binary16, returns false if it is not a
+// normal binary16 number or zero
+static inline bool lib_ff_fast_f32_to_f16(float value, unsigned int *result, bool *inexact)
+{
+  unsigned int bits;
+
+  if (value == 0.0f)
+  {
+    memcpy(&bits, &value, sizeof(bits));
+    *result = bits >> 16;
+    *inexact = false;
+    return true;
+  }
+
+#ifdef __F16C__
+  bits = _cvtss_sh(value, _MM_FROUND_TO_NEAREST_INT);
+  *inexact = _cvtsh_ss(bits) != value;
+#else
+  unsigned int fbits;
+  memcpy(&fbits, &value, sizeof(fbits));
+  int exp = (int)((fbits >> 23) & 0xff) - 127 + 15;
+  if (exp <= 0 || exp >= 0x1f)
+  {
+    return false;
+  }
+  unsigned int rem = fbits & 0x1fff;
+  bits = ((fbits >> 16) & 0x8000) | (exp << 10) | ((fbits >> 13) & 0x3ff);
+  if (rem > 0x1000 || (rem == 0x1000 && (bits & 1)))
+  {
+    bits++;
+  }
+  *inexact = rem != 0;
+#endif
+
+  unsigned int hexp = (bits >> 10) & 0x1f;
+  if (hexp == 0 || hexp == 0x1f)
+  {
+    return false;
+  }
+
+  *result = bits;
+  return true;
+}
+
+// Check the result of a host binary32 operation executed after flags were
+// cleared, and convert it to the target format
+static inline bool lib_ff_fast_result(iss_cpu_state_t *s, float value, uint8_t m, unsigned int *result)
+{
+  int ex = fetestexcept(FE_ALL_EXCEPT);
+  bool inexact = (ex & FE_INEXACT) != 0;
+
+  if ((ex & (FE_INVALID | FE_DIVBYZERO | FE_OVERFLOW | FE_UNDERFLOW)) || !(isnormal(value) || value == 0.0f))
+  {
+    return false;
+  }
+
+  if (m == 23)
+  {
+    memcpy(result, &value, sizeof(*result));
+  }
+  else
+  {
+    bool round_inexact;
+    if (!lib_ff_fast_f32_to_f16(value, result, &round_inexact))
+    {
+      return false;
+    }
+    inexact |= round_inexact;
+    // Negative values are sign-extended like flexfloat does
+    if (*result & 0x8000)
+    {
+      *result |= 0xffff0000;
+    }
+  }
+
+  if (inexact)
+  {
+    set_fflags(s, 1);
+  }
+
+  return true;
+}
+
+// Operands are read through volatile variables so that the host operation is
+// not moved before the flags are cleared, which must be done with
+// LIB_FF_FAST_START once all operands are declared
+#define LIB_FF_FAST_OPERAND(name, a, m) \
+  volatile float name; \
+  if (m == 23) { \
+    name = lib_ff_fast_f32(a); \
+  } else { \
+    if (!lib_ff_fast_f16_valid(a)) \
+      return false; \
+    name = lib_ff_fast_f16_to_f32(a); \
+  }
+
+#define LIB_FF_FAST_START() \
+  feclearexcept(FE_ALL_EXCEPT);
+
+#define LIB_FF_FAST_BINARY(name, oper) \
+static inline bool lib_ff_fast_##name(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t m, unsigned int *result) \
+{ \
+  LIB_FF_FAST_OPERAND(fa, a, m) \
+  LIB_FF_FAST_OPERAND(fb, b, m) \
+  LIB_FF_FAST_START() \
+  volatile float res = fa oper fb; \
+  return lib_ff_fast_result(s, res, m, result); \
+}
+
+LIB_FF_FAST_BINARY(add, +)
+LIB_FF_FAST_BINARY(sub, -)
+LIB_FF_FAST_BINARY(mul, *)
+LIB_FF_FAST_BINARY(div, /)
+
+static inline bool lib_ff_fast_sqrt(iss_cpu_state_t *s, unsigned int a, uint8_t m, unsigned int *result)
+{
+  LIB_FF_FAST_OPERAND(fa, a, m)
+  LIB_FF_FAST_START()
+  volatile float res = sqrtf(fa);
+  return lib_ff_fast_result(s, res, m, result);
+}
+
+// Fused operations are only done on binary32, since rounding twice is not
+// innocuous for them
+static inline bool lib_ff_fast_fma(iss_cpu_state_t *s, unsigned int a, unsigned int b, unsigned int c, bool neg_mul, bool neg_add, unsigned int *result)
+{
+  LIB_FF_FAST_OPERAND(fa, a, 23)
+  LIB_FF_FAST_OPERAND(fb, b, 23)
+  LIB_FF_FAST_OPERAND(fc, c, 23)
+  LIB_FF_FAST_START()
+  float mul = neg_mul ? -fa : fa;
+  float add = neg_add ? -fc : fc;
+  volatile float res = fmaf(mul, fb, add);
+  return lib_ff_fast_result(s, res, 23, result);
+}
+
+static inline bool lib_ff_fast_enabled(iss_cpu_state_t *s, uint8_t e, uint8_t m, unsigned int round)
+{
+  return ((e == 8 && m == 23) || (e == 5 && m == 10)) && lib_ff_fast_is_rne(s, round);
+}
+
+static inline bool lib_ff_fast_fma_enabled(iss_cpu_state_t *s, uint8_t e, uint8_t m, unsigned int round)
+{
+  return e == 8 && m == 23 && lib_ff_fast_is_rne(s, round);
+}
+
+// Lookup tables for the 8-bit minifloat format (5-bit exponent, 2-bit
+// mantissa). Its operand space is small enough to compute with flexfloat, the
+// first time an operation is used with a rounding mode, its result and flags
+// for all operands, so that it is then executed with a single table access.
+// Tables are shared by all ISS instances, which may run on different threads,
+// so each one is built under a once flag.
+
+#define LIB_FF8_NB_ROUNDING_MODES 4
+
+typedef enum {
+  LIB_FF8_ADD,
+  LIB_FF8_SUB,
+  LIB_FF8_MUL,
+  LIB_FF8_DIV,
+  LIB_FF8_NB_BINARY_OPS
+} lib_ff8_binary_op_e;
+
+static inline bool lib_ff8_is_fp8(uint8_t e, uint8_t m)
+{
+  return e == 5 && m == 2;
+}
+
+// Returns the rounding mode to be used, or -1 if the tables can't be used
+static inline int lib_ff8_rounding_mode(iss_cpu_state_t *s, unsigned int round)
+{
+  if (round == 7) round = s->fcsr.frm;
+  return round < LIB_FF8_NB_ROUNDING_MODES ? round : -1;
+}
+
+// Table entries contain the result in the low byte and the flags above.
+// Negative results are sign-extended like flexfloat does.
+static inline unsigned int lib_ff8_entry_result(unsigned int entry)
+{
+  return (unsigned int)(int)(int8_t)(entry & 0xff);
+}
+
+static inline uint16_t *lib_ff8_binary_table_build(lib_ff8_binary_op_e op, int mode)
+{
+  iss_cpu_state_t state;
+  memset(&state, 0, sizeof(state));
+
+  uint16_t *table = new uint16_t[256 * 256];
+
+  int old = setFFRoundingMode(&state, mode);
+  for (unsigned int a=0; a<256; a++)
+  {
+    for (unsigned int b=0; b<256; b++)
+    {
+      unsigned int result = 0;
+      state.fcsr.fflags.raw = 0;
+      switch (op)
+      {
+        case LIB_FF8_ADD: result = lib_flexfloat_add(&state, a, b, 5, 2); break;
+        case LIB_FF8_SUB: result = lib_flexfloat_sub(&state, a, b, 5, 2); break;
+        case LIB_FF8_MUL: result = lib_flexfloat_mul(&state, a, b, 5, 2); break;
+        case LIB_FF8_DIV: result = lib_flexfloat_div(&state, a, b, 5, 2); break;
+        default: break;
+      }
+      table[(a << 8) | b] = (result & 0xff) | (state.fcsr.fflags.raw << 8);
+    }
+  }
+  restoreFFRoundingMode(old);
+
+  return table;
+}
+
+inline uint16_t *lib_ff8_binary_table(lib_ff8_binary_op_e op, int mode)
+{
+  static uint16_t *tables[LIB_FF8_NB_BINARY_OPS][LIB_FF8_NB_ROUNDING_MODES];
+  static std::once_flag built[LIB_FF8_NB_BINARY_OPS][LIB_FF8_NB_ROUNDING_MODES];
+
+  std::call_once(built[op][mode], [op, mode]() {
+    tables[op][mode] = lib_ff8_binary_table_build(op, mode);
+  });
+
+  return tables[op][mode];
+}
+
+static inline bool lib_ff8_binary(iss_cpu_state_t *s, lib_ff8_binary_op_e op, unsigned int a, unsigned int b, uint8_t e, uint8_t m, unsigned int round, unsigned int *result)
+{
+  int mode;
+  if (!lib_ff8_is_fp8(e, m) || (mode = lib_ff8_rounding_mode(s, round)) < 0)
+  {
+    return false;
+  }
+
+  unsigned int entry = lib_ff8_binary_table(op, mode)[((a & 0xff) << 8) | (b & 0xff)];
+  set_fflags(s, entry >> 8);
+  *result = lib_ff8_entry_result(entry);
+  return true;
+}
+
+// Execute an operation on the 4 lanes of a vector, in round-to-nearest-even
+// mode. If replicate_b is true, the first lane of b is used for all lanes.
+static inline unsigned int lib_ff8_vec_binary(iss_cpu_state_t *s, lib_ff8_binary_op_e op, unsigned int a, unsigned int b, bool replicate_b)
+{
+  uint16_t *table = lib_ff8_binary_table(op, 0);
+  unsigned int result = 0;
+  unsigned int flags = 0;
+
+  for (int i=0; i<4; i++)
+  {
+    unsigned int lane_a = (a >> (i * 8)) & 0xff;
+    unsigned int lane_b = (replicate_b ? b : b >> (i * 8)) & 0xff;
+    unsigned int entry = table[(lane_a << 8) | lane_b];
+    result |= (entry & 0xff) << (i * 8);
+    flags |= entry >> 8;
+  }
+
+  set_fflags(s, flags);
+
+  return result;
+}
+
 static inline unsigned int lib_flexfloat_madd_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, unsigned int c, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int fast_result;
+  if (lib_ff_fast_fma_enabled(s, e, m, round) && lib_ff_fast_fma(s, a, b, c, false, false, &fast_result))
+    return fast_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_madd(s, a, b, c, e, m);
   restoreFFRoundingMode(old);
@@ -1601,6 +1919,9 @@ static inline unsigned int lib_flexfloat_madd_round(iss_cpu_state_t *s, unsigned
 }
 
 static inline unsigned int lib_flexfloat_msub_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, unsigned int c, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int fast_result;
+  if (lib_ff_fast_fma_enabled(s, e, m, round) && lib_ff_fast_fma(s, a, b, c, false, true, &fast_result))
+    return fast_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_msub(s, a, b, c, e, m);
   restoreFFRoundingMode(old);
@@ -1608,6 +1929,9 @@ static inline unsigned int lib_flexfloat_msub_round(iss_cpu_state_t *s, unsigned
 }
 
 static inline unsigned int lib_flexfloat_nmadd_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, unsigned int c, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int fast_result;
+  if (lib_ff_fast_fma_enabled(s, e, m, round) && lib_ff_fast_fma(s, a, b, c, true, true, &fast_result))
+    return fast_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_nmadd(s, a, b, c, e, m);
   restoreFFRoundingMode(old);
@@ -1615,6 +1939,9 @@ static inline unsigned int lib_flexfloat_nmadd_round(iss_cpu_state_t *s, unsigne
 }
 
 static inline unsigned int lib_flexfloat_nmsub_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, unsigned int c, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int fast_result;
+  if (lib_ff_fast_fma_enabled(s, e, m, round) && lib_ff_fast_fma(s, a, b, c, true, false, &fast_result))
+    return fast_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_nmsub(s, a, b, c, e, m);
   restoreFFRoundingMode(old);
@@ -1622,6 +1949,11 @@ static inline unsigned int lib_flexfloat_nmsub_round(iss_cpu_state_t *s, unsigne
 }
 
 static inline unsigned int lib_flexfloat_add_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int fast_result;
+  if (lib_ff_fast_enabled(s, e, m, round) && lib_ff_fast_add(s, a, b, m, &fast_result))
+    return fast_result;
+  if (lib_ff8_binary(s, LIB_FF8_ADD, a, b, e, m, round, &fast_result))
+    return fast_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_add(s, a, b, e, m);
   restoreFFRoundingMode(old);
@@ -1629,6 +1961,11 @@ static inline unsigned int lib_flexfloat_add_round(iss_cpu_state_t *s, unsigned
 }
 
 static inline unsigned int lib_flexfloat_sub_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int fast_result;
+  if (lib_ff_fast_enabled(s, e, m, round) && lib_ff_fast_sub(s, a, b, m, &fast_result))
+    return fast_result;
+  if (lib_ff8_binary(s, LIB_FF8_SUB, a, b, e, m, round, &fast_result))
+    return fast_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_sub(s, a, b, e, m);
   restoreFFRoundingMode(old);
@@ -1636,6 +1973,11 @@ static inline unsigned int lib_flexfloat_sub_round(iss_cpu_state_t *s, unsigned
 }
 
 static inline unsigned int lib_flexfloat_mul_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int fast_result;
+  if (lib_ff_fast_enabled(s, e, m, round) && lib_ff_fast_mul(s, a, b, m, &fast_result))
+    return fast_result;
+  if (lib_ff8_binary(s, LIB_FF8_MUL, a, b, e, m, round, &fast_result))
+    return fast_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_mul(s, a, b, e, m);
   restoreFFRoundingMode(old);
@@ -1643,6 +1985,11 @@ static inline unsigned int lib_flexfloat_mul_round(iss_cpu_state_t *s, unsigned
 }
 
 static inline unsigned int lib_flexfloat_div_round(iss_cpu_state_t *s, unsigned int a, unsigned int b, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int fast_result;
+  if (lib_ff_fast_enabled(s, e, m, round) && lib_ff_fast_div(s, a, b, m, &fast_result))
+    return fast_result;
+  if (lib_ff8_binary(s, LIB_FF8_DIV, a, b, e, m, round, &fast_result))
+    return fast_result;
   int old = setFFRoundingMode(s, round);
   unsigned int result = lib_flexfloat_div(s, a, b, e, m);
   restoreFFRoundingMode(old);
@@ -1657,6 +2004,9 @@ static inline unsigned int lib_flexfloat_avg_round(iss_cpu_state_t *s, unsigned
 }
 
 static inline unsigned int lib_flexfloat_sqrt_round(iss_cpu_state_t *s, unsigned int a, uint8_t e, uint8_t m, unsigned int round) {
+  unsigned int fast_result;
+  if (lib_ff_fast_enabled(s, e, m, round) && lib_ff_fast_sqrt(s, a, m, &fast_result))
+    return fast_result;
   int old = setFFRoundingMode(s, round);
   FF_INIT_1(a, e, m)
   feclearexcept(FE_ALL_EXCEPT);
@@ -1846,7 +2196,131 @@ static inline unsigned int lib_flexfloat_cvt_ff_lu_round(iss_cpu_state_t *s, uin
   return flexfloat_get_bits(&ff_a);
 }
 
+// Conversion tables from and to the 8-bit minifloat format, for the formats
+// whose operand space is small enough.
+
+typedef enum {
+  LIB_FF8_FMT_FP8,
+  LIB_FF8_FMT_FP16,
+  LIB_FF8_FMT_FP16ALT,
+  LIB_FF8_FMT_FP32,
+  LIB_FF8_NB_FORMATS
+} lib_ff8_format_e;
+
+static inline int lib_ff8_format(uint8_t e, uint8_t m)
+{
+  if (e == 5 && m == 2) return LIB_FF8_FMT_FP8;
+  if (e == 5 && m == 10) return LIB_FF8_FMT_FP16;
+  if (e == 8 && m == 7) return LIB_FF8_FMT_FP16ALT;
+  if (e == 8 && m == 23) return LIB_FF8_FMT_FP32;
+  return -1;
+}
+
+static inline void lib_ff8_format_desc(int format, uint8_t *e, uint8_t *m)
+{
+  static const uint8_t descs[LIB_FF8_NB_FORMATS][2] = { {5, 2}, {5, 10}, {8, 7}, {8, 23} };
+  *e = descs[format][0];
+  *m = descs[format][1];
+}
+
+static inline unsigned int lib_ff8_cvt_emulate(unsigned int a, uint8_t es, uint8_t ms, uint8_t ed, uint8_t md)
+{
+  FF_INIT_1(a, es, ms)
+  ff_cast(&ff_res, &ff_a, (flexfloat_desc_t) {ed,md});
+  return flexfloat_get_bits(&ff_res);
+}
+
+// Conversions from FP8 to any format, indexed by the FP8 value
+static inline uint32_t *lib_ff8_cvt_from_fp8_table_build(int format, int mode)
+{
+  iss_cpu_state_t state;
+  memset(&state, 0, sizeof(state));
+  uint8_t e, m;
+  lib_ff8_format_desc(format, &e, &m);
+
+  uint32_t *table = new uint32_t[256];
+
+  int old = setFFRoundingMode(&state, mode);
+  for (unsigned int a=0; a<256; a++)
+  {
+    table[a] = lib_ff8_cvt_emulate(a, 5, 2, e, m);
+  }
+  restoreFFRoundingMode(old);
+
+  return table;
+}
+
+inline uint32_t *lib_ff8_cvt_from_fp8_table(int format, int mode)
+{
+  static uint32_t *tables[LIB_FF8_NB_FORMATS][LIB_FF8_NB_ROUNDING_MODES];
+  static std::once_flag built[LIB_FF8_NB_FORMATS][LIB_FF8_NB_ROUNDING_MODES];
+
+  std::call_once(built[format][mode], [format, mode]() {
+    tables[format][mode] = lib_ff8_cvt_from_fp8_table_build(format, mode);
+  });
+
+  return tables[format][mode];
+}
+
+// Conversions from 16-bit formats to FP8, indexed by the 16-bit value
+static inline uint8_t *lib_ff8_cvt_to_fp8_table_build(int format, int mode)
+{
+  iss_cpu_state_t state;
+  memset(&state, 0, sizeof(state));
+  uint8_t e, m;
+  lib_ff8_format_desc(format, &e, &m);
+
+  uint8_t *table = new uint8_t[1 << 16];
+
+  int old = setFFRoundingMode(&state, mode);
+  for (unsigned int a=0; a<(1 << 16); a++)
+  {
+    table[a] = lib_ff8_cvt_emulate(a, e, m, 5, 2);
+  }
+  restoreFFRoundingMode(old);
+
+  return table;
+}
+
+inline uint8_t *lib_ff8_cvt_to_fp8_table(int format, int mode)
+{
+  static uint8_t *tables[LIB_FF8_NB_FORMATS][LIB_FF8_NB_ROUNDING_MODES];
+  static std::once_flag built[LIB_FF8_NB_FORMATS][LIB_FF8_NB_ROUNDING_MODES];
+
+  std::call_once(built[format][mode], [format, mode]() {
+    tables[format][mode] = lib_ff8_cvt_to_fp8_table_build(format, mode);
+  });
+
+  return tables[format][mode];
+}
+
+static inline bool lib_ff8_cvt(iss_cpu_state_t *s, unsigned int a, uint8_t es, uint8_t ms, uint8_t ed, uint8_t md, unsigned int round, unsigned int *result)
+{
+  int src = lib_ff8_format(es, ms);
+  int dst = lib_ff8_format(ed, md);
+  int mode;
+
+  if (src == LIB_FF8_FMT_FP8 && dst != -1)
+  {
+    if ((mode = lib_ff8_rounding_mode(s, round)) < 0) return false;
+    *result = lib_ff8_cvt_from_fp8_table(dst, mode)[a & 0xff];
+    return true;
+  }
+
+  if (dst == LIB_FF8_FMT_FP8 && (src == LIB_FF8_FMT_FP16 || src == LIB_FF8_FMT_FP16ALT))
+  {
+    if ((mode = lib_ff8_rounding_mode(s, round)) < 0) return false;
+    *result = lib_ff8_entry_result(lib_ff8_cvt_to_fp8_table(src, mode)[a & 0xffff]);
+    return true;
+  }
+
+  return false;
+}
+
 static inline int lib_flexfloat_cvt_ff_ff_round(iss_cpu_state_t *s, unsigned int a, uint8_t es, uint8_t ms, uint8_t ed, uint8_t md, unsigned int round) {
+  unsigned int table_result;
+  if (lib_ff8_cvt(s, a, es, ms, ed, md, round, &table_result))
+    return table_result;
   int old = setFFRoundingMode(s, round);
   FF_INIT_1(a, es, ms)
   ff_cast(&ff_res, &ff_a, (flexfloat_desc_t) {ed,md});
@@ -44,8 +44,8 @@
 #define REG64_GET(reg) iss_get_reg64(iss, insn->in_regs[reg])
 #define REG64_SET(reg,val) iss_set_reg64(iss, insn->out_regs[reg], val)
 
-#define SIM_GET(index) insn->sim[index]
-#define UIM_GET(index) insn->uim[index]
+#define SIM_GET(index) insn->cold->sim[index]
+#define UIM_GET(index) insn->cold->uim[index]
 
 #define SPR_SET(reg,val) iss_set_spec_purp_reg(iss, reg, val)
 #define SPR_GET(reg) iss_get_spec_purp_reg(iss, reg)
@@ -37,9 +37,19 @@ void iss_register_debug_info(iss_t *iss, const char *binary);
 
 void iss_pc_set(iss_t *iss, iss_addr_t value);
 
+int iss_decoder_init(iss_t *iss);
 iss_insn_t *iss_decode_pc(iss_t *cpu, iss_insn_t *pc);
 iss_insn_t *iss_decode_pc_noexec(iss_t *cpu, iss_insn_t *pc);
 void iss_decode_activate_isa(iss_t *cpu, char *isa);
+bool iss_decode_isa_exists(const char *isa);
+
+void iss_debug_init(iss_t *iss);
+int iss_breakpoint_insert(iss_t *iss, iss_addr_t addr);
+int iss_breakpoint_remove(iss_t *iss, iss_addr_t addr);
+void iss_breakpoint_decode(iss_t *iss, iss_insn_t *insn);
+int iss_watchpoint_insert(iss_t *iss, iss_watchpoint_type_e type, iss_addr_t addr, iss_addr_t size);
+int iss_watchpoint_remove(iss_t *iss, iss_watchpoint_type_e type, iss_addr_t addr, iss_addr_t size);
+void iss_watchpoint_check(iss_t *iss, iss_addr_t addr, int size, bool is_write);
 
 
 
@@ -63,7 +63,7 @@ static inline void prefetcher_fetch_value_resume_1(iss_t *iss)
   int nb_bytes = next_addr - addr;
 
   // And append the second part from second line
-  iss->cpu.prefetch_insn->opcode = iss->cpu.state.fetch_stall_opcode | (( *(iss_opcode_t *)&prefetcher->data[0]) << (nb_bytes*8));
+  iss->cpu.prefetch_insn->cold->opcode = iss->cpu.state.fetch_stall_opcode | (( *(iss_opcode_t *)&prefetcher->data[0]) << (nb_bytes*8));
   iss_decode_pc_noexec(iss, iss->cpu.prefetch_insn);
 }
 
@@ -75,7 +75,7 @@ static inline void prefetcher_fetch_value_after_fill_0(
 
   if (likely(index + ISS_OPCODE_MAX_SIZE <= ISS_PREFETCHER_SIZE))
   {
-    insn->opcode = *(iss_opcode_t *)&prefetcher->data[index];
+    insn->cold->opcode = *(iss_opcode_t *)&prefetcher->data[index];
     iss_decode_pc_noexec(iss, insn);
   }
   else
@@ -102,7 +102,7 @@ static inline void prefetcher_fetch_value_after_fill_0(
     // And append the second part from second line
     opcode = opcode | (( *(iss_opcode_t *)&prefetcher->data[0]) << (nb_bytes*8));
 
-    insn->opcode = opcode;
+    insn->cold->opcode = opcode;
     iss_decode_pc_noexec(iss, insn);
   }
 }
@@ -125,7 +125,7 @@ static inline void __attribute__((always_inline)) prefetcher_fetch_value(
 
   if (likely(index >= 0 && index  <= ISS_PREFETCHER_SIZE - sizeof(iss_opcode_t)))
   {
-    insn->opcode = *(iss_opcode_t *)&prefetcher->data[index];
+    insn->cold->opcode = *(iss_opcode_t *)&prefetcher->data[index];
     iss_decode_pc_noexec(iss, insn);
     return;
   }
@@ -545,7 +545,7 @@ static inline iss_insn_t *hwloop_check_exec(iss_t *iss, iss_insn_t *insn)
 
   // First execute the instructions as it is the last one of the loop body.
   // The real handler has been saved when the loop was started.
-  iss_insn_t *insn_next = iss_exec_insn_handler(iss, insn, insn->hwloop_handler);
+  iss_insn_t *insn_next = iss_exec_insn_handler(iss, insn, insn->cold->hwloop_handler);
 
   if (elw_interrupted)
   {
@@ -602,16 +602,16 @@ static inline void hwloop_set_insn_end(iss_t *iss, iss_insn_t *insn)
 {
   if (insn->fetched)
   {
-    if (insn->hwloop_handler == NULL)
+    if (insn->cold->hwloop_handler == NULL)
     {
-      insn->hwloop_handler = insn->handler;
+      insn->cold->hwloop_handler = insn->handler;
       insn->handler = hwloop_check_exec;
       insn->fast_handler = hwloop_check_exec;
     }
   }
   else
   {
-    insn->hwloop_handler = hwloop_check_exec;
+    insn->cold->hwloop_handler = hwloop_check_exec;
   }
 }
 
@@ -24,12 +24,10 @@
 
 #include "types.hpp"
 
-static iss_reg_t null_reg = 0;
-
 static inline iss_reg_t *iss_reg_ref(iss_t *iss, int reg)
 {
   if (reg == 0)
-    return &null_reg;
+    return &iss->cpu.regfile.null_reg;
   else
     return &iss->cpu.regfile.regs[reg];
 }
@@ -832,10 +832,7 @@ static inline iss_insn_t *vfcvt_ah_h_exec(iss_t *iss, iss_insn_t *insn)
 //
 static inline iss_insn_t *vfadd_b_exec(iss_t *iss, iss_insn_t *insn)
 {
-  REG_SET(0, (LIB_FF_CALL3(lib_flexfloat_add_round, REG_GET(0) & 0xff, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) |\
-            ((LIB_FF_CALL3(lib_flexfloat_add_round, REG_GET(0) >> 8, REG_GET(1) >> 8, 5, 2, 0) & 0xff) << 8) |\
-            ((LIB_FF_CALL3(lib_flexfloat_add_round, REG_GET(0) >> 16, REG_GET(1) >> 16, 5, 2, 0) & 0xff) << 16) |\
-            ((LIB_FF_CALL3(lib_flexfloat_add_round, REG_GET(0) >> 24, REG_GET(1) >> 24, 5, 2, 0) & 0xff) << 24));
+  REG_SET(0, LIB_CALL4(lib_ff8_vec_binary, LIB_FF8_ADD, REG_GET(0), REG_GET(1), false));
   return insn->next;
 }
 
@@ -843,10 +840,7 @@ static inline iss_insn_t *vfadd_b_exec(iss_t *iss, iss_insn_t *insn)
 
 static inline iss_insn_t *vfadd_r_b_exec(iss_t *iss, iss_insn_t *insn)
 {
-  REG_SET(0, (LIB_FF_CALL3(lib_flexfloat_add_round, REG_GET(0) & 0xff, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) |\
-            ((LIB_FF_CALL3(lib_flexfloat_add_round, REG_GET(0) >> 8, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) << 8) |\
-            ((LIB_FF_CALL3(lib_flexfloat_add_round, REG_GET(0) >> 16, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) << 16) |\
-            ((LIB_FF_CALL3(lib_flexfloat_add_round, REG_GET(0) >> 24, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) << 24));
+  REG_SET(0, LIB_CALL4(lib_ff8_vec_binary, LIB_FF8_ADD, REG_GET(0), REG_GET(1), true));
   return insn->next;
 }
 
@@ -854,10 +848,7 @@ static inline iss_insn_t *vfadd_r_b_exec(iss_t *iss, iss_insn_t *insn)
 
 static inline iss_insn_t *vfsub_b_exec(iss_t *iss, iss_insn_t *insn)
 {
-  REG_SET(0, (LIB_FF_CALL3(lib_flexfloat_sub_round, REG_GET(0) & 0xff, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) |\
-            ((LIB_FF_CALL3(lib_flexfloat_sub_round, REG_GET(0) >> 8, REG_GET(1) >> 8, 5, 2, 0) & 0xff) << 8) |\
-            ((LIB_FF_CALL3(lib_flexfloat_sub_round, REG_GET(0) >> 16, REG_GET(1) >> 16, 5, 2, 0) & 0xff) << 16) |\
-            ((LIB_FF_CALL3(lib_flexfloat_sub_round, REG_GET(0) >> 24, REG_GET(1) >> 24, 5, 2, 0) & 0xff) << 24));
+  REG_SET(0, LIB_CALL4(lib_ff8_vec_binary, LIB_FF8_SUB, REG_GET(0), REG_GET(1), false));
   return insn->next;
 }
 
@@ -865,10 +856,7 @@ static inline iss_insn_t *vfsub_b_exec(iss_t *iss, iss_insn_t *insn)
 
 static inline iss_insn_t *vfsub_r_b_exec(iss_t *iss, iss_insn_t *insn)
 {
-  REG_SET(0, (LIB_FF_CALL3(lib_flexfloat_sub_round, REG_GET(0) & 0xff, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) |\
-            ((LIB_FF_CALL3(lib_flexfloat_sub_round, REG_GET(0) >> 8, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) << 8) |\
-            ((LIB_FF_CALL3(lib_flexfloat_sub_round, REG_GET(0) >> 16, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) << 16) |\
-            ((LIB_FF_CALL3(lib_flexfloat_sub_round, REG_GET(0) >> 24, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) << 24));
+  REG_SET(0, LIB_CALL4(lib_ff8_vec_binary, LIB_FF8_SUB, REG_GET(0), REG_GET(1), true));
   return insn->next;
 }
 
@@ -876,10 +864,7 @@ static inline iss_insn_t *vfsub_r_b_exec(iss_t *iss, iss_insn_t *insn)
 
 static inline iss_insn_t *vfmul_b_exec(iss_t *iss, iss_insn_t *insn)
 {
-  REG_SET(0, (LIB_FF_CALL3(lib_flexfloat_mul_round, REG_GET(0) & 0xff, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) |\
-            ((LIB_FF_CALL3(lib_flexfloat_mul_round, REG_GET(0) >> 8, REG_GET(1) >> 8, 5, 2, 0) & 0xff) << 8) |\
-            ((LIB_FF_CALL3(lib_flexfloat_mul_round, REG_GET(0) >> 16, REG_GET(1) >> 16, 5, 2, 0) & 0xff) << 16) |\
-            ((LIB_FF_CALL3(lib_flexfloat_mul_round, REG_GET(0) >> 24, REG_GET(1) >> 24, 5, 2, 0) & 0xff) << 24));
+  REG_SET(0, LIB_CALL4(lib_ff8_vec_binary, LIB_FF8_MUL, REG_GET(0), REG_GET(1), false));
   return insn->next;
 }
 
@@ -887,10 +872,7 @@ static inline iss_insn_t *vfmul_b_exec(iss_t *iss, iss_insn_t *insn)
 
 static inline iss_insn_t *vfmul_r_b_exec(iss_t *iss, iss_insn_t *insn)
 {
-  REG_SET(0, (LIB_FF_CALL3(lib_flexfloat_mul_round, REG_GET(0) & 0xff, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) |\
-            ((LIB_FF_CALL3(lib_flexfloat_mul_round, REG_GET(0) >> 8, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) << 8) |\
-            ((LIB_FF_CALL3(lib_flexfloat_mul_round, REG_GET(0) >> 16, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) << 16) |\
-            ((LIB_FF_CALL3(lib_flexfloat_mul_round, REG_GET(0) >> 24, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) << 24));
+  REG_SET(0, LIB_CALL4(lib_ff8_vec_binary, LIB_FF8_MUL, REG_GET(0), REG_GET(1), true));
   return insn->next;
 }
 
@@ -898,10 +880,7 @@ static inline iss_insn_t *vfmul_r_b_exec(iss_t *iss, iss_insn_t *insn)
 
 static inline iss_insn_t *vfdiv_b_exec(iss_t *iss, iss_insn_t *insn)
 {
-  REG_SET(0, (LIB_FF_CALL3(lib_flexfloat_div_round, REG_GET(0) & 0xff, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) |\
-            ((LIB_FF_CALL3(lib_flexfloat_div_round, REG_GET(0) >> 8, REG_GET(1) >> 8, 5, 2, 0) & 0xff) << 8) |\
-            ((LIB_FF_CALL3(lib_flexfloat_div_round, REG_GET(0) >> 16, REG_GET(1) >> 16, 5, 2, 0) & 0xff) << 16) |\
-            ((LIB_FF_CALL3(lib_flexfloat_div_round, REG_GET(0) >> 24, REG_GET(1) >> 24, 5, 2, 0) & 0xff) << 24));
+  REG_SET(0, LIB_CALL4(lib_ff8_vec_binary, LIB_FF8_DIV, REG_GET(0), REG_GET(1), false));
   return insn->next;
 }
 
@@ -909,10 +888,7 @@ static inline iss_insn_t *vfdiv_b_exec(iss_t *iss, iss_insn_t *insn)
 
 static inline iss_insn_t *vfdiv_r_b_exec(iss_t *iss, iss_insn_t *insn)
 {
-  REG_SET(0, (LIB_FF_CALL3(lib_flexfloat_div_round, REG_GET(0) & 0xff, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) |\
-            ((LIB_FF_CALL3(lib_flexfloat_div_round, REG_GET(0) >> 8, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) << 8) |\
-            ((LIB_FF_CALL3(lib_flexfloat_div_round, REG_GET(0) >> 16, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) << 16) |\
-            ((LIB_FF_CALL3(lib_flexfloat_div_round, REG_GET(0) >> 24, REG_GET(1) & 0xff, 5, 2, 0) & 0xff) << 24));
+  REG_SET(0, LIB_CALL4(lib_ff8_vec_binary, LIB_FF8_DIV, REG_GET(0), REG_GET(1), true));
   return insn->next;
 }
 
@@ -44,7 +44,7 @@ static inline iss_insn_t *auipc_exec(iss_t *iss, iss_insn_t *insn)
 
 static inline void auipc_decode(iss_t *iss, iss_insn_t *insn)
 {
-  insn->uim[0] += insn->addr;
+  insn->cold->uim[0] += insn->addr;
 }
 
 
@@ -77,14 +77,14 @@ static inline void jal_decode(iss_t *iss, iss_insn_t *insn)
 {
 
 
-  insn->next = insn_cache_get(iss, insn->addr + insn->sim[0]);
+  insn->next = insn_cache_get(iss, insn->addr + insn->cold->sim[0]);
 }
 
 
 
 static inline iss_insn_t *jalr_exec_common(iss_t *iss, iss_insn_t *insn, int perf)
 {
-  iss_insn_t *next_insn = insn_cache_get(iss, insn->sim[0] + iss_get_reg_for_jump(iss, insn->in_regs[0]));
+  iss_insn_t *next_insn = insn_cache_get(iss, insn->cold->sim[0] + iss_get_reg_for_jump(iss, insn->in_regs[0]));
   unsigned int D = insn->out_regs[0];
   if (D != 0) REG_SET(0, insn->addr + insn->size);
   if (perf)
@@ -455,7 +455,7 @@ static inline iss_insn_t *nop_exec(iss_t *iss, iss_insn_t *insn)
 
 static inline iss_insn_t *slti_exec(iss_t *iss, iss_insn_t *insn)
 {
-  REG_SET(0, (int32_t)REG_GET(0) < insn->sim[0]);
+  REG_SET(0, (int32_t)REG_GET(0) < insn->cold->sim[0]);
   return insn->next;
 }
 
@@ -617,7 +617,7 @@ static inline iss_insn_t *ebreak_exec(iss_t *iss, iss_insn_t *insn)
 {
   iss_insn_t *prev = iss->cpu.prev_insn;
 
-  if (prev && prev->fetched && prev->opcode == 0x01f01013)
+  if (prev && prev->fetched && prev->cold->opcode == 0x01f01013)
   {
       iss_handle_riscv_ebreak(iss, insn);
       return insn->next;
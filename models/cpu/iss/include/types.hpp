@@ -96,11 +96,19 @@ class iss;
 #define ISS_MAX_NB_OUT_REGS 3
 #define ISS_MAX_NB_IN_REGS 3
 
+// Number of instructions per block of the instruction cache. Can be overridden
+// at build time for big code footprints.
+#ifndef ISS_INSN_BLOCK_SIZE_LOG2
 #define ISS_INSN_BLOCK_SIZE_LOG2 8
+#endif
 #define ISS_INSN_BLOCK_SIZE (1<<ISS_INSN_BLOCK_SIZE_LOG2)
 #define ISS_INSN_PC_BITS 1
-#define ISS_INSN_BLOCK_ID_BITS 12
-#define ISS_INSN_NB_BLOCKS (1<<ISS_INSN_BLOCK_ID_BITS)
+// Initial number of entries of the block hash table, doubled when it is half full
+#define ISS_INSN_NB_BLOCKS_INIT 256
+// Number of last accessed blocks remembered to skip the hash table lookup
+#define ISS_INSN_BLOCK_MEMO_SIZE 8
+// Initial number of entries of the decoded opcode hash table, doubled when it is half full
+#define ISS_DECODED_OPCODES_INIT 1024
 
 #define ISS_EXCEPT_RESET    0
 #define ISS_EXCEPT_ILLEGAL  1
@@ -246,7 +254,6 @@ typedef struct iss_decoder_arg_s {
 typedef struct iss_decoder_item_s {
 
   bool is_insn;
-  bool is_active;
 
   bool opcode_others;
   iss_opcode_t opcode;
@@ -265,6 +272,7 @@ typedef struct iss_decoder_item_s {
       int resource_latency;          // Time required to get the result when accessing the resource
       int resource_bandwidth;        // Time required to accept the next access when accessing the resource
       int power_group;
+      int id;                        // Index of the instruction in the ISA, used for per-core tables
     } insn;
 
     struct {
@@ -272,6 +280,7 @@ typedef struct iss_decoder_item_s {
       int width;
       int nb_groups;
       iss_decoder_item_t **groups;
+      iss_decoder_item_t **table;    // Sub-items indexed by opcode, NULL if the groups must be scanned
     } group;
   } u;
 
@@ -307,6 +316,7 @@ typedef struct iss_isa_set_s
   iss_isa_t *isa_set;
   int nb_resources;
   iss_resource_t *resources;   // Resources associated to this ISA
+  int nb_insns;                // Number of instructions of this ISA, see the instruction id
 } iss_isa_set_t;
 
 typedef struct iss_isa_tag_s
@@ -320,25 +330,21 @@ typedef struct {
   iss_addr_t addr;
 } iss_prefetcher_t;
 
-typedef struct iss_insn_s {
-  iss_addr_t addr;
-  iss_reg_t opcode;
-  bool fetched;
-  iss_insn_t *(*fast_handler)(iss_t *, iss_insn_t*);
-  iss_insn_t *(*handler)(iss_t *, iss_insn_t*);
+// Decoded instruction information which is not needed to go from one
+// instruction to the next in the fast execution path, only by the decoder, the
+// instruction traces, the stalls, the resources and the handlers of the
+// instructions with immediates. It is kept apart from the instruction so that
+// the instruction cache blocks are denser.
+typedef struct iss_insn_cold_s {
   iss_insn_t *(*resource_handler)(iss_t *, iss_insn_t*);        // Handler called when an instruction with an associated resource is executed. The handler will take care of simulating the timing of the resource.
-  iss_insn_t *(*hwloop_handler)(iss_t *, iss_insn_t*);
   iss_insn_t *(*stall_handler)(iss_t *, iss_insn_t*);
   iss_insn_t *(*stall_fast_handler)(iss_t *, iss_insn_t*);
-  int size;
+  iss_insn_t *(*saved_handler)(iss_t *, iss_insn_t*);
+  iss_insn_t *(*breakpoint_handler)(iss_t *, iss_insn_t*);       // Handlers replaced by the breakpoint handler when a breakpoint is set on the instruction
+  iss_insn_t *(*breakpoint_fast_handler)(iss_t *, iss_insn_t*);
   int nb_out_reg;
   int nb_in_reg;
-  int out_regs[ISS_MAX_NB_OUT_REGS];
-  int in_regs[ISS_MAX_NB_IN_REGS];
-  iss_uim_t uim[ISS_MAX_IMMEDIATES];
-  iss_sim_t sim[ISS_MAX_IMMEDIATES];
-  iss_insn_arg_t args[ISS_MAX_DECODE_ARGS];
-  iss_insn_t *next;
+  iss_insn_arg_t *args;          // Decoded arguments, owned by the decoded opcode store
   iss_decoder_item_t *decoder_item;
   int resource_id;   // Identifier of the resource associated to this instruction
   int resource_latency;          // Time required to get the result when accessing the resource
@@ -347,28 +353,67 @@ typedef struct iss_insn_s {
   int input_latency;
   int input_latency_reg;
 
-  iss_insn_t *(*saved_handler)(iss_t *, iss_insn_t*);
-  iss_insn_t *branch;
-
-  int in_spregs[6];
+  iss_reg_t opcode;
+  iss_insn_t *(*hwloop_handler)(iss_t *, iss_insn_t*);  // Handler executed instead of the normal one when the instruction ends a hardware loop
+  iss_uim_t uim[ISS_MAX_IMMEDIATES];
+  iss_sim_t sim[ISS_MAX_IMMEDIATES];
+} iss_insn_cold_t;
 
+// Decoded instruction. The fields used by the fast execution path are put
+// first so that they fit into as few cache lines as possible.
+typedef struct iss_insn_s {
+  iss_insn_t *(*fast_handler)(iss_t *, iss_insn_t*);
+  iss_insn_t *next;
+  int out_regs[ISS_MAX_NB_OUT_REGS];
+  int in_regs[ISS_MAX_NB_IN_REGS];
   int latency;
-
+  int size;
+  iss_addr_t addr;
+  bool fetched;
+  iss_insn_t *(*handler)(iss_t *, iss_insn_t*);
+  iss_insn_t *branch;
+  iss_insn_cold_t *cold;
 } iss_insn_t;
 
 typedef struct iss_insn_block_s {
   iss_addr_t pc;
   iss_insn_t insns[ISS_INSN_BLOCK_SIZE];
-  iss_insn_block_t *next;
-  bool is_init;
+  iss_insn_cold_t cold[ISS_INSN_BLOCK_SIZE];
 } iss_insn_block_t;
 
+// Decoding of an opcode, which only depends on the opcode and on the active ISA.
+// It is never modified once built, so that all the instructions with the same
+// opcode, possibly from several cores, can use it instead of decoding again.
+typedef struct iss_decoded_opcode_s {
+  iss_opcode_t opcode;
+  iss_decoder_item_t *item;
+  int nb_out_reg;
+  int nb_in_reg;
+  int out_regs[ISS_MAX_NB_OUT_REGS];
+  int in_regs[ISS_MAX_NB_IN_REGS];
+  iss_uim_t uim[ISS_MAX_IMMEDIATES];
+  iss_sim_t sim[ISS_MAX_IMMEDIATES];
+  int next_input_latency_reg;    // Output register whose latency stalls the next instruction, or -1
+  int next_input_latency;
+  iss_insn_arg_t args[ISS_MAX_DECODE_ARGS];
+} iss_decoded_opcode_t;
+
+typedef struct iss_decoded_opcode_store_s {
+  iss_decoded_opcode_t **entries;   // Open-addressing hash table of decoded opcodes, indexed by opcode
+  int nb_entries;                   // Number of entries of the hash table
+  int nb_used;                      // Number of decoded opcodes in the hash table
+} iss_decoded_opcode_store_t;
+
 typedef struct iss_insn_cache_s {
-  iss_insn_block_t *blocks[ISS_INSN_NB_BLOCKS];
+  iss_insn_block_t **blocks;    // Open-addressing hash table of blocks, indexed by block address
+  int nb_blocks;                // Number of entries of the hash table
+  int nb_used;                  // Number of blocks in the hash table
+  iss_insn_block_t *memo[ISS_INSN_BLOCK_MEMO_SIZE];   // Last accessed blocks, indexed by block address
 } iss_insn_cache_t;
 
 typedef struct iss_regfile_s {
   iss_reg_t regs[ISS_NB_REGS + ISS_NB_FREGS];
+  iss_reg_t null_reg;           // Sink for values loaded into register 0, kept per core so that cores can run on different threads
 } iss_regfile_t;
 
 typedef struct
@@ -430,6 +475,7 @@ typedef struct iss_config_s {
   iss_reg_t misa;
   const char *isa;
   iss_addr_t debug_handler;
+  bool shared_decode;
 } iss_config_t;
 
 typedef struct iss_irq_s {
@@ -493,10 +539,45 @@ typedef struct iss_rnnext_s
 } iss_rnnext_t;
 
 
+typedef enum {
+  ISS_DEBUG_STOP_NONE,
+  ISS_DEBUG_STOP_BREAKPOINT,
+  ISS_DEBUG_STOP_WATCH_WRITE,
+  ISS_DEBUG_STOP_WATCH_READ,
+  ISS_DEBUG_STOP_WATCH_ACCESS,
+} iss_debug_stop_e;
+
+typedef enum {
+  ISS_WATCHPOINT_WRITE = 1,
+  ISS_WATCHPOINT_READ = 2,
+  ISS_WATCHPOINT_ACCESS = 3,
+} iss_watchpoint_type_e;
+
+typedef struct iss_watchpoint_s {
+  iss_addr_t base;
+  iss_addr_t size;
+  iss_watchpoint_type_e type;
+} iss_watchpoint_t;
+
+// Breakpoints and watchpoints set by the debugger. Breakpoints are inserted by
+// replacing the handler of the decoded instruction, so that the target memory
+// is never modified, and watchpoints are checked by the data accesses.
+typedef struct iss_debug_s {
+  std::vector<iss_addr_t> breakpoints;
+  std::vector<iss_watchpoint_t> watchpoints;
+  int nb_breakpoints;           // Number of breakpoints, checked when decoding instructions
+  int nb_watchpoints;           // Number of watchpoints, checked on each data access
+  iss_insn_t *resume_insn;      // Instruction whose breakpoint is skipped once when resuming from it
+  iss_debug_stop_e stop_reason; // Reason of the last stop caused by a breakpoint or a watchpoint
+  iss_addr_t stop_addr;         // Address of the breakpoint or of the data access which caused the stop
+} iss_debug_t;
+
 typedef struct iss_cpu_s {
   iss_prefetcher_t decode_prefetcher;
   iss_prefetcher_t prefetcher;
   iss_insn_cache_t insn_cache;
+  iss_decoded_opcode_store_t *decoded_opcodes;
+  std::vector<bool> active_insns;   // Instructions of the ISA tags activated for this core, indexed by instruction id
   iss_insn_t *current_insn;
   iss_insn_t *prev_insn;
   iss_insn_t *stall_insn;
@@ -509,6 +590,7 @@ typedef struct iss_cpu_s {
   iss_pulpv2_t pulpv2;
   iss_pulp_nn_t pulp_nn;
   iss_rnnext_t rnnext;
+  iss_debug_t debug;
   std::vector<iss_resource_instance_t *>resources;     // When accesses to the resources are scheduled statically, this gives the instance allocated to this core for each resource
 } iss_cpu_t;
 
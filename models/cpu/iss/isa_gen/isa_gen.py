@@ -367,6 +367,10 @@ class DecodeLeaf(object):
     def get_name(self):
         return self.instr.get_full_name()
 
+# Groups whose opcode is at most this number of bits wide get a dispatch table
+# indexed by the opcode, instead of being scanned linearly by the decoder
+decoder_table_max_width = 10
+
 class DecodeTree(object):
     def __init__(self, isaFile, instrs, mask, opcode):
         self.opcode = opcode
@@ -541,9 +545,21 @@ class DecodeTree(object):
              
                 self.dump(' };\n')
 
+                has_table = self.opcode_width <= decoder_table_max_width
+                if has_table:
+                    others = self.subtrees.get('OTHERS')
+                    table = [others] * (1 << self.opcode_width)
+                    for opcode, subtree in self.subtrees.items():
+                        if opcode != 'OTHERS':
+                            table[int(opcode, 2)] = subtree
+
+                    self.dump('static iss_decoder_item_t *%s_table[] = {' % self.get_name());
+                    for subtree in table:
+                        self.dump(' NULL,' if subtree is None else ' &%s,' % subtree.get_name())
+                    self.dump(' };\n')
+
                 self.dump('%siss_decoder_item_t %s = {\n' % ('' if is_top else 'static ', self.get_name()))
                 self.dump('  .is_insn=false,\n')
-                self.dump('  .is_active=false,\n')
                 self.dump('  .opcode_others=0,\n')
                 self.dump('  .opcode=0b%s,\n' % self.opcode)
                 self.dump('  .u={\n')
@@ -551,7 +567,8 @@ class DecodeTree(object):
                 self.dump('      .bit=%d,\n' % self.firstBit)
                 self.dump('      .width=%d,\n' % self.opcode_width)
                 self.dump('      .nb_groups=%d,\n' % len(self.subtrees))
-                self.dump('      .groups=%s_groups\n' % self.get_name())
+                self.dump('      .groups=%s_groups,\n' % self.get_name())
+                self.dump('      .table=%s\n' % ('%s_table' % self.get_name() if has_table else 'NULL'))
                 self.dump('    }\n')
                 self.dump('  }\n')
                 self.dump('};\n')
@@ -637,6 +654,7 @@ class Isa(object):
         self.trees = trees
         self.trees_dict = {}
         self.resources = []
+        self.insn_ids = {}
 
         for tree in self.trees:
             self.trees_dict[tree.name] = tree
@@ -650,6 +668,9 @@ class Isa(object):
 
         return -1
 
+    def get_insn_id(self, insn):
+        return self.insn_ids.setdefault(insn.get_full_name(), len(self.insn_ids))
+
     def add_resource(self, name, instances=1):
         self.resources.append(Resource(name, instances))
 
@@ -723,6 +744,7 @@ class Isa(object):
         self.dump('  .isa_set=__iss_isa_list,\n')
         self.dump('  .nb_resources=%d,\n' % len(self.resources))
         self.dump('  .resources=__iss_resources,\n')
+        self.dump('  .nb_insns=%d,\n' % len(self.insn_ids))
         self.dump('};\n')
 
 
@@ -1043,7 +1065,6 @@ class Instr(object):
 
         self.dump(isaFile, 'static iss_decoder_item_t %s = {\n' % (name))
         self.dump(isaFile, '  .is_insn=true,\n')
-        self.dump(isaFile, '  .is_active=false,\n')
         self.dump(isaFile, '  .opcode_others=%d,\n' % (1 if others else 0))
         self.dump(isaFile, '  .opcode=0b%s,\n' % opcode)
         self.dump(isaFile, '  .u={\n')
@@ -1064,6 +1085,7 @@ class Instr(object):
         self.dump(isaFile, '      .resource_latency=%d,\n' % self.resource_latency)
         self.dump(isaFile, '      .resource_bandwidth=%d,\n' % self.resource_bandwidth)
         self.dump(isaFile, '      .power_group=%d,\n' % (self.power_group))
+        self.dump(isaFile, '      .id=%d,\n' % (isa.get_insn_id(self)))
         self.dump(isaFile, '    }\n')
         self.dump(isaFile, '  }\n')
         self.dump(isaFile, '};\n')
@@ -1,11 +1,21 @@
 COMMON_SRCS = $(GVSOC_ISS_PATH)/vp/src/iss_wrapper.cpp $(GVSOC_ISS_PATH)/src/iss.cpp \
 	$(GVSOC_ISS_PATH)/src/insn_cache.cpp $(GVSOC_ISS_PATH)/src/csr.cpp \
 	$(GVSOC_ISS_PATH)/src/decoder.cpp $(GVSOC_ISS_PATH)/src/trace.cpp \
-	$(GVSOC_ISS_PATH)/src/resource.c \
+	$(GVSOC_ISS_PATH)/src/debug.cpp \
+	$(GVSOC_ISS_PATH)/src/resource.cpp \
 	$(GVSOC_ISS_PATH)/flexfloat/flexfloat.c
 
 COMMON_CFLAGS = -DRISCV=1 -DRISCY -I$(GVSOC_ISS_PATH)/include -I$(GVSOC_ISS_PATH)/vp/include -I$(GVSOC_ISS_PATH)/flexfloat -mtune=generic -fno-strict-aliasing
 
+ifdef ISS_INSN_BLOCK_SIZE_LOG2
+COMMON_CFLAGS += -DISS_INSN_BLOCK_SIZE_LOG2=$(ISS_INSN_BLOCK_SIZE_LOG2)
+endif
+
+# Use the host F16C instructions for binary16 conversions in the FPU fast path
+ifdef ISS_HOST_F16C
+COMMON_CFLAGS += -mf16c
+endif
+
 ifdef USE_TRDB
 COMMON_CFLAGS += -DUSE_TRDB=1
 COMMON_LDFLAGS = -ltrdb -lbfd -lopcodes -liberty -lz
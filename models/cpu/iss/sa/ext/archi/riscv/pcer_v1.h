@@ -55,6 +55,13 @@
 #define CSR_PCMR_ACTIVE           0x1 /* Activate counting */
 #define CSR_PCMR_SATURATE         0x2 /* Activate saturation */
 
+#define CSR_HWLOOP0_START   0x7B0
+#define CSR_HWLOOP0_END     0x7B1
+#define CSR_HWLOOP0_COUNTER 0x7B2
+#define CSR_HWLOOP1_START   0x7B4
+#define CSR_HWLOOP1_END     0x7B5
+#define CSR_HWLOOP1_COUNTER 0x7B6
+
 #define CSR_PCER_NAME(id) (id == 0 ? "Cycles" : id == 1 ? "Instructions" : id == 2 ? "LD_Stall" : id == 3 ? "Jmp_Stall" : id == 4 ? "IMISS" : id == 5 ? "LD" : id == 6 ? "ST" : id == 7 ? "JUMP" : id == 8 ? "BRANCH" : id == 9 ? "TAKEN_BRANCH" : id == 10 ? "RVC" : id == 11 ? "LD_EXT" : id == 12 ? "ST_EXT" : id == 13 ? "LD_EXT_CYC" : id == 14 ? "ST_EXT_CYC" : id == 15 ? "TCDM_CONT" : "NA")
 
 #endif
@@ -28,10 +28,57 @@
 #include <string.h>
 #include <stdarg.h>
 
+#ifndef likely
+#define   likely(x) __builtin_expect(x, 1)
+#define unlikely(x) __builtin_expect(x, 0)
+#endif
+
+// Counterparts of the registers and events of the vp wrapper which are used by
+// the ISS. There is no timing in the standalone ISS, so events are never
+// enqueued and requests never stall.
+typedef struct
+{
+  int64_t value = 0;
+
+  inline int64_t get() { return this->value; }
+  inline void set(int64_t value) { this->value = value; }
+  inline void inc(int64_t value) { this->value += value; }
+  inline void dec(int64_t value) { this->value -= value; }
+} iss_sa_reg_t;
+
+typedef struct
+{
+  inline bool is_enqueued() { return false; }
+} iss_sa_event_t;
+
 typedef struct iss_s
 {
   iss_cpu_t cpu;
 
+  iss_sa_reg_t stalled;
+  iss_sa_reg_t is_active_reg;
+  iss_sa_reg_t step_mode;
+  iss_sa_event_t event;
+  iss_sa_event_t *current_event = &event;
+
+  inline void event_cancel(iss_sa_event_t *event) {}
+
+  inline int64_t get_cycles() { return 0; }
+
+  // Returns 0 if the access is done, which is always the case, out-of-bound
+  // accesses being ignored
+  inline int data_req(iss_addr_t addr, uint8_t *data, int size, bool is_write)
+  {
+    if (addr + size <= this->mem_size)
+    {
+      if (is_write)
+        memcpy(this->mem_array + addr, data, size);
+      else
+        memcpy(data, this->mem_array + addr, size);
+    }
+    return 0;
+  }
+
   int fast_mode;
 
   bfd *abfd;
@@ -56,6 +103,15 @@ void handle_syscall(iss_t *iss, iss_insn_t *insn);
 
 //#define USE_INSN_TRACES 1
 
+#ifndef TRACE_FORMAT_LONG
+#define TRACE_FORMAT_LONG  0
+#endif
+
+static inline int iss_trace_format(iss_t *iss)
+{
+  return TRACE_FORMAT_LONG;
+}
+
 static inline bool iss_insn_trace_active(iss_t *iss)
 {
 #ifdef USE_INSN_TRACES
@@ -119,6 +175,14 @@ static inline void iss_handle_ebreak(iss_t *iss, iss_insn_t *insn)
 {
 }
 
+static inline void iss_handle_riscv_ebreak(iss_t *iss, iss_insn_t *insn)
+{
+}
+
+static inline void iss_fence_i(iss_t *iss)
+{
+}
+
 static inline int iss_pccr_trace_active(iss_t *iss, unsigned int event)
 {
   return 0;
@@ -132,15 +196,7 @@ static inline int iss_fetch_req(iss_t *iss, uint64_t addr, uint8_t *data, uint64
 
 static inline int iss_irq_ack(iss_t *iss, int irq)
 {
-}
-
-/* load from special purpose register */
-static inline void iss_lsu_load_spr(iss_t *iss, iss_insn_t *insn, iss_addr_t addr, int size, int spreg)
-{
-  if (addr + size > iss->mem_size)
-    return;
-
-  iss_set_spec_purp_reg(iss, spreg, iss_get_zext_value(*(iss_reg_t *)(iss->mem_array + addr), size*8));
+  return 0;
 }
 
 static inline void iss_lsu_load(iss_t *iss, iss_insn_t *insn, iss_addr_t addr, int size, int reg)
@@ -176,16 +232,25 @@ static inline void iss_set_halt_mode(iss_t *iss, bool halted, int cause)
 {
 }
 
+static inline void iss_debug_halt(iss_t *iss)
+{
+}
+
 static inline void iss_wait_for_interrupt(iss_t *iss)
 {
 }
 
+// Any CSR write, mret/dret or interrupt enable change makes the main loop
+// leave the fast mode, so that the next instruction goes through the full
+// checks, which then decide if the fast mode can be resumed.
 static inline void iss_trigger_check_all(iss_t *iss)
 {
+  iss->fast_mode = 0;
 }
 
 static inline void iss_trigger_irq_check(iss_t *iss)
 {
+  iss->fast_mode = 0;
 }
 
 static void iss_csr_ext_counter_set(iss_t *iss, int id, unsigned int value)
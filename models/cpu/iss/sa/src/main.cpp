@@ -27,8 +27,91 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdarg.h>
+#include <getopt.h>
 
 #define MEMORY_SIZE (16*1024*1024)
+#define DEFAULT_ISA "rv32imcXpulpv2"
+
+
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "Usage: %s [options] <binary> [<binary args>...]\n", name);
+  fprintf(stderr, "  --mem-size=<size>  Memory size in bytes, with optional K/M/G suffix (default: %d)\n", MEMORY_SIZE);
+  fprintf(stderr, "  --isa=<isa>        ISA to simulate (default: %s)\n", DEFAULT_ISA);
+  fprintf(stderr, "  --stats            Report executed instructions and MIPS at exit\n");
+  fprintf(stderr, "  --check-all        Always execute instructions with the full checks\n");
+}
+
+
+
+static int parse_size(const char *str, size_t *size)
+{
+  char *end;
+  unsigned long long value = strtoull(str, &end, 0);
+
+  switch (*end)
+  {
+    case 'k': case 'K': value <<= 10; end++; break;
+    case 'm': case 'M': value <<= 20; end++; break;
+    case 'g': case 'G': value <<= 30; end++; break;
+  }
+
+  if (end == str || *end != 0 || value == 0)
+    return -1;
+
+  *size = value;
+  return 0;
+}
+
+
+
+// Check that every extension of the ISA string is part of the decoder
+// generated at build time, as the ISS would otherwise silently ignore it
+static int check_isa(const char *isa)
+{
+  if (strncmp(isa, "rv32", 4) != 0)
+  {
+    fprintf(stderr, "Unsupported ISA %s: only rv32 is supported\n", isa);
+    return -1;
+  }
+
+  const char *current = isa + 4;
+  for (; *current && *current != 'X'; current++)
+  {
+    char name[2] = { *current, 0 };
+    if (!iss_decode_isa_exists(name))
+    {
+      fprintf(stderr, "Unsupported ISA %s: extension %s is not in the generated decoder\n", isa, name);
+      return -1;
+    }
+  }
+
+  char *tokens = strdup(current);
+  int err = 0;
+  for (char *token = strtok(tokens, "X"); token; token = strtok(NULL, "X"))
+  {
+    // faux only selects the auxiliary subsets of the other FP extensions
+    if (strcmp(token, "faux") != 0 && !iss_decode_isa_exists(token))
+    {
+      fprintf(stderr, "Unsupported ISA %s: extension X%s is not in the generated decoder\n", isa, token);
+      err = -1;
+      break;
+    }
+  }
+  free(tokens);
+
+  return err;
+}
+
+
+
+static double get_time()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
 
 
 
@@ -36,18 +119,71 @@ int main(int argc, char **argv)
 {
   iss_t *iss;
   iss_reg_t bootaddr;
+  size_t mem_size = MEMORY_SIZE;
+  const char *isa = DEFAULT_ISA;
+  bool stats = false;
+  bool check_all = false;
+
+  static struct option long_options[] = {
+    { "mem-size",  required_argument, 0, 'm' },
+    { "isa",       required_argument, 0, 'i' },
+    { "stats",     no_argument,       0, 's' },
+    { "check-all", no_argument,       0, 'c' },
+    { "help",      no_argument,       0, 'h' },
+    { 0, 0, 0, 0 }
+  };
+
+  // Stop at the first non-option so that the options after the binary are
+  // given to the simulated program
+  int opt;
+  while ((opt = getopt_long(argc, argv, "+m:i:sch", long_options, NULL)) != -1)
+  {
+    switch (opt)
+    {
+      case 'm':
+        if (parse_size(optarg, &mem_size))
+        {
+          fprintf(stderr, "Invalid memory size: %s\n", optarg);
+          return -1;
+        }
+        break;
+      case 'i': isa = optarg; break;
+      case 's': stats = true; break;
+      case 'c': check_all = true; break;
+      case 'h': usage(argv[0]); return 0;
+      default: usage(argv[0]); return -1;
+    }
+  }
+
+  if (optind >= argc)
+  {
+    usage(argv[0]);
+    return -1;
+  }
+
+  if (check_isa(isa))
+    return -1;
 
   iss = new iss_t;
 
   iss->fast_mode = 0;
-  iss->mem_size = MEMORY_SIZE;
-  iss->mem_array = (unsigned char *)malloc(MEMORY_SIZE);
-  if (iss->mem_array == NULL) return -1;
+  iss->hit_exit = 0;
+  iss->exit_status = 0;
+  iss->mem_size = mem_size;
+  iss->mem_array = (unsigned char *)calloc(1, mem_size);
+  if (iss->mem_array == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory (size: 0x%lx)\n", mem_size);
+    return -1;
+  }
 
-  if (load_binary(iss, argv[1], argc, argv, &bootaddr))
+  // The simulated program gets the binary as argv[0], followed by its own
+  // arguments
+  if (load_binary(iss, argv[optind], argc - optind, &argv[optind], &bootaddr))
     return -1;
 
-  iss->cpu.config.isa = strdup("rv32imcXpulpv2");
+  iss->cpu.config.isa = strdup(isa);
+  iss->cpu.config.shared_decode = false;
 
   if (iss_open(iss)) return -1;
 
@@ -55,41 +191,45 @@ int main(int argc, char **argv)
  
   iss_pc_set(iss, bootaddr);
 
-#ifdef FAST_LOOP
+  // The steps execute the current instruction and fetch the next one, so the
+  // one at the entry point must be fetched first, like the platform wrapper
+  // does when the core becomes active
+  prefetcher_fetch(iss, iss->cpu.current_insn);
 
-  // Experimental, not yet fully stable
+  uint64_t nb_insns = 0;
+  double start_time = get_time();
 
   do
   {
-    iss->fast_mode = iss_exec_switch_to_fast(iss);
+    iss->fast_mode = !check_all && iss_exec_switch_to_fast(iss);
 
     if (iss->fast_mode)
     {
-      // The fast mode is only executing instructions
-      // and can be used when there is no check to do
-      // like interupts, HW loops or performance
-      // counters
+      // The fast mode is only executing instructions and is used as long
+      // as there is no check to do like interrupts or performance counters.
+      // HW loops are handled by the instruction handlers themselves.
+      // Anything which may need a check (CSR write, mret, interrupt enable
+      // or exit) clears the fast mode so that we leave this loop.
       do
       {
         iss_exec_step(iss);
+        nb_insns++;
       } while(iss->fast_mode);
     }
     else
     {
-      // The full mode is checking everything. This could
-      // also always be called to simplify
+      // The full mode is checking everything
       iss_exec_step_check_all(iss);
+      nb_insns++;
     }
   } while (iss->hit_exit == 0);
 
-#else
-  
-  while (iss->hit_exit == 0)
+  if (stats)
   {
-    iss_exec_step_check_all(iss);
+    double duration = get_time() - start_time;
+    fprintf(stderr, "Executed %lu instructions in %.3f s (%.2f MIPS)\n", nb_insns, duration,
+      duration > 0 ? nb_insns / duration / 1000000.0 : 0.0);
   }
 
-#endif
-
   return iss->exit_status;
 }
@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#include "iss.hpp"
+#include <algorithm>
+
+
+void iss_debug_init(iss_t *iss)
+{
+  iss_debug_t *debug = &iss->cpu.debug;
+  debug->breakpoints.clear();
+  debug->watchpoints.clear();
+  debug->nb_breakpoints = 0;
+  debug->nb_watchpoints = 0;
+  debug->resume_insn = NULL;
+  debug->stop_reason = ISS_DEBUG_STOP_NONE;
+  debug->stop_addr = 0;
+}
+
+
+static iss_insn_t *iss_exec_insn_breakpoint(iss_t *iss, iss_insn_t *insn)
+{
+  iss_debug_t *debug = &iss->cpu.debug;
+
+  // The instruction is executed normally only when the core is resumed from
+  // this breakpoint, otherwise the core is stopped before executing it.
+  if (debug->resume_insn != insn)
+  {
+    iss_msg(iss, "Hit breakpoint (addr: 0x%lx)\n", insn->addr);
+    debug->resume_insn = insn;
+    debug->stop_reason = ISS_DEBUG_STOP_BREAKPOINT;
+    debug->stop_addr = insn->addr;
+    iss_debug_halt(iss);
+    return insn;
+  }
+
+  debug->resume_insn = NULL;
+
+  return iss_exec_insn_handler(iss, insn, insn->cold->breakpoint_handler);
+}
+
+
+static void iss_breakpoint_set(iss_t *iss, iss_insn_t *insn)
+{
+  if (insn->handler == iss_exec_insn_breakpoint)
+  {
+    return;
+  }
+
+  // The breakpoint handler is put on top of all the other ones, like the
+  // trace or the hardware loop handlers, so that they are kept untouched.
+  insn->cold->breakpoint_handler = insn->handler;
+  insn->cold->breakpoint_fast_handler = insn->fast_handler;
+
+  insn->handler = iss_exec_insn_breakpoint;
+  insn->fast_handler = iss_exec_insn_breakpoint;
+}
+
+
+static void iss_breakpoint_clear(iss_t *iss, iss_insn_t *insn)
+{
+  if (insn->handler == iss_exec_insn_breakpoint)
+  {
+    insn->handler = insn->cold->breakpoint_handler;
+    insn->fast_handler = insn->cold->breakpoint_fast_handler;
+  }
+  else if (insn->cold->hwloop_handler == iss_exec_insn_breakpoint)
+  {
+    // The instruction became a hardware loop end after the breakpoint was set,
+    // the breakpoint handler is then called by the hardware loop handler.
+    insn->cold->hwloop_handler = insn->cold->breakpoint_handler;
+  }
+
+  if (iss->cpu.debug.resume_insn == insn)
+  {
+    iss->cpu.debug.resume_insn = NULL;
+  }
+}
+
+
+// Called when an instruction is decoded, to set its breakpoint handler if it
+// is at the address of a breakpoint. Instructions which are not decoded yet
+// when the breakpoint is inserted get it this way.
+void iss_breakpoint_decode(iss_t *iss, iss_insn_t *insn)
+{
+  std::vector<iss_addr_t> &breakpoints = iss->cpu.debug.breakpoints;
+
+  if (std::find(breakpoints.begin(), breakpoints.end(), insn->addr) != breakpoints.end())
+  {
+    iss_breakpoint_set(iss, insn);
+  }
+}
+
+
+int iss_breakpoint_insert(iss_t *iss, iss_addr_t addr)
+{
+  iss_debug_t *debug = &iss->cpu.debug;
+
+  iss_msg(iss, "Inserting breakpoint (addr: 0x%lx)\n", addr);
+
+  if (std::find(debug->breakpoints.begin(), debug->breakpoints.end(), addr) != debug->breakpoints.end())
+  {
+    return 0;
+  }
+
+  debug->breakpoints.push_back(addr);
+  debug->nb_breakpoints = debug->breakpoints.size();
+
+  // Only already decoded instructions need to be patched, the other ones
+  // will get the breakpoint handler when they are decoded.
+  iss_insn_t *insn = insn_cache_get(iss, addr);
+  if (insn->handler != iss_decode_pc)
+  {
+    iss_breakpoint_set(iss, insn);
+  }
+
+  return 0;
+}
+
+
+int iss_breakpoint_remove(iss_t *iss, iss_addr_t addr)
+{
+  iss_debug_t *debug = &iss->cpu.debug;
+
+  iss_msg(iss, "Removing breakpoint (addr: 0x%lx)\n", addr);
+
+  auto it = std::find(debug->breakpoints.begin(), debug->breakpoints.end(), addr);
+  if (it == debug->breakpoints.end())
+  {
+    return -1;
+  }
+
+  debug->breakpoints.erase(it);
+  debug->nb_breakpoints = debug->breakpoints.size();
+
+  iss_breakpoint_clear(iss, insn_cache_get(iss, addr));
+
+  return 0;
+}
+
+
+int iss_watchpoint_insert(iss_t *iss, iss_watchpoint_type_e type, iss_addr_t addr, iss_addr_t size)
+{
+  iss_debug_t *debug = &iss->cpu.debug;
+
+  iss_msg(iss, "Inserting watchpoint (type: %d, addr: 0x%lx, size: 0x%lx)\n", type, addr, size);
+
+  iss_watchpoint_t watchpoint;
+  watchpoint.base = addr;
+  watchpoint.size = size;
+  watchpoint.type = type;
+
+  debug->watchpoints.push_back(watchpoint);
+  debug->nb_watchpoints = debug->watchpoints.size();
+
+  return 0;
+}
+
+
+int iss_watchpoint_remove(iss_t *iss, iss_watchpoint_type_e type, iss_addr_t addr, iss_addr_t size)
+{
+  iss_debug_t *debug = &iss->cpu.debug;
+
+  iss_msg(iss, "Removing watchpoint (type: %d, addr: 0x%lx, size: 0x%lx)\n", type, addr, size);
+
+  for (auto it = debug->watchpoints.begin(); it != debug->watchpoints.end(); it++)
+  {
+    if (it->base == addr && it->size == size && it->type == type)
+    {
+      debug->watchpoints.erase(it);
+      debug->nb_watchpoints = debug->watchpoints.size();
+      return 0;
+    }
+  }
+
+  return -1;
+}
+
+
+// Called for each data access when at least one watchpoint is set. The access
+// is completed and the core is stopped before the next instruction.
+void iss_watchpoint_check(iss_t *iss, iss_addr_t addr, int size, bool is_write)
+{
+  iss_debug_t *debug = &iss->cpu.debug;
+
+  for (iss_watchpoint_t &watchpoint: debug->watchpoints)
+  {
+    if (addr + size <= watchpoint.base || addr >= watchpoint.base + watchpoint.size)
+    {
+      continue;
+    }
+
+    if (!(watchpoint.type & (is_write ? ISS_WATCHPOINT_WRITE : ISS_WATCHPOINT_READ)))
+    {
+      continue;
+    }
+
+    iss_msg(iss, "Hit watchpoint (addr: 0x%lx, size: 0x%x, is_write: %d)\n", addr, size, is_write);
+
+    switch (watchpoint.type)
+    {
+      case ISS_WATCHPOINT_WRITE: debug->stop_reason = ISS_DEBUG_STOP_WATCH_WRITE; break;
+      case ISS_WATCHPOINT_READ: debug->stop_reason = ISS_DEBUG_STOP_WATCH_READ; break;
+      default: debug->stop_reason = ISS_DEBUG_STOP_WATCH_ACCESS; break;
+    }
+    debug->stop_addr = addr < watchpoint.base ? watchpoint.base : addr;
+
+    iss_debug_halt(iss);
+    return;
+  }
+}
@@ -21,6 +21,8 @@
 
 #include "iss.hpp"
 #include <string.h>
+#include <mutex>
+#include <map>
 
 extern iss_isa_tag_t __iss_isa_tags[];
 
@@ -62,48 +64,128 @@ static int decode_info(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
   return 0;
 }
 
-static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_decoder_item_t *item)
+// Decoded opcodes shared by the cores of this ISA which enabled shared decoding, with one
+// store per set of active instructions, since an opcode may not decode the same way
+// depending on them. As they can belong to different simulator instances running on
+// different threads, the stores are protected by a lock.
+static std::map<std::vector<bool>, iss_decoded_opcode_store_t *> shared_decoded_opcodes;
+static std::mutex shared_decoded_opcodes_mutex;
+
+static inline unsigned int decoded_opcode_hash(iss_decoded_opcode_store_t *store, iss_opcode_t opcode)
 {
-  if (!item->is_active) return -1;
+  return (unsigned int)(((uint64_t)opcode * 0x9E3779B97F4A7C15ULL) >> 32) & (store->nb_entries - 1);
+}
 
-  insn->latency = 0;
-  insn->fast_handler = item->u.insn.fast_handler;
-  insn->handler = item->u.insn.handler;
-  insn->resource_id = item->u.insn.resource_id;
-  insn->resource_latency = item->u.insn.resource_latency;
-  insn->resource_bandwidth = item->u.insn.resource_bandwidth;
+static void decoded_opcode_store_insert(iss_decoded_opcode_store_t *store, iss_decoded_opcode_t *entry)
+{
+  unsigned int index = decoded_opcode_hash(store, entry->opcode);
+  while (store->entries[index])
+  {
+    index = (index + 1) & (store->nb_entries - 1);
+  }
+  store->entries[index] = entry;
+}
+
+static void decoded_opcode_store_grow(iss_decoded_opcode_store_t *store)
+{
+  iss_decoded_opcode_t **entries = store->entries;
+  int nb_entries = store->nb_entries;
 
-  if (insn->hwloop_handler != NULL)
+  store->nb_entries = nb_entries * 2;
+  store->entries = (iss_decoded_opcode_t **)calloc(store->nb_entries, sizeof(iss_decoded_opcode_t *));
+
+  for (int i=0; i<nb_entries; i++)
   {
-      iss_insn_t *(*hwloop_handler)(iss_t *, iss_insn_t*) = insn->hwloop_handler;
-      insn->hwloop_handler = insn->handler;
-      insn->handler = hwloop_handler;
-      insn->fast_handler = hwloop_handler;
+    if (entries[i])
+    {
+      decoded_opcode_store_insert(store, entries[i]);
+    }
   }
 
-  if (item->u.insn.resource_id != -1)
+  free(entries);
+}
+
+static inline iss_decoded_opcode_t *decoded_opcode_get(iss_decoded_opcode_store_t *store, iss_opcode_t opcode)
+{
+  unsigned int index = decoded_opcode_hash(store, opcode);
+  iss_decoded_opcode_t *entry;
+
+  while ((entry = store->entries[index]) != NULL)
   {
-    insn->resource_handler = insn->handler;
-    insn->fast_handler = iss_resource_offload;
-    insn->handler = iss_resource_offload;
+    if (entry->opcode == opcode)
+    {
+      return entry;
+    }
+
+    index = (index + 1) & (store->nb_entries - 1);
   }
 
-  insn->decoder_item = item;
-  insn->size = item->u.insn.size;
-  insn->nb_out_reg = 0;
-  insn->nb_in_reg = 0;
-  insn->latency = item->u.insn.latency;
+  return NULL;
+}
 
-  for (int i=0; i<item->u.insn.nb_args; i++)
+static void decoded_opcode_add(iss_decoded_opcode_store_t *store, iss_decoded_opcode_t *entry)
+{
+  decoded_opcode_store_insert(store, entry);
+  store->nb_used++;
+  if (store->nb_used * 2 > store->nb_entries)
+  {
+    decoded_opcode_store_grow(store);
+  }
+}
+
+int iss_decoder_init(iss_t *iss)
+{
+  std::lock_guard<std::mutex> lock(shared_decoded_opcodes_mutex);
+
+  if (iss->cpu.config.shared_decode)
+  {
+    iss_decoded_opcode_store_t *&store = shared_decoded_opcodes[iss->cpu.active_insns];
+    if (store == NULL)
+    {
+      store = (iss_decoded_opcode_store_t *)calloc(1, sizeof(iss_decoded_opcode_store_t));
+    }
+    iss->cpu.decoded_opcodes = store;
+  }
+  else
+  {
+    iss->cpu.decoded_opcodes = (iss_decoded_opcode_store_t *)calloc(1, sizeof(iss_decoded_opcode_store_t));
+  }
+
+  iss_decoded_opcode_store_t *store = iss->cpu.decoded_opcodes;
+  if (store->entries == NULL)
+  {
+    store->nb_entries = ISS_DECODED_OPCODES_INIT;
+    store->nb_used = 0;
+    store->entries = (iss_decoded_opcode_t **)calloc(store->nb_entries, sizeof(iss_decoded_opcode_t *));
+  }
+
+  return 0;
+}
+
+// Decode what only depends on the opcode, and register it into the store so
+// that the other instructions with the same opcode reuse it.
+static iss_decoded_opcode_t *decode_opcode_entry(iss_t *iss, iss_opcode_t opcode, iss_decoder_item_t *item)
+{
+  iss_decoded_opcode_t *entry = (iss_decoded_opcode_t *)calloc(1, sizeof(iss_decoded_opcode_t));
+
+  entry->opcode = opcode;
+  entry->item = item;
+  entry->next_input_latency_reg = -1;
+
+  for (int i=0; i<ISS_MAX_NB_OUT_REGS; i++)
+  {
+    entry->out_regs[i] = -1;
+  }
+
+  for (int i=0; i<ISS_MAX_NB_IN_REGS; i++)
   {
-    insn->out_regs[i] = -1;
-    insn->in_regs[i] = -1;
+    entry->in_regs[i] = -1;
   }
 
   for (int i=0; i<item->u.insn.nb_args; i++)
   {
     iss_decoder_arg_t *darg = &item->u.insn.args[i];
-    iss_insn_arg_t *arg = &insn->args[i];
+    iss_insn_arg_t *arg = &entry->args[i];
     arg->type = darg->type;
     arg->flags = darg->flags;
 
@@ -111,7 +193,7 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
     {
       case ISS_DECODER_ARG_TYPE_IN_REG:
       case ISS_DECODER_ARG_TYPE_OUT_REG:
-        arg->u.reg.index = decode_info(iss, insn, opcode, &darg->u.reg.info, false);
+        arg->u.reg.index = decode_info(iss, NULL, opcode, &darg->u.reg.info, false);
         
         if (darg->flags & ISS_DECODER_ARG_FLAG_COMPRESSED)
           arg->u.reg.index += 8;
@@ -122,24 +204,22 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
 #endif
 
         if (darg->type == ISS_DECODER_ARG_TYPE_IN_REG) {
-          if (darg->u.reg.id >= insn->nb_in_reg)
-            insn->nb_in_reg = darg->u.reg.id + 1;
+          if (darg->u.reg.id >= entry->nb_in_reg)
+            entry->nb_in_reg = darg->u.reg.id + 1;
 
-          insn->in_regs[darg->u.reg.id] = arg->u.reg.index;
+          entry->in_regs[darg->u.reg.id] = arg->u.reg.index;
         }
         else {
-          if (darg->u.reg.id >= insn->nb_out_reg)
-            insn->nb_out_reg = darg->u.reg.id + 1;
+          if (darg->u.reg.id >= entry->nb_out_reg)
+            entry->nb_out_reg = darg->u.reg.id + 1;
 
-          insn->out_regs[darg->u.reg.id] = arg->u.reg.index;
+          entry->out_regs[darg->u.reg.id] = arg->u.reg.index;
         }
 
         if (darg->type == ISS_DECODER_ARG_TYPE_OUT_REG && darg->u.reg.latency != 0)
         {
-          iss_insn_t *next = insn_cache_get(iss, insn->addr + insn->size);
-
-          next->input_latency_reg = arg->u.reg.index;
-          next->input_latency = darg->u.reg.latency;
+          entry->next_input_latency_reg = arg->u.reg.index;
+          entry->next_input_latency = darg->u.reg.latency;
         }
 
 
@@ -147,42 +227,95 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
 
       case ISS_DECODER_ARG_TYPE_UIMM:
         arg->u.uim.value = decode_ranges(iss, opcode, &darg->u.uimm.info.u.range_set, darg->u.uimm.is_signed);
-        insn->uim[darg->u.uimm.id] = arg->u.uim.value;
+        entry->uim[darg->u.uimm.id] = arg->u.uim.value;
         break;
 
       case ISS_DECODER_ARG_TYPE_SIMM:
         arg->u.sim.value = decode_ranges(iss, opcode, &darg->u.simm.info.u.range_set, darg->u.simm.is_signed);
-        insn->sim[darg->u.simm.id] = arg->u.sim.value;
+        entry->sim[darg->u.simm.id] = arg->u.sim.value;
         break;
 
       case ISS_DECODER_ARG_TYPE_INDIRECT_IMM:
-        arg->u.indirect_imm.reg_index = decode_info(iss, insn, opcode, &darg->u.indirect_imm.reg.info, false);
+        arg->u.indirect_imm.reg_index = decode_info(iss, NULL, opcode, &darg->u.indirect_imm.reg.info, false);
         if (darg->u.indirect_imm.reg.flags & ISS_DECODER_ARG_FLAG_COMPRESSED) arg->u.indirect_imm.reg_index += 8;
-        insn->in_regs[darg->u.indirect_imm.reg.id] = arg->u.indirect_imm.reg_index;
-        if (darg->u.indirect_imm.reg.id >= insn->nb_in_reg)
-          insn->nb_in_reg = darg->u.indirect_imm.reg.id + 1;
-        arg->u.indirect_imm.imm = decode_info(iss, insn, opcode, &darg->u.indirect_imm.imm.info, darg->u.indirect_imm.imm.is_signed);
-        insn->sim[darg->u.indirect_imm.imm.id] = arg->u.indirect_imm.imm;
+        entry->in_regs[darg->u.indirect_imm.reg.id] = arg->u.indirect_imm.reg_index;
+        if (darg->u.indirect_imm.reg.id >= entry->nb_in_reg)
+          entry->nb_in_reg = darg->u.indirect_imm.reg.id + 1;
+        arg->u.indirect_imm.imm = decode_info(iss, NULL, opcode, &darg->u.indirect_imm.imm.info, darg->u.indirect_imm.imm.is_signed);
+        entry->sim[darg->u.indirect_imm.imm.id] = arg->u.indirect_imm.imm;
         break;
 
       case ISS_DECODER_ARG_TYPE_INDIRECT_REG:
-        arg->u.indirect_reg.base_reg_index = decode_info(iss, insn, opcode, &darg->u.indirect_reg.base_reg.info, false);
+        arg->u.indirect_reg.base_reg_index = decode_info(iss, NULL, opcode, &darg->u.indirect_reg.base_reg.info, false);
         if (darg->u.indirect_reg.base_reg.flags & ISS_DECODER_ARG_FLAG_COMPRESSED) arg->u.indirect_reg.base_reg_index += 8;
-        insn->in_regs[darg->u.indirect_reg.base_reg.id] = arg->u.indirect_reg.base_reg_index;
-        if (darg->u.indirect_reg.base_reg.id >= insn->nb_in_reg)
-          insn->nb_in_reg = darg->u.indirect_reg.base_reg.id + 1;
+        entry->in_regs[darg->u.indirect_reg.base_reg.id] = arg->u.indirect_reg.base_reg_index;
+        if (darg->u.indirect_reg.base_reg.id >= entry->nb_in_reg)
+          entry->nb_in_reg = darg->u.indirect_reg.base_reg.id + 1;
 
-        arg->u.indirect_reg.offset_reg_index = decode_info(iss, insn, opcode, &darg->u.indirect_reg.offset_reg.info, false);
+        arg->u.indirect_reg.offset_reg_index = decode_info(iss, NULL, opcode, &darg->u.indirect_reg.offset_reg.info, false);
         if (darg->u.indirect_reg.offset_reg.flags & ISS_DECODER_ARG_FLAG_COMPRESSED) arg->u.indirect_reg.offset_reg_index += 8;
-        insn->in_regs[darg->u.indirect_reg.offset_reg.id] = arg->u.indirect_reg.offset_reg_index;
-        if (darg->u.indirect_reg.offset_reg.id >= insn->nb_in_reg)
-          insn->nb_in_reg = darg->u.indirect_reg.offset_reg.id + 1;
+        entry->in_regs[darg->u.indirect_reg.offset_reg.id] = arg->u.indirect_reg.offset_reg_index;
+        if (darg->u.indirect_reg.offset_reg.id >= entry->nb_in_reg)
+          entry->nb_in_reg = darg->u.indirect_reg.offset_reg.id + 1;
 
         break;
     }
   }
 
-  if (insn->input_latency_reg != -1)
+  decoded_opcode_add(iss->cpu.decoded_opcodes, entry);
+
+  return entry;
+}
+
+// Fill the instruction from its decoded opcode, and set up what is specific to
+// this core and to this address, like handlers, stalls and hardware loops.
+static void decode_insn_apply(iss_t *iss, iss_insn_t *insn, iss_decoded_opcode_t *entry)
+{
+  iss_decoder_item_t *item = entry->item;
+
+  insn->latency = 0;
+  insn->fast_handler = item->u.insn.fast_handler;
+  insn->handler = item->u.insn.handler;
+  insn->cold->resource_id = item->u.insn.resource_id;
+  insn->cold->resource_latency = item->u.insn.resource_latency;
+  insn->cold->resource_bandwidth = item->u.insn.resource_bandwidth;
+
+  if (insn->cold->hwloop_handler != NULL)
+  {
+      iss_insn_t *(*hwloop_handler)(iss_t *, iss_insn_t*) = insn->cold->hwloop_handler;
+      insn->cold->hwloop_handler = insn->handler;
+      insn->handler = hwloop_handler;
+      insn->fast_handler = hwloop_handler;
+  }
+
+  if (item->u.insn.resource_id != -1)
+  {
+    insn->cold->resource_handler = insn->handler;
+    insn->fast_handler = iss_resource_offload;
+    insn->handler = iss_resource_offload;
+  }
+
+  insn->cold->decoder_item = item;
+  insn->size = item->u.insn.size;
+  insn->cold->nb_out_reg = entry->nb_out_reg;
+  insn->cold->nb_in_reg = entry->nb_in_reg;
+  insn->cold->args = entry->args;
+  insn->latency = item->u.insn.latency;
+
+  memcpy(insn->out_regs, entry->out_regs, sizeof(insn->out_regs));
+  memcpy(insn->in_regs, entry->in_regs, sizeof(insn->in_regs));
+  memcpy(insn->cold->uim, entry->uim, sizeof(insn->cold->uim));
+  memcpy(insn->cold->sim, entry->sim, sizeof(insn->cold->sim));
+
+  if (entry->next_input_latency_reg != -1)
+  {
+    iss_insn_t *next = insn_cache_get(iss, insn->addr + insn->size);
+
+    next->cold->input_latency_reg = entry->next_input_latency_reg;
+    next->cold->input_latency = entry->next_input_latency;
+  }
+
+  if (insn->cold->input_latency_reg != -1)
   {
     // We can stall the next instruction either if latency is superior
     // to 2 (due to number of pipeline stages) or if there is a data
@@ -192,20 +325,20 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
     // in case we find a register dependency so that we can properly
     // handle the stall
     bool set_pipe_latency = true;
-    for (int j=0; j<insn->nb_in_reg; j++)
+    for (int j=0; j<insn->cold->nb_in_reg; j++)
     {
-      if (insn->in_regs[j] == insn->input_latency_reg)
+      if (insn->in_regs[j] == insn->cold->input_latency_reg)
       {
-        insn->latency += insn->input_latency;
+        insn->latency += insn->cold->input_latency;
         set_pipe_latency = false;
         break;
       }
     }
 
     // If no dependency was found, apply the one for the pipeline stages
-    if (set_pipe_latency && insn->input_latency > PIPELINE_STAGES)
+    if (set_pipe_latency && insn->cold->input_latency > PIPELINE_STAGES)
     {
-      insn->latency += insn->input_latency - PIPELINE_STAGES + 1;
+      insn->latency += insn->cold->input_latency - PIPELINE_STAGES + 1;
     }
   }
 
@@ -218,11 +351,18 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
 
   if (insn->latency)
   {
-    insn->stall_handler = insn->handler;
-    insn->stall_fast_handler = insn->fast_handler;
+    insn->cold->stall_handler = insn->handler;
+    insn->cold->stall_fast_handler = insn->fast_handler;
     insn->handler = iss_exec_stalled_insn;
     insn->fast_handler = iss_exec_stalled_insn_fast;
   }
+}
+
+static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_decoder_item_t *item)
+{
+  if (!iss->cpu.active_insns[item->u.insn.id]) return -1;
+
+  decode_insn_apply(iss, insn, decode_opcode_entry(iss, opcode, item));
 
   return 0;
 }
@@ -232,6 +372,15 @@ static int decode_opcode_group(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode
   iss_opcode_t group_opcode = (opcode >> item->u.group.bit) & ((1ULL << item->u.group.width) - 1);
   iss_decoder_item_t *group_item_other = NULL;
 
+  // Small groups have a dispatch table generated with the ISA, which already takes care
+  // of the default sub-item
+  if (likely(item->u.group.table != NULL))
+  {
+    iss_decoder_item_t *group_item = item->u.group.table[group_opcode];
+    if (group_item == NULL) return -1;
+    return decode_item(iss, insn, opcode, group_item);
+  }
+
   for (int i=0; i<item->u.group.nb_groups; i++)
   {
     iss_decoder_item_t *group_item = item->u.group.groups[i];
@@ -269,6 +418,20 @@ static int decode_item(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
 
 static int decode_opcode(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode)
 {
+  std::unique_lock<std::mutex> lock(shared_decoded_opcodes_mutex, std::defer_lock);
+  if (iss->cpu.config.shared_decode)
+  {
+    lock.lock();
+  }
+
+  // The opcode may have already been decoded for another address or by another core
+  iss_decoded_opcode_t *entry = decoded_opcode_get(iss->cpu.decoded_opcodes, opcode);
+  if (likely(entry != NULL))
+  {
+    decode_insn_apply(iss, insn, entry);
+    return 0;
+  }
+
   for (int i=0; i<__iss_isa_set.nb_isa; i++)
   {
     iss_isa_t *isa = &__iss_isa_set.isa_set[i];
@@ -281,8 +444,12 @@ static int decode_opcode(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode)
 }
 
 
+// The ISA tags are activated per core, so that cores with different ISAs can be
+// simulated together
 void iss_decode_activate_isa(iss_t *cpu, char *name)
 {
+  cpu->cpu.active_insns.resize(__iss_isa_set.nb_insns);
+
   iss_isa_tag_t *isa = &__iss_isa_tags[0];
   while(isa->name)
   {
@@ -292,7 +459,7 @@ void iss_decode_activate_isa(iss_t *cpu, char *name)
       while(*insn_ptr)
       {
         iss_decoder_item_t *insn = *insn_ptr;
-        insn->is_active = true;
+        cpu->cpu.active_insns[insn->u.insn.id] = true;
         insn_ptr++;
       }
     }
@@ -301,6 +468,19 @@ void iss_decode_activate_isa(iss_t *cpu, char *name)
 }
 
 
+bool iss_decode_isa_exists(const char *name)
+{
+  iss_isa_tag_t *isa = &__iss_isa_tags[0];
+  while(isa->name)
+  {
+    if (strcmp(isa->name, name) == 0)
+      return true;
+    isa++;
+  }
+  return false;
+}
+
+
 static iss_insn_t *iss_exec_insn_illegal(iss_t *iss, iss_insn_t *insn)
 {
   iss_decoder_msg(iss, "Executing illegal instruction\n");
@@ -311,7 +491,7 @@ iss_insn_t *iss_decode_pc_noexec(iss_t *iss, iss_insn_t *insn)
 {
   iss_decoder_msg(iss, "Decoding instruction (pc: 0x%lx)\n", insn->addr);
 
-  iss_opcode_t opcode = insn->opcode;
+  iss_opcode_t opcode = insn->cold->opcode;
 
   iss_decoder_msg(iss, "Got opcode (opcode: 0x%lx)\n", opcode);
 
@@ -322,15 +502,20 @@ iss_insn_t *iss_decode_pc_noexec(iss_t *iss, iss_insn_t *insn)
     return insn;
   }
 
-  insn->opcode = opcode;
+  insn->cold->opcode = opcode;
 
   if (iss_insn_trace_active(iss) || iss_insn_event_active(iss))
   {
-    insn->saved_handler = insn->handler;
+    insn->cold->saved_handler = insn->handler;
     insn->handler = iss_exec_insn_with_trace;
     insn->fast_handler = iss_exec_insn_with_trace;
   }
 
+  if (unlikely(iss->cpu.debug.nb_breakpoints))
+  {
+    iss_breakpoint_decode(iss, insn);
+  }
+
   return insn;
 }
 
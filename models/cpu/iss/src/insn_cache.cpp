@@ -26,21 +26,48 @@
 static void insn_block_init(iss_insn_block_t *b, iss_addr_t pc);
 void insn_init(iss_insn_t *insn, iss_addr_t addr);
 
+static void insn_cache_insert(iss_insn_cache_t *cache, iss_insn_block_t *b)
+{
+  unsigned int index = insn_cache_hash(cache, b->pc);
+  while (cache->blocks[index])
+  {
+    index = (index + 1) & (cache->nb_blocks - 1);
+  }
+  cache->blocks[index] = b;
+}
+
+static void insn_cache_grow(iss_insn_cache_t *cache)
+{
+  iss_insn_block_t **blocks = cache->blocks;
+  int nb_blocks = cache->nb_blocks;
+
+  cache->nb_blocks = nb_blocks * 2;
+  cache->blocks = (iss_insn_block_t **)calloc(cache->nb_blocks, sizeof(iss_insn_block_t *));
+
+  for (int i=0; i<nb_blocks; i++)
+  {
+    if (blocks[i])
+    {
+      insn_cache_insert(cache, blocks[i]);
+    }
+  }
+
+  free(blocks);
+}
+
 static void flush_cache(iss_t *iss, iss_insn_cache_t *cache)
 {
   prefetcher_flush(iss);
 
-  for (int i=0; i<ISS_INSN_NB_BLOCKS; i++)
+  for (int i=0; i<cache->nb_blocks; i++)
   {
     // Each page already allocated should be kept since various code will not
     // fetch again the pointer after the flush.
     // Just make sure the instruction will be decoded again after the flush.
     iss_insn_block_t *b = cache->blocks[i];
-    while(b)
+    if (b)
     {
-      iss_insn_block_t *next = b->next;
       insn_block_init(b, b->pc);
-      b = next;
     }
  }
 }
@@ -49,7 +76,10 @@ static void flush_cache(iss_t *iss, iss_insn_cache_t *cache)
 int insn_cache_init(iss_t *iss)
 {
   iss_insn_cache_t *cache = &iss->cpu.insn_cache;
-  memset(cache->blocks, 0, sizeof(iss_insn_block_t *)*ISS_INSN_NB_BLOCKS);
+  cache->nb_blocks = ISS_INSN_NB_BLOCKS_INIT;
+  cache->nb_used = 0;
+  cache->blocks = (iss_insn_block_t **)calloc(cache->nb_blocks, sizeof(iss_insn_block_t *));
+  memset(cache->memo, 0, sizeof(cache->memo));
   return 0;
 }
 
@@ -58,17 +88,17 @@ void insn_init(iss_insn_t *insn, iss_addr_t addr) {
   insn->fast_handler = iss_decode_pc;
   insn->addr = addr;
   insn->next = NULL;
-  insn->hwloop_handler = NULL;
+  insn->cold->hwloop_handler = NULL;
   insn->fetched = false;
-  insn->input_latency_reg = -1;
+  insn->cold->input_latency_reg = -1;
 }
 
 static void insn_block_init(iss_insn_block_t *b, iss_addr_t pc)
 {
-  b->is_init = true;
   for (int i=0; i<ISS_INSN_BLOCK_SIZE; i++)
   {
     iss_insn_t *insn = &b->insns[i];
+    insn->cold = &b->cold[i];
     insn_init(insn, pc + (i<<ISS_INSN_PC_BITS));
   }
 }
@@ -86,7 +116,7 @@ void iss_cache_flush(iss_t *iss)
 
   if (iss->cpu.current_insn)
   {
-    opcode = iss->cpu.current_insn->opcode;
+    opcode = iss->cpu.current_insn->cold->opcode;
     current_addr = iss->cpu.current_insn->addr;
   }
 
@@ -120,7 +150,7 @@ void iss_cache_flush(iss_t *iss)
   if (iss->cpu.current_insn)
   {
     iss->cpu.current_insn = insn_cache_get(iss, current_addr);
-    iss->cpu.current_insn->opcode = opcode;
+    iss->cpu.current_insn->cold->opcode = opcode;
     iss->cpu.current_insn->fetched = true;
     iss_decode_pc_noexec(iss, iss->cpu.current_insn);
   }
@@ -161,39 +191,42 @@ iss_insn_t *insn_cache_get(iss_t *iss, iss_addr_t pc)
 {
   iss_addr_t pc_base = pc & ~((1 << (ISS_INSN_BLOCK_SIZE_LOG2 + ISS_INSN_PC_BITS)) - 1);
   unsigned insn_id = (pc >> ISS_INSN_PC_BITS) & (ISS_INSN_BLOCK_SIZE - 1);
-  unsigned int block_id = pc_base & (ISS_INSN_NB_BLOCKS - 1);
   iss_insn_cache_t *cache = &iss->cpu.insn_cache;
-  iss_insn_block_t *block = cache->blocks[block_id];
-  iss_insn_block_t *first_free = NULL;
 
-  while (block)
+  // Most of the time, we access one of the last accessed blocks, for example
+  // when jumping inside a loop or to a function called several times
+  unsigned int memo_id = (pc_base >> (ISS_INSN_BLOCK_SIZE_LOG2 + ISS_INSN_PC_BITS)) & (ISS_INSN_BLOCK_MEMO_SIZE - 1);
+  iss_insn_block_t *block = cache->memo[memo_id];
+  if (likely(block && block->pc == pc_base))
   {
-    if (block->is_init)
-    {
-      if (block->pc == pc_base)
-      {
-        return &block->insns[insn_id];
-      }
-    }
-    else
+    return &block->insns[insn_id];
+  }
+
+  unsigned int index = insn_cache_hash(cache, pc_base);
+
+  while ((block = cache->blocks[index]) != NULL)
+  {
+    if (block->pc == pc_base)
     {
-      first_free = block;
+      cache->memo[memo_id] = block;
+      return &block->insns[insn_id];
     }
 
-    block = block->next;
+    index = (index + 1) & (cache->nb_blocks - 1);
   }
 
-  iss_insn_block_t *b = first_free;
-  if (b == NULL)
+  iss_insn_block_t *b = (iss_insn_block_t *)malloc(sizeof(iss_insn_block_t));
+  b->pc = pc_base;
+  insn_block_init(b, pc_base);
+
+  cache->blocks[index] = b;
+  cache->nb_used++;
+  if (cache->nb_used * 2 > cache->nb_blocks)
   {
-    b = (iss_insn_block_t *)malloc(sizeof(iss_insn_block_t));
-    b->next = cache->blocks[block_id];
-    cache->blocks[block_id] = b;
+    insn_cache_grow(cache);
   }
 
-  b->pc = pc_base;
-  
-  insn_block_init(b, pc_base);
+  cache->memo[memo_id] = b;
 
   return &b->insns[insn_id];
 }
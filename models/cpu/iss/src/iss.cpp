@@ -284,6 +284,7 @@ int iss_open(iss_t *iss)
 
   if (iss_parse_isa(iss)) return -1;
 
+  iss_decoder_init(iss);
   insn_cache_init(iss);
   prefetcher_init(iss);
 
@@ -302,6 +303,7 @@ int iss_open(iss_t *iss)
   iss_resource_init(iss);
 
   iss_trace_init(iss);
+  iss_debug_init(iss);
 
   iss_init(iss);
 
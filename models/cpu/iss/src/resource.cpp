@@ -42,7 +42,7 @@ void iss_resource_init(iss_t *iss)
 iss_insn_t *iss_resource_offload(iss_t *iss, iss_insn_t *insn)
 {
     // First get the instance associated to this core for the resource associated to this instruction
-    iss_resource_instance_t *instance = iss->cpu.resources[insn->resource_id];
+    iss_resource_instance_t *instance = iss->cpu.resources[insn->cold->resource_id];
     int64_t cycles = 0;
 
     // Check if the instance is ready to accept an access
@@ -53,17 +53,17 @@ iss_insn_t *iss_resource_offload(iss_t *iss, iss_insn_t *insn)
         iss_pccr_account_event(iss, CSR_PCER_INSN_CONT, cycles);
 
         // And account the access on the instance. The time taken by the access is indicated by the instruction bandwidth
-        instance->cycles += insn->resource_bandwidth;
+        instance->cycles += insn->cold->resource_bandwidth;
     }
     else
     {
         // The instance is available, just account the time taken by the access, indicated by the instruction bandwidth
-        instance->cycles = iss->get_cycles() + insn->resource_bandwidth;
+        instance->cycles = iss->get_cycles() + insn->cold->resource_bandwidth;
     }
 
     // Account the latency of the resource on the core, as the result is available after the instruction latency
-    iss->cpu.state.insn_cycles += cycles + insn->resource_latency - 1;
+    iss->cpu.state.insn_cycles += cycles + insn->cold->resource_latency - 1;
 
     // Now that timing is modeled, execute the instruction
-    return insn->resource_handler(iss, insn);
+    return insn->cold->resource_handler(iss, insn);
 }
\ No newline at end of file
@@ -23,6 +23,7 @@
 #include <string.h>
 #include <algorithm>
 #include <vector>
+#include <mutex>
 
 #define PC_INFO_ARRAY_SIZE (64*1024)
 
@@ -38,6 +39,9 @@ public:
   iss_pc_info *next;
 };
 
+// Debug information is shared by all the cores of all the simulator instances of the
+// process, which can be built and run from different threads.
+static std::mutex pc_infos_mutex;
 static bool pc_infos_is_init = false;
 static iss_pc_info *pc_infos[PC_INFO_ARRAY_SIZE];
 static std::vector<std::string> binaries;
@@ -73,6 +77,8 @@ static iss_pc_info *get_pc_info(unsigned int base)
 
 int iss_trace_pc_info(iss_addr_t addr, const char **func, const char **inline_func, const char **file, int *line)
 {
+  std::lock_guard<std::mutex> lock(pc_infos_mutex);
+
   iss_pc_info *info = get_pc_info(addr);
   if (info == NULL)
     return -1;
@@ -87,6 +93,8 @@ int iss_trace_pc_info(iss_addr_t addr, const char **func, const char **inline_fu
 
 void iss_register_debug_info(iss_t *iss, const char *binary)
 {
+  std::lock_guard<std::mutex> lock(pc_infos_mutex);
+
   if (std::find(binaries.begin(), binaries.end(), std::string(binary)) != binaries.end())
     return;
 
@@ -110,6 +118,8 @@ void iss_register_debug_info(iss_t *iss, const char *binary)
       }
       if (index == 5) add_pc_info(strtol(tokens[0], NULL, 16), tokens[1], tokens[2], tokens[3], atoi(tokens[4]));
     }
+    free(line);
+    fclose(file);
   }
 }
 
@@ -309,8 +319,9 @@ static char *trace_dump_debug(iss_t *iss, iss_insn_t *insn, char *buff)
 static void iss_trace_dump_insn(iss_t *iss, iss_insn_t *insn, char *buff, int buffer_size, iss_insn_arg_t *saved_args, bool is_long, int mode, bool is_event) {
 
   char *init_buff = buff;
-  static int max_len = 20;
-  static int max_arg_len = 17;
+  // Column widths only grow to align the traces, each simulation thread has its own
+  static thread_local int max_len = 20;
+  static thread_local int max_arg_len = 17;
   int len;
 
   if (is_long) {
@@ -323,12 +334,12 @@ static void iss_trace_dump_insn(iss_t *iss, iss_insn_t *insn, char *buff, int bu
   }
 
   if (!is_long) {
-    buff += sprintf(buff,  "%" PRIxFULLREG " ", insn->opcode);
+    buff += sprintf(buff,  "%" PRIxFULLREG " ", insn->cold->opcode);
   }
 
   char *start_buff = buff;
 
-  buff += sprintf(buff,  "%s ", insn->decoder_item->u.insn.label);
+  buff += sprintf(buff,  "%s ", insn->cold->decoder_item->u.insn.label);
 
   if (is_long) {
     len = buff - start_buff;
@@ -343,9 +354,9 @@ static void iss_trace_dump_insn(iss_t *iss, iss_insn_t *insn, char *buff, int bu
 
   iss_decoder_arg_t *prev_arg = NULL;
   start_buff = buff;
-  int nb_args = insn->decoder_item->u.insn.nb_args;
+  int nb_args = insn->cold->decoder_item->u.insn.nb_args;
   for (int i=0; i<nb_args; i++) {
-    buff = iss_trace_dump_arg(iss, insn, buff, &insn->args[i], &insn->decoder_item->u.insn.args[i], &prev_arg, is_long);
+    buff = iss_trace_dump_arg(iss, insn, buff, &insn->cold->args[i], &insn->cold->decoder_item->u.insn.args[i], &prev_arg, is_long);
   }
   if (nb_args != 0) buff += sprintf(buff,  " ");
 
@@ -364,10 +375,10 @@ static void iss_trace_dump_insn(iss_t *iss, iss_insn_t *insn, char *buff, int bu
   {
     prev_arg = NULL;
     for (int i=0; i<nb_args; i++) {
-      buff = iss_trace_dump_arg_value(iss, insn, buff, &insn->args[i], &insn->decoder_item->u.insn.args[i], &saved_args[i], &prev_arg, 1, is_long);
+      buff = iss_trace_dump_arg_value(iss, insn, buff, &insn->cold->args[i], &insn->cold->decoder_item->u.insn.args[i], &saved_args[i], &prev_arg, 1, is_long);
     }
     for (int i=0; i<nb_args; i++) {
-      buff = iss_trace_dump_arg_value(iss, insn, buff, &insn->args[i], &insn->decoder_item->u.insn.args[i], &saved_args[i], &prev_arg, 0, is_long);
+      buff = iss_trace_dump_arg_value(iss, insn, buff, &insn->cold->args[i], &insn->cold->decoder_item->u.insn.args[i], &saved_args[i], &prev_arg, 0, is_long);
     }
 
     buff += sprintf(buff,  "\n");
@@ -414,9 +425,9 @@ static void iss_trace_save_arg(iss_t *iss, iss_insn_t *insn, iss_insn_arg_t *ins
 
 static void iss_trace_save_args(iss_t *iss, iss_insn_t *insn, iss_insn_arg_t saved_args[], bool save_out)
 {
-  for (int i=0; i<insn->decoder_item->u.insn.nb_args; i++) {
-    iss_decoder_arg_t *arg = &insn->decoder_item->u.insn.args[i];
-    iss_trace_save_arg(iss, insn, &insn->args[i], arg, &saved_args[i], save_out);
+  for (int i=0; i<insn->cold->decoder_item->u.insn.nb_args; i++) {
+    iss_decoder_arg_t *arg = &insn->cold->decoder_item->u.insn.args[i];
+    iss_trace_save_arg(iss, insn, &insn->cold->args[i], arg, &saved_args[i], save_out);
   }
 }
 
@@ -462,14 +473,14 @@ iss_insn_t *iss_exec_insn_with_trace(iss_t *iss, iss_insn_t *insn)
   {
     iss_trace_save_args(iss, insn, iss->cpu.state.saved_args, false);
     
-    next_insn = iss_exec_insn_handler(iss, insn, insn->saved_handler);
+    next_insn = iss_exec_insn_handler(iss, insn, insn->cold->saved_handler);
 
     if (!iss_exec_is_stalled(iss))
       iss_trace_dump(iss, insn);
   }
   else
   {
-    next_insn = iss_exec_insn_handler(iss, insn, insn->saved_handler);
+    next_insn = iss_exec_insn_handler(iss, insn, insn->cold->saved_handler);
   }
 
 
@@ -478,6 +489,8 @@ iss_insn_t *iss_exec_insn_with_trace(iss_t *iss, iss_insn_t *insn)
 
 void iss_trace_init(iss_t *iss)
 {
+  std::lock_guard<std::mutex> lock(pc_infos_mutex);
+
   if (!pc_infos_is_init)
   {
     pc_infos_is_init = true;
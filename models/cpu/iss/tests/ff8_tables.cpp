@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks every entry of the 8-bit minifloat lookup tables against flexfloat,
+ * for all operations, operands and rounding modes. The tables are first
+ * requested from several threads at the same time, like ISS instances running
+ * on different threads would do.
+ */
+
+#include <stdio.h>
+#include <thread>
+#include <vector>
+#include "types.hpp"
+#include "isa_lib/int.h"
+
+#define NB_THREADS 4
+
+static int nb_errors = 0;
+
+static void error(const char *op, int mode, unsigned int a, unsigned int b, unsigned int expected, unsigned int result)
+{
+  if (nb_errors++ < 16)
+  {
+    fprintf(stderr, "%s mode %d a=0x%x b=0x%x: expected 0x%x, got 0x%x\n", op, mode, a, b, expected, result);
+  }
+}
+
+static unsigned int flexfloat_binary(iss_cpu_state_t *s, lib_ff8_binary_op_e op, unsigned int a, unsigned int b, int mode)
+{
+  int old = setFFRoundingMode(s, mode);
+  unsigned int result = 0;
+  switch (op)
+  {
+    case LIB_FF8_ADD: result = lib_flexfloat_add(s, a, b, 5, 2); break;
+    case LIB_FF8_SUB: result = lib_flexfloat_sub(s, a, b, 5, 2); break;
+    case LIB_FF8_MUL: result = lib_flexfloat_mul(s, a, b, 5, 2); break;
+    case LIB_FF8_DIV: result = lib_flexfloat_div(s, a, b, 5, 2); break;
+    default: break;
+  }
+  restoreFFRoundingMode(old);
+  return result;
+}
+
+static unsigned int flexfloat_cvt(unsigned int a, uint8_t es, uint8_t ms, uint8_t ed, uint8_t md, int mode)
+{
+  iss_cpu_state_t state;
+  memset(&state, 0, sizeof(state));
+  int old = setFFRoundingMode(&state, mode);
+  FF_INIT_1(a, es, ms)
+  ff_cast(&ff_res, &ff_a, (flexfloat_desc_t) {ed,md});
+  restoreFFRoundingMode(old);
+  return flexfloat_get_bits(&ff_res);
+}
+
+static void check_binary()
+{
+  static const char *names[] = { "add", "sub", "mul", "div" };
+
+  for (int op=0; op<LIB_FF8_NB_BINARY_OPS; op++)
+  {
+    for (int mode=0; mode<LIB_FF8_NB_ROUNDING_MODES; mode++)
+    {
+      for (unsigned int a=0; a<256; a++)
+      {
+        for (unsigned int b=0; b<256; b++)
+        {
+          iss_cpu_state_t ref, state;
+          memset(&ref, 0, sizeof(ref));
+          memset(&state, 0, sizeof(state));
+
+          unsigned int expected = flexfloat_binary(&ref, (lib_ff8_binary_op_e)op, a, b, mode);
+          unsigned int result = 0;
+          if (!lib_ff8_binary(&state, (lib_ff8_binary_op_e)op, a, b, 5, 2, mode, &result) || result != expected)
+          {
+            error(names[op], mode, a, b, expected, result);
+          }
+          if (state.fcsr.fflags.raw != ref.fcsr.fflags.raw)
+          {
+            error(names[op], mode, a, b, ref.fcsr.fflags.raw, state.fcsr.fflags.raw);
+          }
+        }
+      }
+    }
+
+    // Vector lanes, checked with one lane holding the operand pair and the
+    // others zero, in round-to-nearest-even mode
+    for (unsigned int a=0; a<256; a++)
+    {
+      for (unsigned int b=0; b<256; b++)
+      {
+        for (int lane=0; lane<4; lane++)
+        {
+          iss_cpu_state_t ref, state;
+          memset(&ref, 0, sizeof(ref));
+          memset(&state, 0, sizeof(state));
+
+          unsigned int expected = 0;
+          for (int i=0; i<4; i++)
+          {
+            unsigned int lane_a = i == lane ? a : 0;
+            unsigned int lane_b = i == lane ? b : 0;
+            expected |= (flexfloat_binary(&ref, (lib_ff8_binary_op_e)op, lane_a, lane_b, 0) & 0xff) << (i * 8);
+          }
+
+          unsigned int result = lib_ff8_vec_binary(&state, (lib_ff8_binary_op_e)op, a << (lane * 8), b << (lane * 8), false);
+
+          if (result != expected || state.fcsr.fflags.raw != ref.fcsr.fflags.raw)
+          {
+            error(names[op], 0, a << (lane * 8), b << (lane * 8), expected, result);
+          }
+        }
+      }
+    }
+  }
+}
+
+static void check_cvt()
+{
+  for (int format=0; format<LIB_FF8_NB_FORMATS; format++)
+  {
+    uint8_t e, m;
+    lib_ff8_format_desc(format, &e, &m);
+
+    for (int mode=0; mode<LIB_FF8_NB_ROUNDING_MODES; mode++)
+    {
+      iss_cpu_state_t state;
+      memset(&state, 0, sizeof(state));
+
+      for (unsigned int a=0; a<256; a++)
+      {
+        unsigned int result = 0;
+        unsigned int expected = flexfloat_cvt(a, 5, 2, e, m, mode);
+        if (!lib_ff8_cvt(&state, a, 5, 2, e, m, mode, &result) || result != expected)
+        {
+          error("cvt from fp8", mode, a, format, expected, result);
+        }
+      }
+
+      if (format != LIB_FF8_FMT_FP16 && format != LIB_FF8_FMT_FP16ALT)
+      {
+        continue;
+      }
+
+      for (unsigned int a=0; a<(1 << 16); a++)
+      {
+        unsigned int result = 0;
+        unsigned int expected = flexfloat_cvt(a, e, m, 5, 2, mode);
+        if (!lib_ff8_cvt(&state, a, e, m, 5, 2, mode, &result) || result != expected)
+        {
+          error("cvt to fp8", mode, a, format, expected, result);
+        }
+      }
+    }
+  }
+}
+
+// Requests all tables, so that they are built concurrently by the threads
+static void get_tables(std::vector<void *> *tables)
+{
+  for (int mode=0; mode<LIB_FF8_NB_ROUNDING_MODES; mode++)
+  {
+    for (int op=0; op<LIB_FF8_NB_BINARY_OPS; op++)
+    {
+      tables->push_back(lib_ff8_binary_table((lib_ff8_binary_op_e)op, mode));
+    }
+    for (int format=0; format<LIB_FF8_NB_FORMATS; format++)
+    {
+      tables->push_back(lib_ff8_cvt_from_fp8_table(format, mode));
+      tables->push_back(lib_ff8_cvt_to_fp8_table(format, mode));
+    }
+  }
+}
+
+int main()
+{
+  std::vector<void *> tables[NB_THREADS];
+  std::vector<std::thread> threads;
+
+  for (int i=0; i<NB_THREADS; i++)
+  {
+    threads.push_back(std::thread(get_tables, &tables[i]));
+  }
+  for (std::thread &thread: threads)
+  {
+    thread.join();
+  }
+
+  for (int i=1; i<NB_THREADS; i++)
+  {
+    if (tables[i] != tables[0])
+    {
+      fprintf(stderr, "Tables were built several times\n");
+      return 1;
+    }
+  }
+
+  check_binary();
+  check_cvt();
+
+  if (nb_errors)
+  {
+    fprintf(stderr, "%d mismatches\n", nb_errors);
+    return 1;
+  }
+
+  printf("All FP8 table entries match flexfloat\n");
+  return 0;
+}
@@ -41,6 +41,13 @@ typedef struct
 } iss_wrapper_pcer_info_t;
 
 
+// Number of direct memory windows cached by the core
+#define ISS_DMI_NB_REGIONS 4
+// Granularity of the cache of addresses for which direct access was denied
+#define ISS_DMI_DENIED_PAGE_BITS 12
+#define ISS_DMI_NB_DENIED_PAGES 64
+
+
 class iss_wrapper : public vp::component, vp::Gdbserver_core
 {
 
@@ -52,6 +59,7 @@ public:
   void start();
   void pre_reset();
   void reset(bool active);
+  void checkpoint(vp::checkpoint *cp);
 
   virtual void target_open();
 
@@ -61,6 +69,8 @@ public:
   static void fetch_grant(void *_this, vp::io_req *req);
   static void fetch_response(void *_this, vp::io_req *req);
 
+  static void data_dmi_invalidate(void *_this);
+
   static void exec_instr(void *__this, vp::clock_event *event);
   static void exec_first_instr(void *__this, vp::clock_event *event);
   void exec_first_instr(vp::clock_event *event);
@@ -75,6 +85,10 @@ public:
   inline int data_req_aligned(iss_addr_t addr, uint8_t *data_ptr, int size, bool is_write);
   int data_misaligned_req(iss_addr_t addr, uint8_t *data_ptr, int size, bool is_write);
 
+  inline vp::io_dmi *data_dmi_get(iss_addr_t addr, int size);
+  vp::io_dmi *data_dmi_fill(iss_addr_t addr, int size);
+  void data_dmi_flush();
+
   bool user_access(iss_addr_t addr, uint8_t *data, iss_addr_t size, bool is_write);
   std::string read_user_string(iss_addr_t addr, int len=-1);
 
@@ -85,6 +99,7 @@ public:
   
   void set_halt_mode(bool halted, int cause);
   void check_state();
+  void debug_halt();
 
   void handle_ebreak();
   void handle_riscv_ebreak();
@@ -104,6 +119,11 @@ public:
   int gdbserver_cont();
   int gdbserver_stepi();
   int gdbserver_state();
+  int gdbserver_breakpoint_insert(uint64_t addr);
+  int gdbserver_breakpoint_remove(uint64_t addr);
+  int gdbserver_watchpoint_insert(bool is_write, bool is_read, uint64_t addr, int size);
+  int gdbserver_watchpoint_remove(bool is_write, bool is_read, uint64_t addr, int size);
+  int gdbserver_stop_reason(uint64_t *addr);
 
   void declare_pcer(int index, std::string name, std::string help);
 
@@ -123,6 +143,15 @@ public:
   vp::io_req     io_req;
   vp::io_req     fetch_req;
 
+  // Execute several instructions per clock event when nothing else is scheduled
+  bool           block_exec;
+
+  // Direct memory windows granted on the data port, used to bypass IO requests
+  bool           dmi_enabled;
+  vp::io_dmi     dmi_regions[ISS_DMI_NB_REGIONS];
+  int            dmi_next_region;
+  int64_t        dmi_denied_pages[ISS_DMI_NB_DENIED_PAGES];
+
   iss_cpu_t cpu;
 
   vp::trace     trace;
@@ -221,6 +250,7 @@ private:
   static void flush_cache_ack_sync(void *_this, bool active);
   static void halt_sync(void *_this, bool active);
   inline void enqueue_next_instr(int64_t cycles);
+  inline bool can_exec_next_instr(int64_t cycles);
   void halt_core();
 };
 
@@ -233,6 +263,15 @@ inline void iss_wrapper::enqueue_next_instr(int64_t cycles)
   }
 }
 
+// Tell if the next instruction can be executed directly from the current event
+// instead of enqueueing it, which requires that it would be executed by the
+// fast handler and that nothing else would be executed in-between.
+inline bool iss_wrapper::can_exec_next_instr(int64_t cycles)
+{
+  return !stalled.get() && !halted.get() && is_active_reg.get() && current_event != check_all_event &&
+    !current_event->is_enqueued() && get_clock()->can_skip_cycles(cycles);
+}
+
 void iss_wrapper::exec_misaligned(void *__this, vp::clock_event *event)
 {
   iss_wrapper *_this = (iss_wrapper *)__this;
@@ -257,9 +296,43 @@ void iss_wrapper::exec_misaligned(void *__this, vp::clock_event *event)
   }
 }
 
+inline vp::io_dmi *iss_wrapper::data_dmi_get(iss_addr_t addr, int size)
+{
+  for (int i=0; i<ISS_DMI_NB_REGIONS; i++)
+  {
+    vp::io_dmi *dmi = &this->dmi_regions[i];
+    if (likely(dmi->contains(addr, size)))
+    {
+      return dmi;
+    }
+  }
+
+  return this->data_dmi_fill(addr, size);
+}
+
 inline int iss_wrapper::data_req_aligned(iss_addr_t addr, uint8_t *data_ptr, int size, bool is_write)
 {
   decode_trace.msg("Data request (addr: 0x%lx, size: 0x%x, is_write: %d)\n", addr, size, is_write);
+
+  if (likely(this->dmi_enabled))
+  {
+    vp::io_dmi *dmi = this->data_dmi_get(addr, size);
+    if (likely(dmi != NULL))
+    {
+      uint8_t *host_addr = dmi->data + (addr - dmi->base);
+      if (is_write)
+        memcpy(host_addr, data_ptr, size);
+      else
+        memcpy(data_ptr, host_addr, size);
+
+      // The latency is also reported in the request as it is used for
+      // misaligned accesses
+      this->io_req.set_latency(dmi->latency);
+      this->cpu.state.insn_cycles += dmi->latency;
+      return vp::IO_REQ_OK;
+    }
+  }
+
   vp::io_req *req = &io_req;
   req->init();
   req->set_addr(addr);
@@ -282,6 +355,10 @@ inline int iss_wrapper::data_req_aligned(iss_addr_t addr, uint8_t *data_ptr, int
 
 inline int iss_wrapper::data_req(iss_addr_t addr, uint8_t *data_ptr, int size, bool is_write)
 {
+  if (unlikely(this->cpu.debug.nb_watchpoints))
+  {
+    iss_watchpoint_check(this, addr, size, is_write);
+  }
 
   iss_addr_t addr0 = addr & ADDR_MASK;
   iss_addr_t addr1 = (addr + size - 1) & ADDR_MASK;
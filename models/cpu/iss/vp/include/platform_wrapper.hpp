@@ -44,8 +44,8 @@ static inline void iss_handle_riscv_ebreak(iss_t *iss, iss_insn_t *insn)
 
 static inline void iss_pccr_incr(iss_t *iss, unsigned int event, int incr)
 {
-  static uint64_t zero = 0;
-  static uint64_t one = 1;
+  uint64_t zero = 0;
+  uint64_t one = 1;
   if (iss->pcer_trace_event[event].get_event_active())
   {
     // TODO this is incompatible with frequency scaling, this should be replaced by an event scheduled with cycles
@@ -79,6 +79,11 @@ static inline void iss_set_halt_mode(iss_t *iss, bool halted, int cause)
   iss->check_state();
 }
 
+static inline void iss_debug_halt(iss_t *iss)
+{
+  iss->debug_halt();
+}
+
 static inline void iss_wait_for_interrupt(iss_t *iss)
 {
   iss->wait_for_interrupt();
@@ -21,6 +21,7 @@
 
 #include <vp/vp.hpp>
 #include <vp/itf/io.hpp>
+#include <vp/checkpoint.hpp>
 #include "iss.hpp"
 #include <algorithm>
 #include <sys/types.h>
@@ -64,7 +65,7 @@ static inline void trdb_record_instruction(iss_wrapper *_this, iss_insn_t *insn)
   instr.valid = true;
   instr.exception = false;
   instr.iaddr = insn->addr;
-  instr.instr = insn->opcode;
+  instr.instr = insn->cold->opcode;
   instr.compressed = insn->size == 2;
   
   if (trdb_compress_trace_step(_this->trdb, &_this->trdb_packet_list, &instr))
@@ -86,7 +87,7 @@ static inline void trdb_record_instruction(iss_wrapper *_this, iss_insn_t *insn)
 #endif
 
 
-#define EXEC_INSTR_COMMON(_this, event, func) \
+#define EXEC_INSTR_STEP(_this, func, cycles) \
 do { \
   \
   _this->trace.msg("Executing instruction\n"); \
@@ -108,12 +109,16 @@ do { \
   } \
  \
   iss_insn_t *insn = _this->cpu.current_insn; \
-  int cycles = func(_this); \
+  cycles = func(_this); \
   if (_this->power.get_power_trace()->get_active()) \
   { \
-  _this->insn_groups_power[insn->decoder_item->u.insn.power_group].account_energy_quantum(); \
+  _this->insn_groups_power[insn->cold->decoder_item->u.insn.power_group].account_energy_quantum(); \
  } \
   trdb_record_instruction(_this, insn); \
+} while(0)
+
+#define EXEC_INSTR_ENQUEUE(_this, cycles) \
+do { \
   if (!_this->stalled.get()) \
   { \
     _this->enqueue_next_instr(cycles); \
@@ -131,6 +136,13 @@ do { \
   } \
 } while(0)
 
+#define EXEC_INSTR_COMMON(_this, event, func) \
+do { \
+  int cycles; \
+  EXEC_INSTR_STEP(_this, func, cycles); \
+  EXEC_INSTR_ENQUEUE(_this, cycles); \
+} while(0)
+
 void iss_wrapper::dump_debug_traces()
 {
   const char *func, *inline_func, *file;
@@ -148,8 +160,21 @@ void iss_wrapper::dump_debug_traces()
 void iss_wrapper::exec_instr(void *__this, vp::clock_event *event)
 {
   iss_t *_this = (iss_t *)__this;
+  int cycles;
+
+  EXEC_INSTR_STEP(_this, iss_exec_step_nofetch, cycles);
+
+  // Instead of going through the clock engine for each instruction, directly
+  // execute the next one as long as no other event would be executed before it.
+  // The clock engine is moved forward by the instruction cycles, so that the
+  // timing is exactly the same as with one event per instruction.
+  while (_this->block_exec && _this->can_exec_next_instr(cycles))
+  {
+    _this->get_clock()->skip_cycles(cycles);
+    EXEC_INSTR_STEP(_this, iss_exec_step_nofetch, cycles);
+  }
 
-  EXEC_INSTR_COMMON(_this, event, iss_exec_step_nofetch);
+  EXEC_INSTR_ENQUEUE(_this, cycles);
 }
 
 void iss_wrapper::exec_instr_check_all(void *__this, vp::clock_event *event)
@@ -219,6 +244,56 @@ void iss_wrapper::data_response(void *__this, vp::io_req *req)
   _this->check_state();
 }
 
+vp::io_dmi *iss_wrapper::data_dmi_fill(iss_addr_t addr, int size)
+{
+  // Slow path, called when no cached window covers the access.
+  // Addresses for which the window was denied are remembered per page so that
+  // accesses to peripherals do not pay for a DMI request everytime.
+  int64_t page = addr >> ISS_DMI_DENIED_PAGE_BITS;
+  int64_t *denied = &this->dmi_denied_pages[page & (ISS_DMI_NB_DENIED_PAGES - 1)];
+
+  if (*denied == page)
+    return NULL;
+
+  vp::io_dmi *dmi = &this->dmi_regions[this->dmi_next_region];
+
+  if (this->data.dmi_req(addr, dmi) != vp::IO_REQ_OK || dmi->data == NULL || !dmi->contains(addr, size))
+  {
+    dmi->init();
+    *denied = page;
+    return NULL;
+  }
+
+  this->trace.msg(vp::trace::LEVEL_DEBUG, "Got direct memory window (base: 0x%lx, size: 0x%lx, latency: %ld)\n",
+    dmi->base, dmi->size, dmi->latency);
+
+  this->dmi_next_region = (this->dmi_next_region + 1) & (ISS_DMI_NB_REGIONS - 1);
+
+  return dmi;
+}
+
+void iss_wrapper::data_dmi_flush()
+{
+  for (int i=0; i<ISS_DMI_NB_REGIONS; i++)
+  {
+    this->dmi_regions[i].init();
+  }
+
+  for (int i=0; i<ISS_DMI_NB_DENIED_PAGES; i++)
+  {
+    this->dmi_denied_pages[i] = -1;
+  }
+
+  this->dmi_next_region = 0;
+}
+
+void iss_wrapper::data_dmi_invalidate(void *__this)
+{
+  iss_t *_this = (iss_t *)__this;
+  _this->trace.msg(vp::trace::LEVEL_DEBUG, "Invalidating direct memory windows\n");
+  _this->data_dmi_flush();
+}
+
 void iss_wrapper::fetch_grant(void *_this, vp::io_req *req)
 {
 
@@ -394,6 +469,23 @@ void iss_wrapper::set_halt_mode(bool halted, int cause)
 
 
 
+void iss_wrapper::debug_halt()
+{
+  if (this->gdbserver)
+  {
+    this->halted.set(true);
+    this->gdbserver->signal(this);
+  }
+  else
+  {
+    this->set_halt_mode(true, HALT_CAUSE_HALT);
+  }
+
+  this->check_state();
+}
+
+
+
 void iss_wrapper::halt_core()
 {
   this->trace.msg("Halting core\n");
@@ -1388,6 +1480,7 @@ int iss_wrapper::build()
 
   data.set_resp_meth(&iss_wrapper::data_response);
   data.set_grant_meth(&iss_wrapper::data_grant);
+  data.set_dmi_invalidate_meth(&iss_wrapper::data_dmi_invalidate);
   new_master_port("data", &data);
 
   fetch.set_resp_meth(&iss_wrapper::fetch_response);
@@ -1446,6 +1539,8 @@ int iss_wrapper::build()
   //transform(isa.begin(), isa.end(), isa.begin(),(int (*)(int))tolower);
   this->cpu.config.isa = strdup(isa.c_str());
   this->cpu.config.debug_handler = this->get_js_config()->get_int("debug_handler");
+  js::config *shared_decode_config = this->get_js_config()->get("shared_decode");
+  this->cpu.config.shared_decode = shared_decode_config != NULL && shared_decode_config->get_bool();
 
   this->is_active_reg.set(false);
 
@@ -1454,6 +1549,13 @@ int iss_wrapper::build()
   this->ipc_stat_delay = 0;
   this->iss_opened = false;
 
+  js::config *dmi_config = this->get_js_config()->get("dmi");
+  this->dmi_enabled = dmi_config == NULL || dmi_config->get_bool();
+
+  js::config *block_exec_config = this->get_js_config()->get("block_exec");
+  this->block_exec = block_exec_config == NULL || block_exec_config->get_bool();
+  this->data_dmi_flush();
+
   return 0;
 }
 
@@ -1561,6 +1663,69 @@ void iss_wrapper::reset(bool active)
 }
 
 
+void iss_wrapper::checkpoint(vp::checkpoint *cp)
+{
+  // Only the architectural state is saved, the checkpoint is expected to be
+  // taken while the core is not in the middle of a stalled access.
+  iss_addr_t pc = this->cpu.current_insn ? this->cpu.current_insn->addr : 0;
+  bool hwloop_active[2];
+  for (int i=0; i<2; i++)
+  {
+    hwloop_active[i] = this->cpu.state.hwloop_end_insn[i] != NULL;
+  }
+  uint32_t current_event_id = std::find(this->events.begin(), this->events.end(), this->current_event) - this->events.begin();
+
+  cp->value(this->cpu.regfile);
+  cp->value(this->cpu.csr);
+  cp->value(this->cpu.pulpv2);
+  cp->value(this->cpu.state.fcsr);
+  cp->value(this->cpu.state.fprec);
+  cp->value(this->cpu.state.debug_mode);
+  cp->value(this->cpu.irq.irq_enable);
+  cp->value(this->cpu.irq.saved_irq_enable);
+  cp->value(this->cpu.irq.debug_saved_irq_enable);
+  cp->value(this->cpu.irq.vector_base);
+  cp->value(this->irq_req);
+  cp->value(pc);
+  cp->value(hwloop_active);
+  cp->value(current_event_id);
+
+  if (cp->is_restore())
+  {
+    if (current_event_id >= this->events.size())
+    {
+      throw std::runtime_error("Checkpoint does not match the platform (path: " + this->get_path() + ")");
+    }
+    this->current_event = this->events[current_event_id];
+
+    // The memory content has changed, all decoded instructions must be dropped
+    // before the pc, the vector table and the hardware loops are set again.
+    this->cpu.current_insn = NULL;
+    this->cpu.prev_insn = NULL;
+    this->cpu.stall_insn = NULL;
+    this->cpu.prefetch_insn = NULL;
+    for (int i=0; i<2; i++)
+    {
+      this->cpu.state.hwloop_start_insn[i] = NULL;
+      this->cpu.state.hwloop_end_insn[i] = NULL;
+    }
+
+    iss_cache_flush(this);
+    iss_pc_set(this, pc);
+
+    for (int i=0; i<2; i++)
+    {
+      if (hwloop_active[i])
+      {
+        hwloop_set_all(this, NULL, i, this->cpu.pulpv2.hwloop_regs[PULPV2_HWLOOP_LPSTART(i)],
+          this->cpu.pulpv2.hwloop_regs[PULPV2_HWLOOP_LPEND(i)],
+          this->cpu.pulpv2.hwloop_regs[PULPV2_HWLOOP_LPCOUNT(i)]);
+      }
+    }
+  }
+}
+
+
 iss_wrapper::iss_wrapper(js::config *config)
 : vp::component(config)
 {
@@ -1585,6 +1750,14 @@ int iss_wrapper::gdbserver_reg_set(int reg, uint8_t *value)
 
     if (reg == 32)
     {
+        // Resuming from somewhere else must not skip the breakpoint the core
+        // was stopped on
+        iss_insn_t *resume_insn = this->cpu.debug.resume_insn;
+        if (resume_insn && resume_insn->addr != *(uint32_t *)value)
+        {
+            this->cpu.debug.resume_insn = NULL;
+        }
+
         iss_pc_set(this, *(uint32_t *)value);
     }
     else
@@ -1648,6 +1821,7 @@ int iss_wrapper::gdbserver_stop()
 
 int iss_wrapper::gdbserver_cont()
 {
+    this->cpu.debug.stop_reason = ISS_DEBUG_STOP_NONE;
     this->halted.set(false);
     this->check_state();
 
@@ -1658,6 +1832,7 @@ int iss_wrapper::gdbserver_cont()
 int iss_wrapper::gdbserver_stepi()
 {
     fprintf(stderr, "STEP\n");
+    this->cpu.debug.stop_reason = ISS_DEBUG_STOP_NONE;
     this->step_mode.set(true);
     this->halted.set(false);
     this->check_state();
@@ -1671,6 +1846,60 @@ int iss_wrapper::gdbserver_state()
 }
 
 
+int iss_wrapper::gdbserver_breakpoint_insert(uint64_t addr)
+{
+    this->gdbserver_trace.msg(vp::trace::LEVEL_DEBUG, "Inserting breakpoint (addr: 0x%lx)\n", addr);
+    return iss_breakpoint_insert(this, addr);
+}
+
+
+int iss_wrapper::gdbserver_breakpoint_remove(uint64_t addr)
+{
+    this->gdbserver_trace.msg(vp::trace::LEVEL_DEBUG, "Removing breakpoint (addr: 0x%lx)\n", addr);
+    return iss_breakpoint_remove(this, addr);
+}
+
+
+static iss_watchpoint_type_e gdbserver_watchpoint_type(bool is_write, bool is_read)
+{
+    if (is_write && is_read)
+        return ISS_WATCHPOINT_ACCESS;
+    else if (is_write)
+        return ISS_WATCHPOINT_WRITE;
+    else
+        return ISS_WATCHPOINT_READ;
+}
+
+
+int iss_wrapper::gdbserver_watchpoint_insert(bool is_write, bool is_read, uint64_t addr, int size)
+{
+    this->gdbserver_trace.msg(vp::trace::LEVEL_DEBUG, "Inserting watchpoint (addr: 0x%lx, size: 0x%x, is_write: %d, is_read: %d)\n", addr, size, is_write, is_read);
+    return iss_watchpoint_insert(this, gdbserver_watchpoint_type(is_write, is_read), addr, size);
+}
+
+
+int iss_wrapper::gdbserver_watchpoint_remove(bool is_write, bool is_read, uint64_t addr, int size)
+{
+    this->gdbserver_trace.msg(vp::trace::LEVEL_DEBUG, "Removing watchpoint (addr: 0x%lx, size: 0x%x, is_write: %d, is_read: %d)\n", addr, size, is_write, is_read);
+    return iss_watchpoint_remove(this, gdbserver_watchpoint_type(is_write, is_read), addr, size);
+}
+
+
+int iss_wrapper::gdbserver_stop_reason(uint64_t *addr)
+{
+    *addr = this->cpu.debug.stop_addr;
+
+    switch (this->cpu.debug.stop_reason)
+    {
+        case ISS_DEBUG_STOP_BREAKPOINT: return vp::Gdbserver_core::stop_reason_breakpoint;
+        case ISS_DEBUG_STOP_WATCH_WRITE: return vp::Gdbserver_core::stop_reason_watch_write;
+        case ISS_DEBUG_STOP_WATCH_READ: return vp::Gdbserver_core::stop_reason_watch_read;
+        case ISS_DEBUG_STOP_WATCH_ACCESS: return vp::Gdbserver_core::stop_reason_watch_access;
+        default: return vp::Gdbserver_core::stop_reason_halt;
+    }
+}
+
+
 void iss_wrapper::declare_pcer(int index, std::string name, std::string help)
 {
     this->pcer_info[index].name = name;
@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Hyperbus master checking the burst mode of the hyperram or hyperflash
+ * against their pin-level mode. The same transactions are sent to two devices
+ * of the same kind, in burst mode to the one bound to the burst ports, and
+ * byte by byte to the one bound to the pins ports. The data read and the
+ * durations must be the same, and match the expected content of the device.
+ * For the flash, the transactions are the command sequences for programming,
+ * reading the status register and erasing a sector. It is driven by
+ * hyper_burst_test.py.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/hyper.hpp>
+#include <vp/itf/wire.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Number of bytes of the command-address phase
+#define HYPERBUS_CA_SIZE 6
+
+#define FLASH_SECTOR_SIZE (1<<18)
+
+class hyper_burst_test : public vp::component
+{
+
+public:
+  hyper_burst_test(js::config *config);
+
+  int build();
+  void reset(bool active);
+
+private:
+  static void handler(void *__this, vp::clock_event *event);
+  static void pins_sync_cycle(void *__this, int data);
+
+  int64_t transfer(vp::hyper_master *itf, vp::wire_master<bool> *cs_itf, vp::hyper_burst *burst, bool use_burst);
+  std::vector<uint8_t> access(uint32_t addr, int size, bool is_write, bool reg_access, const uint8_t *data);
+  void write(uint32_t addr, int size);
+  void read(uint32_t addr, int size, bool reg_access=false);
+  void flash_cmd(uint32_t addr, uint16_t cmd);
+  void check_ram();
+  void check_flash();
+
+  vp::trace trace;
+  vp::hyper_master burst_itf;
+  vp::wire_master<bool> burst_cs_itf;
+  vp::hyper_master pins_itf;
+  vp::wire_master<bool> pins_cs_itf;
+  vp::clock_event *event;
+
+  std::string device;
+
+  // Bytes received in pin-level mode
+  std::vector<uint8_t> rx_data;
+
+  // Expected content of the devices
+  std::vector<uint8_t> mem;
+  uint32_t seed;
+
+  int nb_transactions;
+  int nb_bursts;
+  int nb_errors;
+};
+
+hyper_burst_test::hyper_burst_test(js::config *config)
+: vp::component(config)
+{
+
+}
+
+void hyper_burst_test::pins_sync_cycle(void *__this, int data)
+{
+  hyper_burst_test *_this = (hyper_burst_test *)__this;
+  _this->rx_data.push_back(data);
+}
+
+// Sends the transaction in burst mode if asked and supported, and falls back to
+// pin-level mode otherwise. Returns the duration in bytes.
+int64_t hyper_burst_test::transfer(vp::hyper_master *itf, vp::wire_master<bool> *cs_itf, vp::hyper_burst *burst, bool use_burst)
+{
+  if (use_burst && itf->is_burst_capable() && itf->burst(burst))
+  {
+    this->nb_bursts++;
+    return burst->duration;
+  }
+
+  union
+  {
+    struct {
+      unsigned int low_addr:3;
+      unsigned int reserved:13;
+      unsigned int high_addr:29;
+      unsigned int burst_type:1;
+      unsigned int address_space:1;
+      unsigned int read:1;
+    } __attribute__((packed));;
+    uint8_t raw[6];
+  } ca;
+
+  memset(&ca, 0, sizeof(ca));
+  ca.low_addr = burst->addr & 0x7;
+  ca.high_addr = burst->addr >> 3;
+  ca.address_space = burst->reg_access;
+  ca.read = !burst->is_write;
+
+  this->rx_data.clear();
+
+  cs_itf->sync(true);
+
+  // The most significant byte of the command-address phase is sent first
+  for (int i=HYPERBUS_CA_SIZE-1; i>=0; i--)
+  {
+    itf->sync_cycle(ca.raw[i]);
+  }
+
+  for (int i=0; i<burst->size; i++)
+  {
+    itf->sync_cycle(burst->is_write ? burst->data[i] : 0);
+  }
+
+  cs_itf->sync(false);
+
+  if (!burst->is_write)
+  {
+    for (int i=0; i<burst->size; i++)
+    {
+      burst->data[i] = i < (int)this->rx_data.size() ? this->rx_data[i] : 0;
+    }
+  }
+
+  return HYPERBUS_CA_SIZE + burst->size;
+}
+
+// Sends the same transaction to both devices and checks that it took the same
+// duration and returned the same data. Returns the data read.
+std::vector<uint8_t> hyper_burst_test::access(uint32_t addr, int size, bool is_write, bool reg_access, const uint8_t *data)
+{
+  std::vector<uint8_t> burst_data(size);
+  std::vector<uint8_t> pins_data(size);
+
+  if (is_write)
+  {
+    memcpy(burst_data.data(), data, size);
+    memcpy(pins_data.data(), data, size);
+  }
+
+  vp::hyper_burst burst = { addr, size, burst_data.data(), is_write, reg_access, 0 };
+  vp::hyper_burst pins = { addr, size, pins_data.data(), is_write, reg_access, 0 };
+
+  int64_t burst_duration = this->transfer(&this->burst_itf, &this->burst_cs_itf, &burst, true);
+  int64_t pins_duration = this->transfer(&this->pins_itf, &this->pins_cs_itf, &pins, false);
+
+  this->nb_transactions++;
+
+  this->trace.msg(vp::trace::LEVEL_INFO, "Checked transaction (address: 0x%x, size: 0x%x, is_write: %d, duration: %ld)\n",
+    addr, size, is_write, pins_duration);
+
+  if (burst_duration != pins_duration)
+  {
+    printf("Duration mismatch (address: 0x%x, size: 0x%x, is_write: %d, burst: %ld, pin-level: %ld)\n",
+      addr, size, is_write, burst_duration, pins_duration);
+    this->nb_errors++;
+  }
+
+  if (burst_data != pins_data)
+  {
+    printf("Data mismatch between burst and pin-level modes (address: 0x%x, size: 0x%x)\n", addr, size);
+    this->nb_errors++;
+  }
+
+  return pins_data;
+}
+
+void hyper_burst_test::write(uint32_t addr, int size)
+{
+  std::vector<uint8_t> data(size);
+
+  for (int i=0; i<size; i++)
+  {
+    this->seed = this->seed * 1103515245 + 12345;
+    data[i] = this->seed >> 16;
+
+    // Flash programming can only clear bits
+    if (this->device == "flash")
+      this->mem[addr + i] &= data[i];
+    else
+      this->mem[addr + i] = data[i];
+  }
+
+  this->access(addr, size, true, false, data.data());
+}
+
+void hyper_burst_test::read(uint32_t addr, int size, bool reg_access)
+{
+  std::vector<uint8_t> data = this->access(addr, size, false, reg_access, NULL);
+
+  for (int i=0; i<size; i++)
+  {
+    if (data[i] != this->mem[addr + i])
+    {
+      printf("Data mismatch (address: 0x%x, expected: 0x%x, read: 0x%x)\n", addr + i, this->mem[addr + i], data[i]);
+      this->nb_errors++;
+      break;
+    }
+  }
+}
+
+// Flash commands are 16 bits writes, where the address is the word address
+void hyper_burst_test::flash_cmd(uint32_t addr, uint16_t cmd)
+{
+  uint8_t data[] = { (uint8_t)cmd, (uint8_t)(cmd >> 8) };
+  this->access(addr << 1, 2, true, false, data);
+}
+
+void hyper_burst_test::check_ram()
+{
+  this->write(0x100, 512);
+  this->read(0x0, 1024);
+  this->write(0x201, 3);
+  this->read(0x1f8, 16);
+
+  // The register space is not modeled and accesses the memory
+  this->read(0x10, 8, true);
+}
+
+void hyper_burst_test::check_flash()
+{
+  // Word programming
+  this->flash_cmd(0x555, 0xAA);
+  this->flash_cmd(0x2AA, 0x55);
+  this->flash_cmd(0x555, 0xA0);
+  this->write(0x400, 64);
+  this->read(0x3c0, 128);
+
+  // Status register, which reports that the device is ready
+  this->flash_cmd(0x555, 0x70);
+  std::vector<uint8_t> status = this->access(0, 2, false, false, NULL);
+  if (status[0] != 0x80 || status[1] != 0)
+  {
+    printf("Status register mismatch (expected: 0x80, read: 0x%x)\n", status[0] | (status[1] << 8));
+    this->nb_errors++;
+  }
+
+  // Sector erase
+  this->flash_cmd(0x555, 0xAA);
+  this->flash_cmd(0x2AA, 0x55);
+  this->flash_cmd(0x555, 0x80);
+  this->flash_cmd(0x555, 0xAA);
+  this->flash_cmd(0x2AA, 0x55);
+  this->flash_cmd(0x0, 0x30);
+  memset(this->mem.data(), 0xff, FLASH_SECTOR_SIZE);
+  this->read(0x3c0, 128);
+
+  // Programming again, at an odd address
+  this->flash_cmd(0x555, 0xAA);
+  this->flash_cmd(0x2AA, 0x55);
+  this->flash_cmd(0x555, 0xA0);
+  this->write(0x401, 5);
+  this->read(0x400, 8);
+}
+
+void hyper_burst_test::handler(void *__this, vp::clock_event *event)
+{
+  hyper_burst_test *_this = (hyper_burst_test *)__this;
+
+  if (_this->device == "flash")
+    _this->check_flash();
+  else
+    _this->check_ram();
+
+  printf("Checked %d %s transactions, %d in burst mode, %d errors\n",
+    _this->nb_transactions, _this->device.c_str(), _this->nb_bursts, _this->nb_errors);
+
+  // Keep an event pending, otherwise the engine may see that it ran out of
+  // events before handling the stop request, and report a failure
+  _this->event_enqueue(_this->event, 1);
+  _this->get_clock()->stop_engine(_this->nb_errors != 0 || _this->nb_bursts == 0);
+}
+
+int hyper_burst_test::build()
+{
+  traces.new_trace("trace", &trace, vp::DEBUG);
+
+  // Both ports may be used in pin-level mode
+  this->burst_itf.set_sync_cycle_meth(&hyper_burst_test::pins_sync_cycle);
+  this->pins_itf.set_sync_cycle_meth(&hyper_burst_test::pins_sync_cycle);
+
+  new_master_port("burst", &this->burst_itf);
+  new_master_port("burst_cs", &this->burst_cs_itf);
+  new_master_port("pins", &this->pins_itf);
+  new_master_port("pins_cs", &this->pins_cs_itf);
+
+  this->event = this->event_new(hyper_burst_test::handler);
+
+  this->device = this->get_js_config()->get_child_str("device");
+
+  // The devices are erased when they are built
+  this->mem.resize(this->get_js_config()->get_child_int("size"), 0xff);
+  this->seed = 1;
+
+  this->nb_transactions = 0;
+  this->nb_bursts = 0;
+  this->nb_errors = 0;
+
+  return 0;
+}
+
+void hyper_burst_test::reset(bool active)
+{
+  if (!active)
+  {
+    this->event_enqueue(this->event, 1);
+  }
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+  return new hyper_burst_test(config);
+}
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2021 GreenWaves Technologies, SAS
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Checks the burst mode of devices.hyperbus.hyperram_impl and
+# devices.hyperbus.hyperflash_impl. For each device, a system made of the
+# devices.hyperbus.hyper_burst_test hyperbus master and two devices, one
+# accessed in burst mode and one in pin-level mode, is simulated with
+# gvsoc_launcher, which fails if any transaction differs between both modes.
+#
+# Example:
+#   GVSOC_PATH=<install>/models ./hyper_burst_test.py
+#
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+devices = {
+    'ram': 'devices.hyperbus.hyperram_impl',
+    'flash': 'devices.hyperbus.hyperflash_impl'
+}
+
+
+def get_config(device, size):
+
+    target = {'vp_component': devices[device], 'size': size}
+
+    return {
+        'gvsoc': {
+            'sa-mode': True,
+            'traces': {'level': 'info', 'include_regex': [], 'format': 'long'},
+            'events': {'include_regex': [], 'include_raw': []}
+        },
+        'target': {
+            'vp_component': 'utils.composite_impl',
+            'clock': {'vp_component': 'vp.clock_domain_impl', 'frequency': 100000000},
+            'test': {'vp_component': 'devices.hyperbus.hyper_burst_test', 'device': device, 'size': size},
+            'burst_device': target,
+            'pins_device': target,
+            'components': ['clock', 'test', 'burst_device', 'pins_device'],
+            'bindings': [
+                ['clock->out', 'test->clock'],
+                ['clock->out', 'burst_device->clock'],
+                ['clock->out', 'pins_device->clock'],
+                ['test->burst', 'burst_device->input'],
+                ['test->burst_cs', 'burst_device->cs'],
+                ['test->pins', 'pins_device->input'],
+                ['test->pins_cs', 'pins_device->cs']
+            ]
+        }
+    }
+
+
+parser = argparse.ArgumentParser(description='Check the hyperbus devices burst mode')
+
+parser.add_argument("--launcher", dest="launcher", default="gvsoc_launcher",
+    help="Path to gvsoc_launcher")
+parser.add_argument("--devices", dest="devices", nargs='+', default=list(devices.keys()),
+    choices=list(devices.keys()), help="Devices to check")
+parser.add_argument("--size", dest="size", type=int, default=1<<20,
+    help="Size of the devices")
+
+args = parser.parse_args()
+
+with tempfile.TemporaryDirectory() as tmpdir:
+    for device in args.devices:
+        config_path = os.path.join(tmpdir, 'hyper_burst_test_%s.json' % device)
+        with open(config_path, 'w') as file:
+            json.dump(get_config(device, args.size), file, indent=2)
+
+        if subprocess.run([args.launcher, '--config=' + config_path]).returncode != 0:
+            sys.exit('Hyperbus burst test failed with the %s' % device)
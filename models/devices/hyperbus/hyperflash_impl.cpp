@@ -34,6 +34,9 @@
 
 #define REGS_AREA_SIZE 1024
 
+// Number of bytes of the command-address phase
+#define HYPERBUS_CA_SIZE 6
+
 #define FLASH_STATE_IDLE 0
 #define FLASH_STATE_WRITE_BUFFER_WAIT_SIZE 1
 #define FLASH_STATE_WRITE_BUFFER 2
@@ -81,6 +84,7 @@ public:
 
   static void sync_cycle(void *_this, int data);
   static void cs_sync(void *__this, bool value);
+  static bool burst(void *__this, vp::hyper_burst *burst);
 
   int get_nb_word() {return nb_word;}
 
@@ -119,6 +123,10 @@ protected:
   bool burst_write = false;
   int nb_word = -1;
   int sector;
+
+  // When a burst is received, where the byte being read must be stored, instead
+  // of being sent to the interface
+  uint8_t *burst_read_data = NULL;
 };
 
 
@@ -180,7 +188,15 @@ void Hyperflash::handle_access(int reg_access, int address, int read, uint8_t da
         data = this->data[address];
         this->trace.msg(vp::trace::LEVEL_TRACE, "Sending data byte (address: 0x%x, value: 0x%x)\n", address, data);
       }
-      this->in_itf.sync_cycle(data);
+
+      if (this->burst_read_data)
+      {
+        *this->burst_read_data = data;
+      }
+      else
+      {
+        this->in_itf.sync_cycle(data);
+      }
     }
     else
     {
@@ -462,7 +478,7 @@ void Hyperflash::cs_sync(void *__this, bool value)
   _this->trace.msg(vp::trace::LEVEL_TRACE, "Received CS sync (value: %d)\n", value);
 
   _this->hyper_state = HYPERBUS_STATE_CA;
-  _this->ca_count = 6;
+  _this->ca_count = HYPERBUS_CA_SIZE;
 
   if (value == 0)
   {
@@ -486,11 +502,52 @@ void Hyperflash::cs_sync(void *__this, bool value)
   }
 }
 
+bool Hyperflash::burst(void *__this, vp::hyper_burst *burst)
+{
+  Hyperflash *_this = (Hyperflash *)__this;
+
+  _this->trace.msg(vp::trace::LEVEL_TRACE, "Received burst (reg_access: %d, addr: 0x%x, size: 0x%x, is_write: %d)\n", burst->reg_access, burst->addr, burst->size, burst->is_write);
+
+  burst->duration = HYPERBUS_CA_SIZE + burst->size;
+
+  // The burst goes through the same steps as a pin-level transaction, chip select
+  // assertion, data phase and chip select deassertion, so that the command
+  // sequences can mix both modes.
+  Hyperflash::cs_sync(_this, 1);
+
+  _this->hyper_state = HYPERBUS_STATE_DATA;
+  _this->current_address = burst->addr;
+  _this->reg_access = burst->reg_access;
+  _this->ca.read = !burst->is_write;
+
+  if (!burst->is_write && _this->state != HYPERFLASH_STATE_GET_STATUS_REG &&
+    (uint64_t)burst->addr + burst->size <= (uint64_t)_this->size)
+  {
+    // Plain array read, which is the common case, e.g. for XIP
+    memcpy(burst->data, &_this->data[burst->addr], burst->size);
+  }
+  else
+  {
+    for (int i=0; i<burst->size; i++)
+    {
+      _this->burst_read_data = burst->is_write ? NULL : &burst->data[i];
+      _this->handle_access(_this->reg_access, _this->current_address, _this->ca.read, burst->is_write ? burst->data[i] : 0);
+      _this->current_address++;
+    }
+    _this->burst_read_data = NULL;
+  }
+
+  Hyperflash::cs_sync(_this, 0);
+
+  return true;
+}
+
 int Hyperflash::build()
 {
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   in_itf.set_sync_cycle_meth(&Hyperflash::sync_cycle);
+  in_itf.set_burst_meth(&Hyperflash::burst);
   new_slave_port("input", &in_itf);
 
   cs_itf.set_sync_meth(&Hyperflash::cs_sync);
@@ -31,9 +31,13 @@
 
 #include <vp/itf/hyper.hpp>
 #include <vp/itf/wire.hpp>
+#include <vp/checkpoint.hpp>
 
 #define REGS_AREA_SIZE 1024
 
+// Number of bytes of the command-address phase
+#define HYPERBUS_CA_SIZE 6
+
 
 
 typedef enum
@@ -52,9 +56,11 @@ public:
   void handle_access(int reg_access, int address, int read, uint8_t data);
 
   int build();
+  void checkpoint(vp::checkpoint *cp);
 
   static void sync_cycle(void *_this, int data);
   static void cs_sync(void *__this, bool value);
+  static bool burst(void *__this, vp::hyper_burst *burst);
 
 protected:
   vp::trace     trace;
@@ -155,7 +161,38 @@ void Hyperram::cs_sync(void *__this, bool value)
   _this->trace.msg(vp::trace::LEVEL_TRACE, "Received CS sync (value: %d)\n", value);
 
   _this->state = HYPERBUS_STATE_CA;
-  _this->ca_count = 6;
+  _this->ca_count = HYPERBUS_CA_SIZE;
+}
+
+bool Hyperram::burst(void *__this, vp::hyper_burst *burst)
+{
+  Hyperram *_this = (Hyperram *)__this;
+
+  _this->trace.msg(vp::trace::LEVEL_TRACE, "Received burst (reg_access: %d, addr: 0x%x, size: 0x%x, is_write: %d)\n", burst->reg_access, burst->addr, burst->size, burst->is_write);
+
+  burst->duration = HYPERBUS_CA_SIZE + burst->size;
+
+  // Like in pin-level mode, the bytes which are out of the memory are dropped
+  int size = burst->size;
+  if ((uint64_t)burst->addr + size > (uint64_t)_this->size)
+  {
+    _this->warning.force_warning("Received out-of-bound request (addr: 0x%x, ram_size: 0x%x)\n", burst->addr, _this->size);
+    size = burst->addr >= (uint32_t)_this->size ? 0 : _this->size - burst->addr;
+  }
+
+  if (burst->is_write)
+  {
+    memcpy(&_this->data[burst->addr], burst->data, size);
+  }
+  else
+  {
+    memcpy(burst->data, &_this->data[burst->addr], size);
+  }
+
+  _this->state = HYPERBUS_STATE_CA;
+  _this->ca_count = HYPERBUS_CA_SIZE;
+
+  return true;
 }
 
 int Hyperram::build()
@@ -163,6 +200,7 @@ int Hyperram::build()
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   in_itf.set_sync_cycle_meth(&Hyperram::sync_cycle);
+  in_itf.set_burst_meth(&Hyperram::burst);
   new_slave_port("input", &in_itf);
 
   cs_itf.set_sync_meth(&Hyperram::cs_sync);
@@ -184,6 +222,14 @@ int Hyperram::build()
 
 
 
+void Hyperram::checkpoint(vp::checkpoint *cp)
+{
+  cp->pages(this->data, this->size);
+  cp->data(this->reg_data, REGS_AREA_SIZE);
+}
+
+
+
 extern "C" vp::component *vp_constructor(js::config *config)
 {
   return new Hyperram(config);
@@ -0,0 +1,376 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DEVICES_SOUND_AUDIO_STREAM_HPP__
+#define __DEVICES_SOUND_AUDIO_STREAM_HPP__
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/*
+ * Helpers for the audio models streaming samples from or to files.
+ *
+ * Samples are read and written by blocks into 2 buffers, so that the bit-level
+ * models get them from memory. The files can be accessed from a helper thread,
+ * which fills or flushes one buffer while the model is using the other one.
+ */
+
+#define AUDIO_STREAM_DEFAULT_BLOCK_SIZE 4096
+
+
+// Stream of samples read from a file by blocks. The fill callback is called to
+// read up to the given number of samples and returns the number of samples read,
+// 0 meaning the end of the stream.
+class Audio_stream_reader
+{
+public:
+    Audio_stream_reader(std::function<int64_t(int32_t *, int64_t)> fill,
+        int64_t block_size=AUDIO_STREAM_DEFAULT_BLOCK_SIZE, bool use_thread=false)
+        : fill(fill), block_size(block_size), use_thread(use_thread)
+    {
+        for (int i=0; i<2; i++)
+        {
+            this->buffers[i].resize(block_size);
+            this->count[i] = 0;
+            this->ready[i] = false;
+        }
+
+        if (use_thread)
+        {
+            this->thread = new std::thread(&Audio_stream_reader::thread_routine, this);
+        }
+    }
+
+    ~Audio_stream_reader()
+    {
+        if (this->thread)
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->stop = true;
+            this->cond.notify_all();
+            lock.unlock();
+
+            this->thread->join();
+            delete this->thread;
+        }
+    }
+
+    // Get the next sample, returns false at the end of the stream
+    inline bool pop(int32_t *sample)
+    {
+        if (this->pos == this->count[this->current] && !this->next_buffer())
+        {
+            return false;
+        }
+
+        *sample = this->buffers[this->current][this->pos++];
+        return true;
+    }
+
+private:
+    bool next_buffer()
+    {
+        if (this->eof)
+        {
+            return false;
+        }
+
+        if (this->use_thread)
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+
+            // Give the buffer back to the thread and take the other one
+            if (this->started)
+            {
+                this->ready[this->current] = false;
+                this->current ^= 1;
+                this->cond.notify_all();
+            }
+            this->started = true;
+
+            while (!this->ready[this->current])
+            {
+                this->cond.wait(lock);
+            }
+        }
+        else
+        {
+            this->count[this->current] = this->fill(this->buffers[this->current].data(), this->block_size);
+        }
+
+        this->pos = 0;
+        this->eof = this->count[this->current] == 0;
+
+        return !this->eof;
+    }
+
+    void thread_routine()
+    {
+        int index = 0;
+
+        while (1)
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            while (this->ready[index] && !this->stop)
+            {
+                this->cond.wait(lock);
+            }
+
+            if (this->stop)
+            {
+                break;
+            }
+            lock.unlock();
+
+            int64_t count = this->fill(this->buffers[index].data(), this->block_size);
+
+            lock.lock();
+            this->count[index] = count;
+            this->ready[index] = true;
+            this->cond.notify_all();
+
+            if (count == 0)
+            {
+                break;
+            }
+
+            index ^= 1;
+        }
+    }
+
+    std::function<int64_t(int32_t *, int64_t)> fill;
+    int64_t block_size;
+    bool use_thread;
+
+    std::vector<int32_t> buffers[2];
+    int64_t count[2];
+    bool ready[2];
+    int current = 0;
+    int64_t pos = 0;
+    bool started = false;
+    bool eof = false;
+
+    std::thread *thread = NULL;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool stop = false;
+};
+
+
+// Stream of samples written to a file by blocks. The flush callback is called
+// with each full block, and with the remaining samples when the stream is flushed
+// or destroyed.
+class Audio_stream_writer
+{
+public:
+    Audio_stream_writer(std::function<void(int32_t *, int64_t)> flush_block,
+        int64_t block_size=AUDIO_STREAM_DEFAULT_BLOCK_SIZE, bool use_thread=false)
+        : flush_block(flush_block), block_size(block_size), use_thread(use_thread)
+    {
+        for (int i=0; i<2; i++)
+        {
+            this->buffers[i].resize(block_size);
+            this->pending_count[i] = 0;
+            this->pending[i] = false;
+        }
+
+        if (use_thread)
+        {
+            this->thread = new std::thread(&Audio_stream_writer::thread_routine, this);
+        }
+    }
+
+    ~Audio_stream_writer()
+    {
+        this->flush();
+
+        if (this->thread)
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->stop = true;
+            this->cond.notify_all();
+            lock.unlock();
+
+            this->thread->join();
+            delete this->thread;
+        }
+    }
+
+    inline void push(int32_t sample)
+    {
+        this->buffers[this->current][this->count++] = sample;
+
+        if (this->count == this->block_size)
+        {
+            this->switch_buffer();
+        }
+    }
+
+    // Write all the samples pushed so far to the file
+    void flush()
+    {
+        if (this->count)
+        {
+            this->switch_buffer();
+        }
+
+        if (this->thread)
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            while (this->pending[0] || this->pending[1])
+            {
+                this->cond.wait(lock);
+            }
+        }
+    }
+
+private:
+    void switch_buffer()
+    {
+        if (this->use_thread)
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+
+            this->pending_count[this->current] = this->count;
+            this->pending[this->current] = true;
+            this->cond.notify_all();
+
+            // The other buffer may still be flushed by the thread
+            this->current ^= 1;
+            while (this->pending[this->current])
+            {
+                this->cond.wait(lock);
+            }
+        }
+        else
+        {
+            this->flush_block(this->buffers[this->current].data(), this->count);
+        }
+
+        this->count = 0;
+    }
+
+    void thread_routine()
+    {
+        int index = 0;
+
+        while (1)
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            while (!this->pending[index] && !this->stop)
+            {
+                this->cond.wait(lock);
+            }
+
+            // Buffers are handed in order, so the pending ones are always flushed
+            // before stopping
+            if (!this->pending[index])
+            {
+                break;
+            }
+            lock.unlock();
+
+            this->flush_block(this->buffers[index].data(), this->pending_count[index]);
+
+            lock.lock();
+            this->pending[index] = false;
+            this->cond.notify_all();
+
+            index ^= 1;
+        }
+    }
+
+    std::function<void(int32_t *, int64_t)> flush_block;
+    int64_t block_size;
+    bool use_thread;
+
+    std::vector<int32_t> buffers[2];
+    int64_t pending_count[2];
+    bool pending[2];
+    int current = 0;
+    int64_t count = 0;
+
+    std::thread *thread = NULL;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool stop = false;
+};
+
+
+// Raw PCM file mapped into memory, so that samples are read without any system call
+class Audio_mapped_file
+{
+public:
+    ~Audio_mapped_file()
+    {
+        if (this->data)
+        {
+            munmap(this->data, this->size);
+        }
+    }
+
+    // Returns 0 if the file could be mapped
+    int open(std::string path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return -1;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) < 0)
+        {
+            ::close(fd);
+            return -1;
+        }
+
+        this->size = st.st_size;
+        if (this->size)
+        {
+            void *data = mmap(NULL, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                ::close(fd);
+                return -1;
+            }
+            this->data = (uint8_t *)data;
+
+            madvise(this->data, this->size, MADV_SEQUENTIAL);
+        }
+
+        // The mapping stays valid once the file is closed
+        ::close(fd);
+
+        return 0;
+    }
+
+    uint8_t *data = NULL;
+    size_t size = 0;
+};
+
+#endif
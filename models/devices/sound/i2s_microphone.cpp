@@ -32,6 +32,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <iostream>
+#include "audio_stream.hpp"
 #ifdef USE_SNDFILE
 #include <sndfile.hh>
 #endif
@@ -79,6 +80,8 @@ protected:
     bool lower_ws_out;
     bool enabled;
     int prev_sck;
+    int stream_block_size;  // Number of samples read at once from the stimuli file
+    bool stream_thread;     // Read the stimuli file from a separate thread
 
     vp::trace trace;
 
@@ -102,6 +105,7 @@ class Stim_txt : public Stim
 
 public:
   Stim_txt(Microphone *top, std::string file, int width, int freq, bool raw=false, bool use_libsnd=false);
+  ~Stim_txt();
   long long get_data(int64_t timestamp);
   long long get_data_from_file();
 
@@ -117,14 +121,18 @@ private:
   long long next_data;
   bool raw;
   bool use_libsnd;
+  Audio_mapped_file mapped_file;   // Raw files are mapped and read from memory
+  size_t offset;
 #ifdef USE_SNDFILE
   SndfileHandle sndfile;
+  Audio_stream_reader *reader;
+  std::vector<int16_t> read_buffer;
 #endif
 };
 
 
 Stim_txt::Stim_txt(Microphone *top, std::string file, int width, int freq, bool raw, bool use_libsnd)
-: top(top), width(width), file_path(file), raw(raw), use_libsnd(use_libsnd)
+: top(top), width(width), stim_file(NULL), file_path(file), raw(raw), use_libsnd(use_libsnd), offset(0)
 {
     if (use_libsnd)
     {
@@ -135,6 +143,22 @@ Stim_txt::Stim_txt(Microphone *top, std::string file, int width, int freq, bool
         this->sndfile = SndfileHandle (file, SFM_READ, SF_FORMAT_WAV | pcm_width) ;
         freq = sndfile.samplerate ();
 
+        this->reader = new Audio_stream_reader(
+            [this](int32_t *samples, int64_t nb_samples) -> int64_t {
+                if (this->width <= 16)
+                {
+                    this->read_buffer.resize(nb_samples);
+                    nb_samples = this->sndfile.read(this->read_buffer.data(), nb_samples);
+                    for (int64_t i=0; i<nb_samples; i++)
+                    {
+                        samples[i] = this->read_buffer[i];
+                    }
+                    return nb_samples;
+                }
+                return this->sndfile.read((int *)samples, nb_samples);
+            },
+            top->stream_block_size, top->stream_thread);
+
     #else
 
         this->top->get_trace()->fatal("Unable to open file (%s), libsndfile support is not active\n", file.c_str());
@@ -142,6 +166,17 @@ Stim_txt::Stim_txt(Microphone *top, std::string file, int width, int freq, bool
 
     #endif
 
+    }
+    else if (raw)
+    {
+        if (this->mapped_file.open(file))
+        {
+            this->top->get_trace()->fatal("Failed to open stimuli file: %s: %s\n", file.c_str(), strerror(errno));
+        }
+        else if (this->mapped_file.size < 2)
+        {
+            this->top->get_trace()->fatal("Stimuli file does not contain any sample: %s\n", file.c_str());
+        }
     }
     else
     {
@@ -162,6 +197,22 @@ Stim_txt::Stim_txt(Microphone *top, std::string file, int width, int freq, bool
 }
 
 
+Stim_txt::~Stim_txt()
+{
+#ifdef USE_SNDFILE
+    if (this->use_libsnd)
+    {
+        delete this->reader;
+    }
+#endif
+
+    if (this->stim_file)
+    {
+        fclose(this->stim_file);
+    }
+}
+
+
 static inline int get_signed_value(unsigned long long val, int bits)
 {
     return ((int)val) << (64-bits) >> (64-bits);
@@ -176,17 +227,9 @@ long long Stim_txt::get_data_from_file()
     #ifdef USE_SNDFILE
 
         int32_t result;
-        if (this->width <= 16)
-        {
-            int16_t sample;
-            sndfile.read (&sample, 1);
-            result = (int32_t)sample;
-        }
-        else if (this->width <= 32)
+        if (!this->reader->pop(&result))
         {
-            int32_t sample;
-            sndfile.read (&sample, 1);
-            result = (int32_t)sample;
+            return 0;
         }
 
         return result;
@@ -197,13 +240,18 @@ long long Stim_txt::get_data_from_file()
     }
     else if (raw)
     {
-        unsigned long long data = 0;
-        while(fread((void *)&data, 2, 1, this->stim_file) != 1)
+        // Samples are read again from the beginning when the end of the file is reached
+        if (this->offset + 2 > this->mapped_file.size)
         {
-            fclose(this->stim_file);
-            this->stim_file = fopen(this->file_path.c_str(), "r");    
+            this->offset = 0;
         }
 
+        uint16_t sample;
+        ::memcpy((void *)&sample, this->mapped_file.data + this->offset, 2);
+        this->offset += 2;
+
+        unsigned long long data = sample;
+
         long long result = get_signed_value(data, width);
 
         this->top->trace.msg(vp::trace::LEVEL_TRACE, "Got new sample (value: 0x%x)", result);
@@ -297,6 +345,15 @@ int Microphone::build()
     this->i2s_itf.set_sync_meth(&Microphone::sync);
 
     this->channel_ws = this->get_js_config()->get_child_str("channel") != "left";
+
+    js::config *block_size_config = this->get_js_config()->get("stream_block_size");
+    js::config *thread_config = this->get_js_config()->get("stream_thread");
+    this->stream_block_size = block_size_config ? block_size_config->get_int() : AUDIO_STREAM_DEFAULT_BLOCK_SIZE;
+    this->stream_thread = thread_config ? thread_config->get_bool() : false;
+    if (this->stream_block_size <= 0)
+    {
+        this->stream_block_size = AUDIO_STREAM_DEFAULT_BLOCK_SIZE;
+    }
     this->prev_ws = 0;
     this->ws_delay = this->get_js_config()->get_int("ws-delay");
     this->width = this->get_js_config()->get_int("width");
@@ -0,0 +1,313 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * SPI master checking the burst mode of the SPI flash against its pin-level
+ * mode. The same transactions are sent to two flashes, in burst mode to the
+ * one bound to the burst ports, and clock edge by clock edge to the one bound
+ * to the pins ports. The data read and the durations must be the same.
+ * Commands not supported in burst mode are sent in pin-level mode on both
+ * sides, as a master would do. It is driven by spiflash_burst_test.py.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/qspim.hpp>
+#include <vp/itf/wire.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define CMD_WREN          0x06
+#define CMD_PP            0x02
+#define CMD_QIOR_4B       0xEC
+#define CMD_READ          0x0C
+#define CMD_READ_SIMPLE   0x03
+
+class spiflash_burst_test : public vp::component
+{
+
+public:
+  spiflash_burst_test(js::config *config);
+
+  int build();
+  void reset(bool active);
+
+private:
+  static void handler(void *__this, vp::clock_event *event);
+  static void pins_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
+
+  int64_t transfer(vp::qspim_master *itf, vp::wire_master<bool> *cs_itf, vp::qspim_burst *burst, bool use_burst);
+  int64_t send_bits(vp::qspim_master *itf, uint32_t value, int nb_bits, bool quad);
+  void check(int cmd, uint32_t addr, int size);
+
+  vp::trace trace;
+  vp::qspim_master burst_itf;
+  vp::wire_master<bool> burst_cs_itf;
+  vp::qspim_master pins_itf;
+  vp::wire_master<bool> pins_cs_itf;
+  vp::clock_event *event;
+
+  // Bits received in pin-level mode, one per element
+  std::vector<int> rx_bits;
+
+  // Expected content of the flashes
+  std::vector<uint8_t> mem;
+  uint32_t seed;
+
+  int nb_transactions;
+  int nb_bursts;
+  int nb_errors;
+};
+
+spiflash_burst_test::spiflash_burst_test(js::config *config)
+: vp::component(config)
+{
+
+}
+
+void spiflash_burst_test::pins_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask)
+{
+  spiflash_burst_test *_this = (spiflash_burst_test *)__this;
+
+  // Single data comes on data_1, quad data on the 4 lines, most significant first
+  if (mask == 0xf)
+  {
+    _this->rx_bits.push_back(data_3);
+    _this->rx_bits.push_back(data_2);
+    _this->rx_bits.push_back(data_1);
+    _this->rx_bits.push_back(data_0);
+  }
+  else
+  {
+    _this->rx_bits.push_back(data_1);
+  }
+}
+
+int64_t spiflash_burst_test::send_bits(vp::qspim_master *itf, uint32_t value, int nb_bits, bool quad)
+{
+  int64_t nb_edges = 0;
+
+  if (quad)
+  {
+    for (int i=nb_bits-4; i>=0; i-=4)
+    {
+      itf->sync(1, (value >> i) & 1, (value >> (i + 1)) & 1, (value >> (i + 2)) & 1, (value >> (i + 3)) & 1, 0xf);
+      nb_edges++;
+    }
+  }
+  else
+  {
+    for (int i=nb_bits-1; i>=0; i--)
+    {
+      itf->sync(1, (value >> i) & 1, 0, 0, 0, 1);
+      nb_edges++;
+    }
+  }
+
+  return nb_edges;
+}
+
+// Sends the transaction in burst mode if asked and supported, and falls back to
+// pin-level mode otherwise. Returns the duration in SPI clock cycles.
+int64_t spiflash_burst_test::transfer(vp::qspim_master *itf, vp::wire_master<bool> *cs_itf, vp::qspim_burst *burst, bool use_burst)
+{
+  if (use_burst && itf->is_burst_capable() && itf->burst(burst))
+  {
+    this->nb_bursts++;
+    return burst->duration;
+  }
+
+  int64_t nb_edges = 0;
+  this->rx_bits.clear();
+
+  cs_itf->sync(true);
+
+  nb_edges += this->send_bits(itf, burst->cmd, 8, false);
+
+  switch (burst->cmd)
+  {
+    case CMD_READ:
+    case CMD_READ_SIMPLE:
+      nb_edges += this->send_bits(itf, burst->addr, 24, false);
+      for (int i=0; i<burst->size; i++)
+      {
+        nb_edges += this->send_bits(itf, 0, 8, false);
+      }
+      break;
+
+    case CMD_QIOR_4B:
+      nb_edges += this->send_bits(itf, burst->addr, 32, true);
+      nb_edges += this->send_bits(itf, 0, 8, true);
+      for (int i=0; i<burst->size; i++)
+      {
+        nb_edges += this->send_bits(itf, 0, 8, true);
+      }
+      break;
+
+    case CMD_PP:
+      nb_edges += this->send_bits(itf, burst->addr, 24, false);
+      for (int i=0; i<burst->size; i++)
+      {
+        nb_edges += this->send_bits(itf, burst->data[i], 8, false);
+      }
+      break;
+
+    default:
+      for (int i=0; i<burst->size; i++)
+      {
+        nb_edges += this->send_bits(itf, burst->data[i], 8, false);
+      }
+      break;
+  }
+
+  cs_itf->sync(false);
+
+  // The flash sends the first data bits on the last address or mode clock
+  // edge, so the data read is made of the first bits received
+  if (burst->cmd == CMD_READ || burst->cmd == CMD_READ_SIMPLE || burst->cmd == CMD_QIOR_4B)
+  {
+    for (int i=0; i<burst->size; i++)
+    {
+      uint8_t value = 0;
+      for (int j=0; j<8; j++)
+      {
+        int index = i*8 + j;
+        value = (value << 1) | (index < (int)this->rx_bits.size() ? this->rx_bits[index] : 0);
+      }
+      burst->data[i] = value;
+    }
+  }
+
+  return nb_edges;
+}
+
+void spiflash_burst_test::check(int cmd, uint32_t addr, int size)
+{
+  std::vector<uint8_t> burst_data(size);
+  std::vector<uint8_t> pins_data(size);
+  bool is_write = cmd != CMD_READ && cmd != CMD_READ_SIMPLE && cmd != CMD_QIOR_4B;
+
+  if (is_write)
+  {
+    for (int i=0; i<size; i++)
+    {
+      this->seed = this->seed * 1103515245 + 12345;
+      burst_data[i] = pins_data[i] = this->seed >> 16;
+      if (cmd == CMD_PP)
+        this->mem[addr + i] = burst_data[i];
+    }
+  }
+
+  vp::qspim_burst burst = { cmd, addr, size, burst_data.data(), 0 };
+  vp::qspim_burst pins = { cmd, addr, size, pins_data.data(), 0 };
+
+  int64_t burst_duration = this->transfer(&this->burst_itf, &this->burst_cs_itf, &burst, true);
+  int64_t pins_duration = this->transfer(&this->pins_itf, &this->pins_cs_itf, &pins, false);
+
+  this->nb_transactions++;
+
+  this->trace.msg(vp::trace::LEVEL_INFO, "Checked transaction (cmd: 0x%x, address: 0x%x, size: 0x%x, duration: %ld)\n",
+    cmd, addr, size, pins_duration);
+
+  if (burst_duration != pins_duration)
+  {
+    printf("Duration mismatch (cmd: 0x%x, address: 0x%x, size: 0x%x, burst: %ld, pin-level: %ld)\n",
+      cmd, addr, size, burst_duration, pins_duration);
+    this->nb_errors++;
+  }
+
+  if (!is_write)
+  {
+    for (int i=0; i<size; i++)
+    {
+      if (burst_data[i] != this->mem[addr + i] || pins_data[i] != this->mem[addr + i])
+      {
+        printf("Data mismatch (cmd: 0x%x, address: 0x%x, expected: 0x%x, burst: 0x%x, pin-level: 0x%x)\n",
+          cmd, addr + i, this->mem[addr + i], burst_data[i], pins_data[i]);
+        this->nb_errors++;
+        break;
+      }
+    }
+  }
+}
+
+void spiflash_burst_test::handler(void *__this, vp::clock_event *event)
+{
+  spiflash_burst_test *_this = (spiflash_burst_test *)__this;
+
+  // The flashes wait for a command only after a chip select deassertion
+  _this->burst_cs_itf.sync(false);
+  _this->pins_cs_itf.sync(false);
+
+  _this->check(CMD_WREN, 0, 0);
+  _this->check(CMD_PP, 0x1000, 256);
+  _this->check(CMD_WREN, 0, 0);
+  _this->check(CMD_PP, 0x1100, 100);
+  _this->check(CMD_READ_SIMPLE, 0xff0, 400);
+  _this->check(CMD_READ, 0x1080, 64);
+  _this->check(CMD_QIOR_4B, 0x1003, 300);
+  _this->check(CMD_PP, 0x1010, 1);
+  _this->check(CMD_QIOR_4B, 0x1010, 1);
+  _this->check(CMD_READ_SIMPLE, 0x100f, 3);
+
+  printf("Checked %d transactions, %d in burst mode, %d errors\n",
+    _this->nb_transactions, _this->nb_bursts, _this->nb_errors);
+
+  // Keep an event pending, otherwise the engine may see that it ran out of
+  // events before handling the stop request, and report a failure
+  _this->event_enqueue(_this->event, 1);
+  _this->get_clock()->stop_engine(_this->nb_errors != 0 || _this->nb_bursts == 0);
+}
+
+int spiflash_burst_test::build()
+{
+  traces.new_trace("trace", &trace, vp::DEBUG);
+
+  // Both ports may be used in pin-level mode
+  this->burst_itf.set_sync_meth(&spiflash_burst_test::pins_sync);
+  this->pins_itf.set_sync_meth(&spiflash_burst_test::pins_sync);
+
+  new_master_port("burst", &this->burst_itf);
+  new_master_port("burst_cs", &this->burst_cs_itf);
+  new_master_port("pins", &this->pins_itf);
+  new_master_port("pins_cs", &this->pins_cs_itf);
+
+  this->event = this->event_new(spiflash_burst_test::handler);
+
+  // The flashes are filled with this value when they are built
+  this->mem.resize(this->get_js_config()->get_child_int("size"), 0x57);
+  this->seed = 1;
+
+  this->nb_transactions = 0;
+  this->nb_bursts = 0;
+  this->nb_errors = 0;
+
+  return 0;
+}
+
+void spiflash_burst_test::reset(bool active)
+{
+  if (!active)
+  {
+    this->event_enqueue(this->event, 1);
+  }
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+  return new spiflash_burst_test(config);
+}
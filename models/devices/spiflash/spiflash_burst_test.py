@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2021 GreenWaves Technologies, SAS
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Checks the burst mode of devices.spiflash.spiflash_impl. A system made of
+# the devices.spiflash.spiflash_burst_test SPI master and two flashes, one
+# accessed in burst mode and one in pin-level mode, is simulated with
+# gvsoc_launcher, which fails if any transaction differs between both modes.
+#
+# Example:
+#   GVSOC_PATH=<install>/models ./spiflash_burst_test.py
+#
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def get_config(size):
+
+    flash = {'vp_component': 'devices.spiflash.spiflash_impl', 'size': size}
+
+    return {
+        'gvsoc': {
+            'sa-mode': True,
+            'traces': {'level': 'info', 'include_regex': [], 'format': 'long'},
+            'events': {'include_regex': [], 'include_raw': []}
+        },
+        'target': {
+            'vp_component': 'utils.composite_impl',
+            'clock': {'vp_component': 'vp.clock_domain_impl', 'frequency': 50000000},
+            'test': {'vp_component': 'devices.spiflash.spiflash_burst_test', 'size': size},
+            'burst_flash': flash,
+            'pins_flash': flash,
+            'components': ['clock', 'test', 'burst_flash', 'pins_flash'],
+            'bindings': [
+                ['clock->out', 'test->clock'],
+                ['clock->out', 'burst_flash->clock'],
+                ['clock->out', 'pins_flash->clock'],
+                ['test->burst', 'burst_flash->input'],
+                ['test->burst_cs', 'burst_flash->cs'],
+                ['test->pins', 'pins_flash->input'],
+                ['test->pins_cs', 'pins_flash->cs']
+            ]
+        }
+    }
+
+
+parser = argparse.ArgumentParser(description='Check the SPI flash burst mode')
+
+parser.add_argument("--launcher", dest="launcher", default="gvsoc_launcher",
+    help="Path to gvsoc_launcher")
+parser.add_argument("--size", dest="size", type=int, default=1<<20,
+    help="Size of the flashes")
+
+args = parser.parse_args()
+
+with tempfile.TemporaryDirectory() as tmpdir:
+    config_path = os.path.join(tmpdir, 'spiflash_burst_test.json')
+    with open(config_path, 'w') as file:
+        json.dump(get_config(args.size), file, indent=2)
+
+    if subprocess.run([args.launcher, '--config=' + config_path]).returncode != 0:
+        sys.exit('SPI flash burst test failed')
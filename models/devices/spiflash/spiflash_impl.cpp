@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <vp/itf/qspim.hpp>
+#include <vp/checkpoint.hpp>
 
 #define CMD_READ_ID       0x9f
 #define CMD_RDCR          0x35
@@ -97,6 +98,7 @@ public:
 
   int build();
   void start();
+  void checkpoint(vp::checkpoint *cp);
 
   static void sector_erase(void *__this, int data_0, int data_1, int data_2, int data_3);
   static void sector_erase_done(void *__this, vp::clock_event *event);
@@ -115,6 +117,7 @@ private:
 
   static void sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
   static void cs_sync(void *__this, bool active);
+  static bool burst(void *__this, vp::qspim_burst *burst);
 
   void handle_data(int data_0, int data_1, int data_2, int data_3);
   void start_command();
@@ -443,12 +446,72 @@ void spiflash::cs_sync(void *__this, bool active)
 
 
 }
-  
+
+
+// Only the commands moving data are supported in burst mode, the others are
+// short and must be sent in pin-level mode.
+bool spiflash::burst(void *__this, vp::qspim_burst *burst)
+{
+  spiflash *_this = (spiflash *)__this;
+  uint32_t addr = burst->addr;
+  bool is_write = false;
+
+  switch (burst->cmd)
+  {
+    case CMD_READ:
+    case CMD_READ_SIMPLE:
+      // Command, 24 bits address and data on a single line
+      addr &= 0xffffff;
+      burst->duration = 8 + 24 + burst->size * 8;
+      break;
+
+    case CMD_QIOR_4B:
+      // Command on a single line, then 32 bits address, mode byte and data on 4 lines
+      burst->duration = 8 + 8 + 2 + burst->size * 2;
+      break;
+
+    case CMD_PP:
+      // Command, 24 bits address and data on a single line
+      addr &= 0xffffff;
+      is_write = true;
+      burst->duration = 8 + 24 + burst->size * 8;
+      break;
+
+    default:
+      return false;
+  }
+
+  _this->trace.msg(vp::trace::LEVEL_INFO, "Received burst (cmd: 0x%x, name: %s, address: 0x%x, size: 0x%x)\n", burst->cmd, _this->commands[burst->cmd]->desc.c_str(), addr, burst->size);
+
+  // Like in pin-level mode, the bytes which are out of the memory are dropped
+  int size = burst->size;
+  if ((uint64_t)addr + size > (uint64_t)_this->size)
+  {
+    _this->warning.force_warning("Received out-of-bound request (address: 0x%x, memSize: 0x%x)\n", addr, _this->size);
+    size = addr >= (uint32_t)_this->size ? 0 : _this->size - addr;
+  }
+
+  if (is_write)
+  {
+    memcpy(&_this->mem_data[addr], burst->data, size);
+  }
+  else
+  {
+    memcpy(burst->data, &_this->mem_data[addr], size);
+  }
+
+  // The next transaction starts with a new command, as after a chip select deassertion
+  _this->start_command();
+
+  return true;
+}
+
 int spiflash::build()
 {
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   this->in_itf.set_sync_meth(&spiflash::sync);
+  this->in_itf.set_burst_meth(&spiflash::burst);
   this->new_slave_port("input", &this->in_itf);
 
   this->cs_itf.set_sync_meth(&spiflash::cs_sync);
@@ -539,6 +602,13 @@ void spiflash::start()
   }
 }
 
+void spiflash::checkpoint(vp::checkpoint *cp)
+{
+  cp->pages(this->mem_data, this->size);
+  cp->value(this->cr1);
+  cp->value(this->sr2v);
+}
+
 spiflash::spiflash(js::config *config)
 : vp::component(config)
 {
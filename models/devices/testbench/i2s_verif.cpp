@@ -21,6 +21,7 @@
 
 #include <vp/vp.hpp>
 #include "i2s_verif.hpp"
+#include "../sound/audio_stream.hpp"
 #ifdef USE_SNDFILE
 #include <sndfile.hh>
 #endif
@@ -42,6 +43,8 @@ class Tx_stream
 public:
     virtual ~Tx_stream() {};
     virtual void push_sample(uint32_t sample, int channel_id) = 0;
+    // Write to the file the samples which are still buffered
+    virtual void flush() {}
     int use_count = 0;
 };
 
@@ -50,6 +53,7 @@ class Rx_stream_libsnd_file : public Rx_stream
 {
 public:
     Rx_stream_libsnd_file(I2s_verif *i2s, pi_testbench_i2s_verif_start_config_rx_file_reader_type_e type, string filepath, int nb_channels, int width);
+    ~Rx_stream_libsnd_file();
     uint32_t get_sample(int channel_id);
     I2s_verif *i2s;
 
@@ -57,6 +61,7 @@ private:
 #ifdef USE_SNDFILE
     SNDFILE *sndfile;
     SF_INFO sfinfo;
+    Audio_stream_reader *reader;
 #endif
     int period;
     int width;
@@ -75,11 +80,15 @@ class Rx_stream_raw_file : public Rx_stream
 {
 public:
     Rx_stream_raw_file(Slot *slot, string filepath, int width, bool is_bin, pi_testbench_i2s_verif_start_config_file_encoding_type_e encoding);
+    ~Rx_stream_raw_file();
     uint32_t get_sample(int channel_id);
     Slot *slot;
 
 private:
     FILE *infile;
+    // Binary files are mapped and read from memory
+    Audio_mapped_file mapped_file;
+    size_t offset;
     int width;
     bool is_bin;
     pi_testbench_i2s_verif_start_config_file_encoding_type_e encoding;
@@ -90,11 +99,18 @@ class Tx_stream_raw_file : public Tx_stream
 {
 public:
     Tx_stream_raw_file(Slot *slot, string filepath, int width, bool is_bin, pi_testbench_i2s_verif_start_config_file_encoding_type_e encoding);
+    ~Tx_stream_raw_file();
     void push_sample(uint32_t sample, int channel_id);
+    void flush();
     Slot *slot;
 
 private:
+    void write_block(int32_t *samples, int64_t nb_samples);
+
     FILE *outfile;
+    // Binary samples are buffered and written by blocks
+    Audio_stream_writer *writer;
+    std::vector<uint8_t> write_buffer;
     int width;
     bool is_bin;
     pi_testbench_i2s_verif_start_config_file_encoding_type_e encoding;
@@ -107,12 +123,16 @@ public:
     Tx_stream_libsnd_file(I2s_verif *i2s, pi_testbench_i2s_verif_start_config_tx_file_dumper_type_e type, string filepath, int channels, int width);
     ~Tx_stream_libsnd_file();
     void push_sample(uint32_t sample, int channel_id);
+    void flush();
 
 private:
+    void push_frame();
+
     I2s_verif *i2s;
 #ifdef USE_SNDFILE
     SNDFILE *sndfile;
     SF_INFO sfinfo;
+    Audio_stream_writer *writer;
 #endif
     int period;
     int width;
@@ -142,6 +162,7 @@ public:
     void setup(pi_testbench_i2s_verif_slot_config_t *config);
     void start(pi_testbench_i2s_verif_slot_start_config_t *config, Slot *reuse_slot = NULL, int nb_channels=1, int channel_id=0);
     void stop(pi_testbench_i2s_verif_slot_stop_config_t *config);
+    void flush();
     void start_frame();
     int get_data();
     void send_data(int sdo);
@@ -354,6 +375,15 @@ void I2s_verif::slot_stop(pi_testbench_i2s_verif_slot_stop_config_t *config)
 }
 
 
+void I2s_verif::flush()
+{
+    for (Slot *slot: this->slots)
+    {
+        slot->flush();
+    }
+}
+
+
 void I2s_verif::sync_sck(int sck)
 {
     this->propagated_clk = sck;
@@ -573,15 +603,65 @@ Tx_stream_raw_file::Tx_stream_raw_file(Slot *slot, std::string filepath, int wid
     this->is_bin = is_bin;
     this->encoding = encoding;
     this->slot = slot;
+    this->writer = NULL;
     this->outfile = fopen(filepath.c_str(), "w");
     this->slot->trace.msg(vp::trace::LEVEL_INFO, "Opening dumper (path: %s)\n", filepath.c_str());
     if (this->outfile == NULL)
     {
         this->slot->top->trace.fatal("Unable to open output file (file: %s, error: %s)\n", filepath.c_str(), strerror(errno));
+        return;
+    }
+
+    if (this->is_bin)
+    {
+        Testbench *top = this->slot->i2s->top;
+        this->writer = new Audio_stream_writer(
+            [this](int32_t *samples, int64_t nb_samples) { this->write_block(samples, nb_samples); },
+            top->audio_stream_block_size, top->audio_stream_thread);
+    }
+}
+
+
+Tx_stream_raw_file::~Tx_stream_raw_file()
+{
+    // Deleting the writer flushes the remaining samples
+    delete this->writer;
+
+    if (this->outfile)
+    {
+        fclose(this->outfile);
+    }
+}
+
+
+void Tx_stream_raw_file::flush()
+{
+    if (this->writer)
+    {
+        this->writer->flush();
+    }
+    if (this->outfile)
+    {
+        fflush(this->outfile);
     }
 }
 
 
+void Tx_stream_raw_file::write_block(int32_t *samples, int64_t nb_samples)
+{
+    int nb_bytes = (this->width + 7) / 8;
+
+    // Samples are packed with the same layout as if they were written one by one
+    this->write_buffer.resize(nb_samples * nb_bytes);
+    for (int64_t i=0; i<nb_samples; i++)
+    {
+        ::memcpy(&this->write_buffer[i*nb_bytes], (void *)&samples[i], nb_bytes);
+    }
+
+    fwrite(this->write_buffer.data(), nb_bytes, nb_samples, this->outfile);
+}
+
+
 void Tx_stream_raw_file::push_sample(uint32_t sample, int channel_id)
 {
     if (this->is_bin)
@@ -597,11 +677,7 @@ void Tx_stream_raw_file::push_sample(uint32_t sample, int channel_id)
                 sample = 0; // Error
         }
 
-        int nb_bytes = (this->width + 7) / 8;
-        if (fwrite((void *)&sample, nb_bytes, 1, this->outfile) != 1)
-        {
-            return;
-        }
+        this->writer->push(sample);
     }
     else
     {
@@ -642,6 +718,15 @@ Tx_stream_libsnd_file::Tx_stream_libsnd_file(I2s_verif *i2s, pi_testbench_i2s_ve
     this->pending_channels = 0;
     this->items = new int32_t[channels];
     memset(this->items, 0, sizeof(uint32_t)*this->sfinfo.channels);
+
+    // Only full frames are written, the block size is rounded to a multiple of the number of channels
+    Testbench *top = i2s->top;
+    int64_t frames = std::max(top->audio_stream_block_size / channels, 1);
+    this->writer = new Audio_stream_writer(
+        [this](int32_t *samples, int64_t nb_samples) {
+            sf_writef_int(this->sndfile, (const int *)samples, nb_samples / this->sfinfo.channels);
+        },
+        frames * channels, top->audio_stream_thread);
 #else
 
     this->i2s->top->get_trace()->fatal("Unable to open file (%s), libsndfile support is not active\n", filepath.c_str());
@@ -656,19 +741,39 @@ Tx_stream_libsnd_file::~Tx_stream_libsnd_file()
 #ifdef USE_SNDFILE
     if (this->pending_channels)
     {
-        sf_writef_int(this->sndfile, (const int *)this->items, 1);
+        this->push_frame();
     }
+    delete this->writer;
     sf_close(this->sndfile);
 #endif
 }
 
 
+void Tx_stream_libsnd_file::flush()
+{
+#ifdef USE_SNDFILE
+    this->writer->flush();
+#endif
+}
+
+
+void Tx_stream_libsnd_file::push_frame()
+{
+#ifdef USE_SNDFILE
+    for (int i=0; i<this->sfinfo.channels; i++)
+    {
+        this->writer->push(this->items[i]);
+    }
+#endif
+}
+
+
 void Tx_stream_libsnd_file::push_sample(uint32_t data, int channel)
 {
 #ifdef USE_SNDFILE
     if (((this->pending_channels >> channel) & 1) == 1)
     {
-        sf_writef_int(this->sndfile, (const int *)this->items, 1);
+        this->push_frame();
         this->pending_channels = 0;
         memset(this->items, 0, sizeof(uint32_t)*this->sfinfo.channels);
     }
@@ -686,6 +791,18 @@ Rx_stream_raw_file::Rx_stream_raw_file(Slot *slot, std::string filepath, int wid
     this->is_bin = is_bin;
     this->encoding = encoding;
     this->slot = slot;
+    this->infile = NULL;
+    this->offset = 0;
+
+    if (this->is_bin)
+    {
+        if (this->mapped_file.open(filepath))
+        {
+            this->slot->top->trace.fatal("Unable to open input file (file: %s, error: %s)\n", filepath.c_str(), strerror(errno));
+        }
+        return;
+    }
+
     this->infile = fopen(filepath.c_str(), "r");
     if (this->infile == NULL)
     {
@@ -694,21 +811,30 @@ Rx_stream_raw_file::Rx_stream_raw_file(Slot *slot, std::string filepath, int wid
 }
 
 
+Rx_stream_raw_file::~Rx_stream_raw_file()
+{
+    if (this->infile)
+    {
+        fclose(this->infile);
+    }
+}
+
+
 uint32_t Rx_stream_raw_file::get_sample(int channel_id)
 {
     if (this->is_bin)
     {
         int nb_bytes = (this->width + 7) / 8;
         uint32_t result = 0;
-        int freadres = fread((void *)&result, nb_bytes, 1, this->infile);
-
-        // this->slot->top->trace.msg(vp::trace::LEVEL_TRACE, "channel_id=%d, nb_bytes=%d, freadres=%d, result=%d\n", channel_id, nb_bytes, freadres, result);
 
-        if (freadres != 1)
+        if (this->offset + nb_bytes > this->mapped_file.size)
         {
             return 0;
         }
 
+        ::memcpy((void *)&result, this->mapped_file.data + this->offset, nb_bytes);
+        this->offset += nb_bytes;
+
         if (this->encoding == PI_TESTBENCH_I2S_VERIF_FILE_ENCODING_TYPE_PLUSMINUS)
         {
             // Convert encoding from -1/+1 to 0/1
@@ -767,6 +893,15 @@ Rx_stream_libsnd_file::Rx_stream_libsnd_file(I2s_verif *i2s, pi_testbench_i2s_ve
     this->next_data_time = -1;
 
     this->items = new int32_t[nb_channels];
+
+    // Only full frames are read, the block size is rounded to a multiple of the number of channels
+    Testbench *top = i2s->top;
+    int64_t frames = std::max(top->audio_stream_block_size / nb_channels, 1);
+    this->reader = new Audio_stream_reader(
+        [this](int32_t *samples, int64_t nb_samples) {
+            return (int64_t)sf_readf_int(this->sndfile, samples, nb_samples / this->sfinfo.channels) * this->sfinfo.channels;
+        },
+        frames * nb_channels, top->audio_stream_thread);
 #else
 
     this->i2s->top->get_trace()->fatal("Unable to open file (%s), libsndfile support is not active\n", filepath.c_str());
@@ -775,13 +910,33 @@ Rx_stream_libsnd_file::Rx_stream_libsnd_file(I2s_verif *i2s, pi_testbench_i2s_ve
 #endif
 }
 
+Rx_stream_libsnd_file::~Rx_stream_libsnd_file()
+{
+#ifdef USE_SNDFILE
+    if (this->sndfile)
+    {
+        delete this->reader;
+        sf_close(this->sndfile);
+    }
+#endif
+}
+
+
 uint32_t Rx_stream_libsnd_file::get_sample(int channel)
 {
 #ifdef USE_SNDFILE
 
     if (((this->pending_channels >> channel) & 1) == 0)
     {
-        sf_readf_int(this->sndfile, this->items, 1);
+        // At the end of the file, the last frame is kept like when it was read with sf_readf_int
+        for (int i=0; i<this->sfinfo.channels; i++)
+        {
+            int32_t item;
+            if (this->reader->pop(&item))
+            {
+                this->items[i] = item;
+            }
+        }
         this->pending_channels = (1 << this->sfinfo.channels) - 1;
     }
 
@@ -1011,6 +1166,15 @@ void Slot::stop(pi_testbench_i2s_verif_slot_stop_config_t *config)
 }
 
 
+void Slot::flush()
+{
+    if (this->outstream)
+    {
+        this->outstream->flush();
+    }
+}
+
+
 void Slot::start_frame()
 {
     this->trace.msg(vp::trace::LEVEL_DEBUG, "Start frame\n");
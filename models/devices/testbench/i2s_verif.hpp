@@ -37,6 +37,7 @@ public:
     void slot_setup(pi_testbench_i2s_verif_slot_config_t *config);
     void slot_start(pi_testbench_i2s_verif_slot_start_config_t *config, std::vector<int> slots);
     void slot_stop(pi_testbench_i2s_verif_slot_stop_config_t *config);
+    void flush();
     void sync(int sck, int ws, int sd);
     void sync_sck(int sck);
     void sync_ws(int ws);
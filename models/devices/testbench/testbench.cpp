@@ -23,6 +23,7 @@
 #include "testbench.hpp"
 #include "spim_verif.hpp"
 #include "i2s_verif.hpp"
+#include "../sound/audio_stream.hpp"
 #include <stdio.h>
 #include "vp/proxy.hpp"
 
@@ -226,6 +227,15 @@ int Testbench::build()
     this->nb_i2c = get_js_config()->get("nb_i2c")->get_int();
     this->nb_uart = get_js_config()->get("nb_uart")->get_int();
 
+    js::config *audio_config = get_js_config()->get("audio_stream");
+    this->audio_stream_block_size = audio_config ? audio_config->get_child_int("block_size") : AUDIO_STREAM_DEFAULT_BLOCK_SIZE;
+    this->audio_stream_thread = audio_config ? audio_config->get_child_bool("thread") : false;
+
+    if (this->audio_stream_block_size <= 0)
+    {
+        this->audio_stream_block_size = AUDIO_STREAM_DEFAULT_BLOCK_SIZE;
+    }
+
     for (int i=0; i<this->nb_uart; i++)
     {
         this->uarts.push_back(new Uart(this, i));
@@ -292,6 +302,19 @@ void Testbench::start()
     }
 }
 
+
+void Testbench::stop()
+{
+    // I2S file streams are buffered, make sure the dumped samples reach the files
+    for (I2s *i2s: this->i2ss)
+    {
+        if (i2s->i2s_verif)
+        {
+            i2s->i2s_verif->flush();
+        }
+    }
+}
+
 void Uart::set_control(bool active, int baudrate)
 {
     this->is_control_active = active;
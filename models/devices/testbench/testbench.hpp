@@ -588,6 +588,7 @@ public:
 
     int build();
     void start();
+    void stop();
     std::string handle_command(Gv_proxy *proxy, FILE *req_file, FILE *reply_file, std::vector<std::string> args, std::string req);
 
     void handle_received_byte(uint8_t byte);
@@ -610,6 +611,11 @@ public:
     int nb_i2c;
     int nb_i2s;
 
+    // Number of samples read or written at once by the I2S file streams, and
+    // whether the files are accessed from a separate thread
+    int audio_stream_block_size;
+    bool audio_stream_thread;
+
 private:
 
 
@@ -169,7 +169,28 @@ bool Rsp::signal()
         signal = 17;
     }
 
-    len = snprintf(str, 128, "S%02x", signal);
+    uint64_t addr;
+    switch (core->gdbserver_stop_reason(&addr))
+    {
+        case vp::Gdbserver_core::stop_reason_breakpoint:
+            if (this->hw_breakpoints.count(addr))
+                len = snprintf(str, 128, "T05hwbreak:;");
+            else
+                len = snprintf(str, 128, "T05swbreak:;");
+            break;
+        case vp::Gdbserver_core::stop_reason_watch_write:
+            len = snprintf(str, 128, "T05watch:%lx;", addr);
+            break;
+        case vp::Gdbserver_core::stop_reason_watch_read:
+            len = snprintf(str, 128, "T05rwatch:%lx;", addr);
+            break;
+        case vp::Gdbserver_core::stop_reason_watch_access:
+            len = snprintf(str, 128, "T05awatch:%lx;", addr);
+            break;
+        default:
+            len = snprintf(str, 128, "S%02x", signal);
+            break;
+    }
 
 
 #if 0
@@ -250,6 +271,65 @@ bool Rsp::reg_read(char *data, size_t)
 }
 
 
+// Breakpoints and watchpoints are set on all the cores, as GDB considers them
+// global to all threads
+bool Rsp::bp_insert_remove(char *data, size_t len, bool is_insert)
+{
+    int type;
+    uint32_t addr;
+    int kind;
+    int err = 0;
+
+    if (sscanf(data, "%1d,%x,%x", &type, &addr, &kind) != 3)
+    {
+        this->top->trace.msg(vp::trace::LEVEL_ERROR, "Could not parse packet\n");
+        return send_str("E01");
+    }
+
+    this->top->trace.msg(vp::trace::LEVEL_DEBUG, "%s breakpoint (type: %d, addr: 0x%x, kind: %d)\n",
+        is_insert ? "Inserting" : "Removing", type, addr, kind);
+
+    // Watchpoint types: 2 is write, 3 is read and 4 is access
+    bool is_write = type == 2 || type == 4;
+    bool is_read = type == 3 || type == 4;
+
+    if (type < 0 || type > 4)
+    {
+        return send_str("");
+    }
+
+    this->top->lock();
+    if (type == 1)
+    {
+        if (is_insert)
+            this->hw_breakpoints.insert(addr);
+        else
+            this->hw_breakpoints.erase(addr);
+    }
+
+    for (auto &core : this->top->get_cores())
+    {
+        if (type <= 1)
+        {
+            if (is_insert)
+                err |= core->gdbserver_breakpoint_insert(addr);
+            else
+                err |= core->gdbserver_breakpoint_remove(addr);
+        }
+        else
+        {
+            if (is_insert)
+                err |= core->gdbserver_watchpoint_insert(is_write, is_read, addr, kind);
+            else
+                err |= core->gdbserver_watchpoint_remove(is_write, is_read, addr, kind);
+        }
+    }
+    this->top->unlock();
+
+    return send_str(err ? "E01" : "OK");
+}
+
+
 void Rsp::io_access_done(int status)
 {
     if (status)
@@ -348,7 +428,7 @@ bool Rsp::query(char* data, size_t len)
 
     if (strncmp ("qSupported", data, strlen("qSupported")) == 0)
     {
-        snprintf(reply, REPLY_BUF_LEN, "PacketSize=%x;vContSupported+;hwbreak+", RSP_PACKET_MAX_SIZE);
+        snprintf(reply, REPLY_BUF_LEN, "PacketSize=%x;vContSupported+;swbreak+;hwbreak+", RSP_PACKET_MAX_SIZE);
         return send_str(reply);
     }
     else if (strncmp ("qTStatus", data, strlen ("qTStatus")) == 0)
@@ -575,7 +655,11 @@ bool Rsp::decode(char* data, size_t len)
             return ret;
         }
 
+        case 'Z':
+            return this->bp_insert_remove(&data[1], len-1, true);
 
+        case 'z':
+            return this->bp_insert_remove(&data[1], len-1, false);
 
     #if 0
         case 'R':
@@ -591,12 +675,6 @@ bool Rsp::decode(char* data, size_t len)
         case 'M':
         return mem_write_ascii(&data[1], len-1);
 
-        case 'z':
-        return bp_remove(&data[0], len);
-
-        case 'Z':
-        return bp_insert(&data[0], len);
-
         case 'T':
         return send_str("OK"); // threads are always alive
 
@@ -22,6 +22,7 @@
 #define __GDB_SERVER_RSP_HPP__
 
 #include <thread>
+#include <set>
 #include "rsp-packet-codec.hpp"
 
 
@@ -50,6 +51,7 @@ private:
     bool mem_write(char *data, size_t len);
     bool reg_read(char *data, size_t);
     bool reg_write(char *data, size_t);
+    bool bp_insert_remove(char *data, size_t len, bool is_insert);
 
     Gdb_server *top;
     int sock;
@@ -60,6 +62,8 @@ private:
     RspPacketCodec *codec;
     CircularCharBuffer *out_buffer;
     int active_core_for_other = 0;
+    // Addresses of the breakpoints inserted with Z1, the other ones are software breakpoints
+    std::set<uint32_t> hw_breakpoints;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2021 GreenWaves Technologies, SAS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Traffic generator used to measure how many requests per second the router
+ * can route. It is driven by router_bench.py, which builds a router with a
+ * given number of mappings.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <stdio.h>
+#include <chrono>
+
+class router_bench : public vp::component
+{
+
+public:
+  router_bench(js::config *config);
+
+  int build();
+  void reset(bool active);
+
+private:
+  static void handler(void *__this, vp::clock_event *event);
+
+  vp::trace trace;
+  vp::io_master out;
+  vp::clock_event *event;
+
+  uint64_t base;
+  uint64_t size;
+  int64_t nb_requests;
+};
+
+router_bench::router_bench(js::config *config)
+: vp::component(config)
+{
+
+}
+
+void router_bench::handler(void *__this, vp::clock_event *event)
+{
+  router_bench *_this = (router_bench *)__this;
+  uint32_t data = 0;
+  vp::io_req req;
+  int64_t nb_errors = 0;
+
+  // Addresses are drawn from a LCG so that all the mappings are hit in an
+  // order the router can't predict
+  uint32_t seed = 1;
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (int64_t i=0; i<_this->nb_requests; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    uint64_t offset = ((uint64_t)seed * _this->size >> 32) & ~(uint64_t)3;
+
+    req.init();
+    req.set_addr(_this->base + offset);
+    req.set_size(4);
+    req.set_is_write((i & 1) != 0);
+    req.set_data((uint8_t *)&data);
+
+    if (_this->out.req(&req) != vp::IO_REQ_OK)
+      nb_errors++;
+  }
+
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  printf("Routed %ld requests in %.3f s (%.0f requests/s, %ld errors)\n",
+    _this->nb_requests, elapsed, _this->nb_requests / elapsed, nb_errors);
+
+  // Keep an event pending, otherwise the engine may see that it ran out of
+  // events before handling the stop request, and report a failure
+  _this->event_enqueue(_this->event, 1);
+  _this->get_clock()->stop_engine(nb_errors != 0);
+}
+
+int router_bench::build()
+{
+  traces.new_trace("trace", &trace, vp::DEBUG);
+
+  new_master_port("out", &out);
+
+  this->event = this->event_new(router_bench::handler);
+
+  this->base = this->get_js_config()->get_child_int("base");
+  this->size = this->get_js_config()->get_child_int("size");
+  this->nb_requests = this->get_js_config()->get_child_int("nb_requests");
+
+  return 0;
+}
+
+void router_bench::reset(bool active)
+{
+  if (!active)
+  {
+    this->event_enqueue(this->event, 1);
+  }
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+  return new router_bench(config);
+}
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2021 GreenWaves Technologies, SAS
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Measures the number of requests per second routed by interco.router_impl
+# depending on its number of mappings. For each number of mappings, a system
+# made of the interco.router_bench traffic generator, the router and one
+# memory per mapping is simulated with gvsoc_launcher.
+#
+# Example:
+#   GVSOC_PATH=<install>/models ./router_bench.py --mappings 4 32 256
+#
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def get_config(nb_mappings, mapping_size, nb_requests):
+
+    components = ['clock', 'bench', 'router']
+    bindings = [
+        ['clock->out', 'bench->clock'],
+        ['clock->out', 'router->clock'],
+        ['bench->out', 'router->input']
+    ]
+
+    target = {
+        'vp_component': 'utils.composite_impl',
+        'clock': {'vp_component': 'vp.clock_domain_impl', 'frequency': 100000000},
+        'bench': {
+            'vp_component': 'interco.router_bench',
+            'base': 0,
+            'size': nb_mappings * mapping_size,
+            'nb_requests': nb_requests
+        },
+        'router': {
+            'vp_component': 'interco.router_impl',
+            'latency': 0,
+            'bandwidth': 0,
+            'remove_offset': 0,
+            'mappings': {}
+        }
+    }
+
+    for i in range(0, nb_mappings):
+        name = 'mem%d' % i
+        components.append(name)
+        target[name] = {
+            'vp_component': 'memory.memory_impl', 'size': mapping_size, 'width_bits': 0,
+            'stim_file': '', 'power_trace': False, 'align': 0, 'check': False, 'latency': 0,
+            'atomics': False
+        }
+        target['router']['mappings'][name] = {
+            'base': i * mapping_size, 'size': mapping_size, 'remove_offset': i * mapping_size
+        }
+        bindings.append(['clock->out', '%s->clock' % name])
+        bindings.append(['router->%s' % name, '%s->input' % name])
+
+    target['components'] = components
+    target['bindings'] = bindings
+
+    return {
+        'gvsoc': {
+            'sa-mode': True,
+            'traces': {'level': 'info', 'include_regex': [], 'format': 'long'},
+            'events': {'include_regex': [], 'include_raw': []}
+        },
+        'target': target
+    }
+
+
+parser = argparse.ArgumentParser(description='Measure the router throughput')
+
+parser.add_argument("--launcher", dest="launcher", default="gvsoc_launcher",
+    help="Path to gvsoc_launcher")
+parser.add_argument("--mappings", dest="mappings", type=int, nargs='+', default=[4, 32, 256],
+    help="Numbers of mappings to measure")
+parser.add_argument("--requests", dest="requests", type=int, default=10000000,
+    help="Number of requests issued for each measure")
+parser.add_argument("--mapping-size", dest="mapping_size", type=int, default=4096,
+    help="Size of each mapping")
+
+args = parser.parse_args()
+
+with tempfile.TemporaryDirectory() as tmpdir:
+    for nb_mappings in args.mappings:
+        config_path = os.path.join(tmpdir, 'router_bench_%d.json' % nb_mappings)
+        with open(config_path, 'w') as file:
+            json.dump(get_config(nb_mappings, args.mapping_size, args.requests), file, indent=2)
+
+        print('%d mappings: ' % nb_mappings, end='', flush=True)
+        if subprocess.run([args.launcher, '--config=' + config_path]).returncode != 0:
+            sys.exit('Benchmark failed with %d mappings' % nb_mappings)
@@ -25,6 +25,29 @@
 #include <vp/proxy.hpp>
 #include <stdio.h>
 #include <math.h>
+#include <algorithm>
+
+// Number of mappings which are remembered to quickly route requests going to recently used targets
+#define ROUTER_CACHE_SIZE 2
+
+// Up to this number of mappings, the routing table is searched linearly
+#define ROUTER_LINEAR_SEARCH_MAX 8
+
+// Size of the chunks used to split accesses coming from the proxy
+#define ROUTER_PROXY_CHUNK_SIZE (64*1024)
+
+// Maximum number of accesses of a proxy mem_batch command
+#define ROUTER_PROXY_MAX_ACCESSES (1024*1024)
+
+#define ROUTER_PROXY_ACCESS_WRITE (1<<0)
+
+// Descriptor of one access of a proxy mem_batch command, as sent by the client
+typedef struct
+{
+  uint64_t addr;
+  uint32_t size;
+  uint32_t flags;
+} router_proxy_access_t;
 
 class router;
 
@@ -56,7 +79,6 @@ public:
 class MapEntry {
 public:
   MapEntry() {}
-  MapEntry(unsigned long long base, MapEntry *left, MapEntry *right);
 
   void insert(router *router);
 
@@ -64,18 +86,25 @@ public:
   MapEntry *next = NULL;
   int id = -1;
   unsigned long long base = 0;
-  unsigned long long lowestBase = 0;
   unsigned long long size = 0;
+  // Last address routed to this mapping, which can be lower than its end if it overlaps the next one
+  unsigned long long route_last = 0;
   unsigned long long remove_offset = 0;
   unsigned long long add_offset = 0;
   uint32_t latency = 0;
   int64_t next_packet_time = 0;
-  MapEntry *left = NULL;
-  MapEntry *right = NULL;
   vp::io_slave *port = NULL;
   vp::io_master *itf = NULL;
 };
 
+// Address range of a recently used mapping, with precomputed bounds for a quick check
+class MapCacheEntry {
+public:
+  uint64_t base = 1;
+  uint64_t last = 0;
+  MapEntry *entry = NULL;
+};
+
 class io_master_map : public vp::io_master
 {
 
@@ -97,6 +126,9 @@ public:
 
   static vp::io_req_status_e req(void *__this, vp::io_req *req);
 
+  static vp::io_req_status_e dmi_req(void *__this, uint64_t addr, vp::io_dmi *dmi);
+
+  static void dmi_invalidate(void *__this);
 
   static void grant(void *_this, vp::io_req *req);
 
@@ -110,17 +142,33 @@ private:
   bool init = false;
 
   void init_entries();
+  inline MapEntry *get_entry(uint64_t offset, uint64_t size);
+  inline MapEntry *search_entry(uint64_t offset);
   MapEntry *firstMapEntry = NULL;
   MapEntry *defaultMapEntry = NULL;
   MapEntry *errorMapEntry = NULL;
-  MapEntry *topMapEntry = NULL;
   MapEntry *externalBindingMapEntry = NULL;
 
+  // Routing table, as mappings sorted by base address, with bases stored apart so that the
+  // search only goes through them
+  std::vector<uint64_t> entry_bases;
+  std::vector<MapEntry *> entries;
+
+  // Most recently used mappings, the first one being the last one hit
+  MapCacheEntry cache[ROUTER_CACHE_SIZE];
+
   std::map<int, Perf_counter *> counters;
 
   int bandwidth = 0;
   int latency = 0;
   vp::io_req proxy_req;
+
+  // Buffer reused by all proxy accesses, which are split into chunks of this size
+  // so that large transfers are streamed without allocating the full payload
+  std::vector<uint8_t> proxy_buffer;
+
+  int proxy_access(FILE *req_file, FILE *reply_file, uint64_t addr, uint64_t size, bool is_write);
+  std::string proxy_mem_batch(Gv_proxy *proxy, FILE *req_file, FILE *reply_file, int nb_accesses, std::string cmd_req);
 };
 
 router::router(js::config *config)
@@ -129,13 +177,8 @@ router::router(js::config *config)
 
 }
 
-MapEntry::MapEntry(unsigned long long base, MapEntry *left, MapEntry *right) : next(NULL), base(base), lowestBase(left->lowestBase), left(left), right(right) {
-}
-
 void MapEntry::insert(router *router)
 {
-  lowestBase = base;
-
   if (size != 0) {
     if (port != NULL || itf != NULL) {    
       MapEntry *current = router->firstMapEntry;
@@ -161,6 +204,95 @@ void MapEntry::insert(router *router)
   }
 }
 
+// Returns the mapping with the highest base below the offset, or NULL if there is none
+inline MapEntry *router::search_entry(uint64_t offset)
+{
+  int64_t nb_entries = this->entries.size();
+  const uint64_t *bases = this->entry_bases.data();
+  int64_t index;
+
+  if (nb_entries <= ROUTER_LINEAR_SEARCH_MAX)
+  {
+    index = -1;
+    while (index + 1 < nb_entries && bases[index + 1] <= offset)
+    {
+      index++;
+    }
+    if (index == -1)
+    {
+      return NULL;
+    }
+  }
+  else
+  {
+    // Branchless binary search, the compiler turns the selection into a conditional move
+    index = 0;
+    while (nb_entries > 1)
+    {
+      int64_t half = nb_entries >> 1;
+      index = bases[index + half] <= offset ? index + half : index;
+      nb_entries -= half;
+    }
+    if (bases[index] > offset)
+    {
+      return NULL;
+    }
+  }
+
+  return this->entries[index];
+}
+
+inline MapEntry *router::get_entry(uint64_t offset, uint64_t size)
+{
+  // Most requests are going to the same targets, check the recently used ones first
+  if (likely(offset >= this->cache[0].base && offset <= this->cache[0].last))
+  {
+    return this->cache[0].entry;
+  }
+
+  for (int i=1; i<ROUTER_CACHE_SIZE; i++)
+  {
+    if (offset >= this->cache[i].base && offset <= this->cache[i].last)
+    {
+      MapCacheEntry hit = this->cache[i];
+      for (int j=i; j>0; j--)
+      {
+        this->cache[j] = this->cache[j-1];
+      }
+      this->cache[0] = hit;
+      return hit.entry;
+    }
+  }
+
+  MapEntry *entry = this->search_entry(offset);
+
+  if (entry && (offset < entry->base || offset > entry->base + entry->size - 1)) {
+    entry = NULL;
+  }
+
+  if (entry)
+  {
+    // Only real mappings are cached, since the default and error ones depend on the
+    // other mappings
+    for (int j=ROUTER_CACHE_SIZE-1; j>0; j--)
+    {
+      this->cache[j] = this->cache[j-1];
+    }
+    this->cache[0].base = entry->base;
+    this->cache[0].last = entry->route_last;
+    this->cache[0].entry = entry;
+  }
+  else
+  {
+    if (this->errorMapEntry && offset >= this->errorMapEntry->base && offset + size - 1 <= this->errorMapEntry->base + this->errorMapEntry->size - 1) {
+    } else {
+      entry = this->defaultMapEntry;
+    }
+  }
+
+  return entry;
+}
+
 vp::io_req_status_e router::req(void *__this, vp::io_req *req)
 {
   router *_this = (router *)__this;
@@ -182,33 +314,12 @@ vp::io_req_status_e router::req(void *__this, vp::io_req *req)
   int count = 0;
   while (size)
   {
-    MapEntry *entry = _this->topMapEntry;
     bool isRead = !req->get_is_write();
 
     _this->trace.msg(vp::trace::LEVEL_TRACE, "Received IO req (offset: 0x%llx, size: 0x%llx, isRead: %d, bandwidth: %d)\n",
         offset, size, isRead, _this->bandwidth);
 
-    if (entry)
-    {
-      while(1) {
-      // The entry does not have any child, this means we are at a final entry
-        if (entry->left == NULL) break;
-
-        if (offset >= entry->base) entry = entry->right;
-        else entry = entry->left;
-      }
-
-      if (entry && (offset < entry->base || offset > entry->base + entry->size - 1)) {
-        entry = NULL;
-      }
-    }
-
-    if (!entry) {
-      if (_this->errorMapEntry && offset >= _this->errorMapEntry->base && offset + size - 1 <= _this->errorMapEntry->base + _this->errorMapEntry->size - 1) {
-      } else {
-        entry = _this->defaultMapEntry;
-      }
-    }
+    MapEntry *entry = _this->get_entry(offset, size);
 
     if (!entry) {
       //_this->trace.msg(&warning, "Invalid access (offset: 0x%llx, size: 0x%llx, isRead: %d)\n", offset, size, isRead);
@@ -329,6 +440,97 @@ vp::io_req_status_e router::req(void *__this, vp::io_req *req)
   return result;
 }
 
+vp::io_req_status_e router::dmi_req(void *__this, uint64_t addr, vp::io_dmi *dmi)
+{
+  router *_this = (router *)__this;
+
+  if (!_this->init)
+  {
+    _this->init = true;
+    _this->init_entries();
+  }
+
+  // Direct accesses would bypass bandwidth modeling and per-target counters,
+  // only grant them when none of them is active.
+  if (_this->bandwidth != 0)
+    return vp::IO_REQ_INVALID;
+
+  MapEntry *entry = _this->get_entry(addr, 1);
+
+  if (!entry || entry->id != -1 || !entry->itf || !entry->itf->is_bound())
+    return vp::IO_REQ_INVALID;
+
+  uint64_t offset = addr;
+  if (entry->remove_offset) offset -= entry->remove_offset;
+  if (entry->add_offset) offset += entry->add_offset;
+
+  vp::io_req_status_e result = entry->itf->dmi_req(offset, dmi);
+  if (result != vp::IO_REQ_OK)
+    return result;
+
+  // Translate the window back into our address space and clip it to the
+  // mapping so that accesses outside it are still routed
+  uint64_t base = dmi->base - offset + addr;
+  uint64_t end = base + dmi->size;
+
+  uint64_t map_base, map_end;
+  if (entry != _this->defaultMapEntry)
+  {
+    map_base = entry->base;
+    map_end = entry->base + entry->size;
+  }
+  else
+  {
+    // The default mapping only gets the accesses falling in the gap between the
+    // mappings around the address, outside the error range
+    MapEntry *prev = _this->search_entry(addr);
+    MapEntry *next = prev ? prev->next : _this->firstMapEntry;
+    map_base = prev ? prev->base + prev->size : 0;
+    map_end = next ? next->base : UINT64_MAX;
+
+    MapEntry *error = _this->errorMapEntry;
+    if (error)
+    {
+      if (error->base > addr && error->base < map_end)
+      {
+        map_end = error->base;
+      }
+      else if (error->base <= addr && error->base + error->size > map_base)
+      {
+        map_base = error->base + error->size;
+      }
+    }
+  }
+
+  if (base < map_base)
+  {
+    dmi->data += map_base - base;
+    base = map_base;
+  }
+  if (end > map_end)
+  {
+    end = map_end;
+  }
+
+  _this->trace.msg(vp::trace::LEVEL_DEBUG, "Granted DMI (addr: 0x%llx, base: 0x%llx, size: 0x%llx, target: %s)\n",
+    addr, base, end - base, entry->target_name.c_str());
+
+  dmi->base = base;
+  dmi->size = end - base;
+  dmi->latency += entry->latency + _this->latency;
+
+  return vp::IO_REQ_OK;
+}
+
+void router::dmi_invalidate(void *__this)
+{
+  router *_this = (router *)__this;
+
+  // Any window granted by one of our targets has been forwarded to our
+  // initiators, propagate the invalidation
+  _this->in.dmi_invalidate();
+}
+
 void router::grant(void *__this, vp::io_req *req)
 {
   router *_this = (router *)__this;
@@ -350,30 +552,31 @@ void router::response(void *_this, vp::io_req *req)
 }
 
 
-std::string router::handle_command(Gv_proxy *proxy, FILE *req_file, FILE *reply_file, std::vector<std::string> args, std::string cmd_req)
+// Executes a debug access coming from the proxy. The data of writes is read from
+// the request file and the data of reads is written to the reply file, chunk by chunk.
+// Returns 1 if the access failed and -1 if the request or reply file could not be
+// read or written, in which case the streams are not synchronized anymore.
+int router::proxy_access(FILE *req_file, FILE *reply_file, uint64_t addr, uint64_t size, bool is_write)
 {
-    if (args[0] == "mem_write" or args[0] == "mem_read")
-    {
-        int error = 0;
-        bool is_write = args[0] == "mem_write";
-        long long int addr = strtoll(args[1].c_str(), NULL, 0);
-        long long int size = strtoll(args[2].c_str(), NULL, 0);
+    int error = 0;
+    uint8_t *buffer = this->proxy_buffer.data();
 
-        uint8_t *buffer = new uint8_t[size];
+    while (size > 0)
+    {
+        uint64_t chunk_size = std::min(size, (uint64_t)this->proxy_buffer.size());
 
         if (is_write)
         {
-            int read_size = fread(buffer, 1, size, req_file);
-            if (read_size != size)
+            if (fread(buffer, 1, chunk_size, req_file) != chunk_size)
             {
-                error = 1;
+                return -1;
             }
         }
 
         vp::io_req *req = &this->proxy_req;
-        req->set_data((uint8_t *)buffer);
+        req->set_data(buffer);
         req->set_is_write(is_write);
-        req->set_size(size);
+        req->set_size(chunk_size);
         req->set_addr(addr);
         req->set_debug(true);
 
@@ -382,13 +585,148 @@ std::string router::handle_command(Gv_proxy *proxy, FILE *req_file, FILE *reply_
 
         if (!is_write)
         {
-            error = proxy->send_payload(reply_file, cmd_req, buffer, size);
+            if (fwrite(buffer, 1, chunk_size, reply_file) != chunk_size)
+            {
+                return -1;
+            }
         }
 
-        delete[] buffer;
+        addr += chunk_size;
+        size -= chunk_size;
+    }
+
+    return error;
+}
+
+
+// Batch of memory accesses. The command is followed by a binary frame containing
+// the descriptors of all accesses, followed by the data of all writes, in the same
+// order. The reply payload contains the data of all reads, followed by one status
+// byte per access.
+// The client always waits for the payload, so it is sent even if the command is
+// rejected, with no data in this case.
+std::string router::proxy_mem_batch(Gv_proxy *proxy, FILE *req_file, FILE *reply_file, int nb_accesses, std::string cmd_req)
+{
+    if (nb_accesses < 0 || nb_accesses > ROUTER_PROXY_MAX_ACCESSES)
+    {
+        this->trace.force_warning("Invalid number of accesses in proxy batch (nb_accesses: %d)\n", nb_accesses);
+        proxy->send_payload_header(reply_file, cmd_req, 0);
+        fflush(reply_file);
+        return "err=1";
+    }
+
+    std::vector<router_proxy_access_t> accesses(nb_accesses);
+
+    if (fread(accesses.data(), sizeof(router_proxy_access_t), nb_accesses, req_file) != (size_t)nb_accesses)
+    {
+        proxy->send_payload_header(reply_file, cmd_req, 0);
+        fflush(reply_file);
+        return "err=1";
+    }
+
+    uint64_t payload_size = nb_accesses;
+    for (auto &access: accesses)
+    {
+        if (!(access.flags & ROUTER_PROXY_ACCESS_WRITE))
+        {
+            payload_size += access.size;
+        }
+    }
+
+    std::vector<uint8_t> status(nb_accesses);
+    int error = 0;
+    bool stream_error = false;
+
+    proxy->send_payload_header(reply_file, cmd_req, payload_size);
+
+    for (int i=0; i<nb_accesses; i++)
+    {
+        router_proxy_access_t *access = &accesses[i];
+        bool is_write = access->flags & ROUTER_PROXY_ACCESS_WRITE;
+
+        // Once the write data could not be read, the following accesses are not
+        // executed but the data of reads is still sent, as zeros, so that the reply
+        // has the announced size and the client can see the failed accesses.
+        if (stream_error)
+        {
+            if (!is_write)
+            {
+                std::fill(this->proxy_buffer.begin(), this->proxy_buffer.end(), 0);
+                uint64_t size = access->size;
+                while (size > 0)
+                {
+                    uint64_t chunk_size = std::min(size, (uint64_t)this->proxy_buffer.size());
+                    fwrite(this->proxy_buffer.data(), 1, chunk_size, reply_file);
+                    size -= chunk_size;
+                }
+            }
+            status[i] = 1;
+        }
+        else
+        {
+            int result = this->proxy_access(req_file, reply_file, access->addr, access->size, is_write);
+            stream_error = result < 0;
+            status[i] = result != 0;
+        }
+
+        error |= status[i];
+    }
+
+    fwrite(status.data(), 1, nb_accesses, reply_file);
+    fflush(reply_file);
+
+    return "err=" + std::to_string(error);
+}
+
+
+std::string router::handle_command(Gv_proxy *proxy, FILE *req_file, FILE *reply_file, std::vector<std::string> args, std::string cmd_req)
+{
+    if (args[0] == "mem_write" or args[0] == "mem_read")
+    {
+        int error = 0;
+        bool is_write = args[0] == "mem_write";
+        long long int addr = strtoll(args[1].c_str(), NULL, 0);
+        long long int size = strtoll(args[2].c_str(), NULL, 0);
+
+        if (size < 0)
+        {
+            if (!is_write)
+            {
+                proxy->send_payload_header(reply_file, cmd_req, 0);
+                fflush(reply_file);
+            }
+            return "err=1";
+        }
+
+        if (!is_write)
+        {
+            proxy->send_payload_header(reply_file, cmd_req, size);
+        }
+
+        error = this->proxy_access(req_file, reply_file, addr, size, is_write) != 0;
+
+        if (!is_write)
+        {
+            fflush(reply_file);
+        }
 
         return "err=" + std::to_string(error);
     }
+    else if (args[0] == "mem_batch")
+    {
+        // Anything which is not a valid count is rejected by the batch
+        long nb_accesses = -1;
+        if (args.size() >= 2)
+        {
+            char *end;
+            long value = strtol(args[1].c_str(), &end, 0);
+            if (end != args[1].c_str() && *end == 0 && value <= ROUTER_PROXY_MAX_ACCESSES)
+            {
+                nb_accesses = value;
+            }
+        }
+        return this->proxy_mem_batch(proxy, req_file, reply_file, nb_accesses, cmd_req);
+    }
     return "err=1";
 }
 
@@ -398,6 +736,7 @@ int router::build()
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   in.set_req_meth(&router::req);
+  in.set_dmi_meth(&router::dmi_req);
   new_slave_port("input", &in);
 
   out.set_resp_meth(&router::response);
@@ -409,7 +748,7 @@ int router::build()
 
   js::config *mappings = get_js_config()->get("mappings");
 
-  this->proxy_req.set_data(new uint8_t[4]);
+  this->proxy_buffer.resize(ROUTER_PROXY_CHUNK_SIZE);
 
 
   if (mappings != NULL)
@@ -425,6 +764,7 @@ int router::build()
 
       itf->set_resp_meth(&router::response);
       itf->set_grant_meth(&router::grant);
+      itf->set_dmi_invalidate_meth(&router::dmi_invalidate);
       new_master_port(mapping.first, itf);
 
       if (mapping.first == "error")
@@ -486,8 +826,6 @@ extern "C" vp::component *vp_constructor(js::config *config)
 
 
 
-#define max(a, b) ((a) > (b) ? (a) : (b))
-
 void router::init_entries() {
 
   MapEntry *current = firstMapEntry;
@@ -503,52 +841,19 @@ void router::init_entries() {
     trace.msg(vp::trace::LEVEL_INFO, "       -     :      -     -> %s\n", defaultMapEntry->target_name.c_str());
   }
 
-  MapEntry *firstInLevel = firstMapEntry;
-
-  // Loop until we merged everything into a single entry
-  // Start with the routing table entries
-  current = firstMapEntry;
-
-  // The first loop is here to loop until we have merged everything to a single entry
-  while(1) {
-
-    // Gives the map entry that should be on the left side of the next created entry
-    MapEntry *left = NULL;
-
-    // Gives the last allocated entry where the entry should be inserted
-    MapEntry *currentInLevel=NULL;
-
-    // The second loop is iterating on a single level to merge entries 2 by 2
-    while(current) {
-      if (left == NULL) left = current;
-      else {
-
-        MapEntry *entry = new MapEntry(current->lowestBase, left, current);
-
-        left = NULL;
-        if (currentInLevel) {
-          currentInLevel->next = entry;
-        } else {
-          firstInLevel = entry;
-        }
-        currentInLevel = entry;
-      }
-
-      current = current->next;
-    }
-
-    current = firstInLevel;
-
-    // Stop in case we got a single entry
-    if (currentInLevel == NULL) break;
-
-    // In case an entry is alone, insert it at the end, it will be merged with an upper entry
-    if (left != NULL) {
-      currentInLevel->next = left;
+  // Flatten the sorted list of mappings into the routing table
+  this->entry_bases.clear();
+  this->entries.clear();
+  for (current = firstMapEntry; current; current = current->next)
+  {
+    current->route_last = current->base + current->size - 1;
+    if (current->next && current->next->base <= current->route_last)
+    {
+      current->route_last = current->next->base - 1;
     }
+    this->entry_bases.push_back(current->base);
+    this->entries.push_back(current);
   }
-
-  topMapEntry = firstInLevel;
 }
 
 inline void io_master_map::bind_to(vp::port *_port, vp::config *config)
@@ -0,0 +1,626 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+/*
+ * DRAM controller model with bank and row-buffer timing.
+ *
+ * Requests are queued per channel and issued one after the other by a scheduler
+ * running on the component clock. Each bank keeps track of its open row, so
+ * that accesses are timed as row hits (tCL), row misses (tRCD + tCL) or row
+ * conflicts (tRP + tRCD + tCL). Banks of a rank are closed and blocked during
+ * tRFC every tREFI cycles for the refresh. All timings are in cycles of the
+ * component clock.
+ *
+ * The data is read or written when the request is received, only the
+ * response is delayed.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <deque>
+
+
+typedef struct
+{
+  int64_t open_row;          // Row currently in the row buffer, -1 if the bank is closed
+  int64_t cmd_ready;         // Cycle from which a new column command can be issued
+  int64_t precharge_ready;   // Cycle from which the bank can be precharged (tRAS, tWR)
+} dram_bank_t;
+
+
+typedef struct
+{
+  int64_t next_refresh;      // Cycle of the next refresh of the rank
+} dram_rank_t;
+
+
+typedef struct
+{
+  vp::io_req *req;
+  int64_t end;               // Cycle at which the last data of the request is transferred
+} dram_inflight_t;
+
+
+class dram;
+
+class dram_channel
+{
+public:
+  dram_channel(dram *top, int id);
+
+  inline void trace_queue()
+  {
+    uint32_t nb_reqs = this->pending_reqs.size();
+    this->queue_event.event((uint8_t *)&nb_reqs);
+  }
+
+  int id;
+  std::vector<dram_bank_t> banks;
+  std::vector<dram_rank_t> ranks;
+  std::deque<vp::io_req *> pending_reqs;
+  std::deque<dram_inflight_t> inflight_reqs;
+  int64_t next_issue;        // Cycle from which the scheduler can issue the next request
+  int64_t bus_ready;         // Cycle from which the data bus is free
+  int nb_consecutive_hits;
+  vp::clock_event *event;
+  vp::trace queue_event;
+};
+
+
+class dram : public vp::component
+{
+
+  friend class dram_channel;
+
+public:
+
+  dram(js::config *config);
+
+  int build();
+  void start();
+  void stop();
+  void reset(bool active);
+
+  static vp::io_req_status_e req(void *__this, vp::io_req *req);
+
+private:
+
+  static void channel_handler(void *__this, vp::clock_event *event);
+  void decode(uint64_t addr, int *channel, int *rank, int *bank, int64_t *row);
+  void refresh(dram_channel *channel, int rank, int64_t cycles);
+  int select_req(dram_channel *channel);
+  void issue_req(dram_channel *channel, int64_t cycles);
+  void check_channel(dram_channel *channel, int64_t cycles);
+  void account_bandwidth(uint64_t size, int64_t cycles);
+
+  vp::trace     trace;
+  vp::io_slave in;
+
+  uint64_t size = 0;
+  uint8_t *mem_data;
+
+  int nb_channels;
+  int nb_ranks;
+  int nb_banks;
+  uint64_t row_size;
+  int bus_width;
+  bool open_page;
+  bool fr_fcfs;
+  int queue_size;
+  int max_row_hits;
+
+  int t_rcd;
+  int t_rp;
+  int t_cl;
+  int t_ras;
+  int t_wr;
+  int t_rfc;
+  int t_refi;
+
+  std::vector<dram_channel *> channels;
+
+  // Statistics
+  uint64_t nb_reads;
+  uint64_t nb_writes;
+  uint64_t nb_bytes;
+  uint64_t nb_row_hits;
+  uint64_t nb_row_misses;
+  uint64_t nb_row_conflicts;
+  uint64_t nb_refreshes;
+  int64_t first_access;
+  int64_t last_access;
+
+  int bandwidth_period;
+  int64_t period_start;
+  uint64_t period_bytes;
+
+  vp::trace bandwidth_event;
+  vp::trace row_hits_event;
+  vp::trace row_misses_event;
+  vp::trace row_conflicts_event;
+  vp::trace refreshes_event;
+};
+
+
+dram_channel::dram_channel(dram *top, int id)
+: id(id)
+{
+  this->banks.resize(top->nb_ranks * top->nb_banks);
+  this->ranks.resize(top->nb_ranks);
+  this->event = top->event_new(&dram::channel_handler, (void *)this);
+  top->traces.new_trace_event("channel_" + std::to_string(id) + "/queue", &this->queue_event, 32);
+}
+
+
+dram::dram(js::config *config)
+: vp::component(config)
+{
+
+}
+
+
+// Address mapping is row:rank:bank:channel:column, so that consecutive rows
+// are spread over channels and banks
+void dram::decode(uint64_t addr, int *channel, int *rank, int *bank, int64_t *row)
+{
+  uint64_t index = addr / this->row_size;
+  *channel = index % this->nb_channels;
+  index /= this->nb_channels;
+  *bank = index % this->nb_banks;
+  index /= this->nb_banks;
+  *rank = index % this->nb_ranks;
+  *row = index / this->nb_ranks;
+}
+
+
+vp::io_req_status_e dram::req(void *__this, vp::io_req *req)
+{
+  dram *_this = (dram *)__this;
+
+  uint64_t offset = req->get_addr();
+  uint8_t *data = req->get_data();
+  uint64_t size = req->get_size();
+
+  _this->trace.msg("DRAM access (offset: 0x%x, size: 0x%x, is_write: %d)\n", offset, size, req->get_is_write());
+
+  if (offset + size > _this->size) {
+    _this->trace.force_warning("Received out-of-bound request (reqAddr: 0x%x, reqSize: 0x%x, memSize: 0x%x)\n", offset, size, _this->size);
+    return vp::IO_REQ_INVALID;
+  }
+
+  if (req->get_is_write()) {
+    if (data)
+      memcpy((void *)&_this->mem_data[offset], (void *)data, size);
+  } else {
+    if (data)
+      memcpy((void *)data, (void *)&_this->mem_data[offset], size);
+  }
+
+  if (req->is_debug())
+  {
+    return vp::IO_REQ_OK;
+  }
+
+  int channel_id, rank, bank;
+  int64_t row;
+  _this->decode(offset, &channel_id, &rank, &bank, &row);
+
+  dram_channel *channel = _this->channels[channel_id];
+  channel->pending_reqs.push_back(req);
+  channel->trace_queue();
+
+  _this->check_channel(channel, _this->get_cycles());
+
+  return vp::IO_REQ_PENDING;
+}
+
+
+// Refreshes are applied when the rank is accessed, by blocking all its banks
+// during tRFC for each refresh which was due.
+void dram::refresh(dram_channel *channel, int rank, int64_t cycles)
+{
+  dram_rank_t *rank_state = &channel->ranks[rank];
+
+  if (this->t_refi == 0)
+  {
+    return;
+  }
+
+  // Refreshes which happened while the rank was idle only need to be counted,
+  // the last one is applied normally below
+  if (cycles - rank_state->next_refresh >= this->t_refi)
+  {
+    int64_t nb_skipped = (cycles - rank_state->next_refresh) / this->t_refi;
+    rank_state->next_refresh += nb_skipped * this->t_refi;
+    this->nb_refreshes += nb_skipped;
+  }
+
+  while (cycles >= rank_state->next_refresh)
+  {
+    for (int i=0; i<this->nb_banks; i++)
+    {
+      dram_bank_t *bank = &channel->banks[rank*this->nb_banks + i];
+      int64_t start = std::max(bank->cmd_ready, rank_state->next_refresh);
+
+      // Open banks are first precharged
+      if (bank->open_row != -1)
+      {
+        start = std::max(start, bank->precharge_ready) + this->t_rp;
+        bank->open_row = -1;
+      }
+
+      bank->cmd_ready = start + this->t_rfc;
+      bank->precharge_ready = bank->cmd_ready;
+    }
+
+    rank_state->next_refresh += this->t_refi;
+    this->nb_refreshes++;
+    this->refreshes_event.event((uint8_t *)&this->nb_refreshes);
+  }
+}
+
+
+// Returns the index of the next request to be issued in the channel queue.
+// With FR-FCFS, the oldest request hitting an open row is preferred to the oldest
+// request, unless too many row hits were already served in a row.
+int dram::select_req(dram_channel *channel)
+{
+  if (!this->fr_fcfs || channel->nb_consecutive_hits >= this->max_row_hits)
+  {
+    return 0;
+  }
+
+  int window = std::min((int)channel->pending_reqs.size(), this->queue_size);
+
+  for (int i=0; i<window; i++)
+  {
+    int channel_id, rank, bank;
+    int64_t row;
+    this->decode(channel->pending_reqs[i]->get_addr(), &channel_id, &rank, &bank, &row);
+
+    if (channel->banks[rank*this->nb_banks + bank].open_row == row)
+    {
+      return i;
+    }
+  }
+
+  return 0;
+}
+
+
+void dram::issue_req(dram_channel *channel, int64_t cycles)
+{
+  int index = this->select_req(channel);
+  vp::io_req *req = channel->pending_reqs[index];
+  channel->pending_reqs.erase(channel->pending_reqs.begin() + index);
+  channel->trace_queue();
+
+  uint64_t size = req->get_size();
+  bool is_write = req->get_is_write();
+  int channel_id, rank, bank_id;
+  int64_t row;
+  this->decode(req->get_addr(), &channel_id, &rank, &bank_id, &row);
+
+  this->refresh(channel, rank, cycles);
+
+  dram_bank_t *bank = &channel->banks[rank*this->nb_banks + bank_id];
+  int64_t start = std::max(cycles, bank->cmd_ready);
+  int64_t cas;
+
+  if (bank->open_row == row)
+  {
+    cas = start;
+    this->nb_row_hits++;
+    channel->nb_consecutive_hits++;
+    this->row_hits_event.event((uint8_t *)&this->nb_row_hits);
+  }
+  else
+  {
+    int64_t activate = start;
+
+    if (bank->open_row != -1)
+    {
+      activate = std::max(start, bank->precharge_ready) + this->t_rp;
+      this->nb_row_conflicts++;
+      this->row_conflicts_event.event((uint8_t *)&this->nb_row_conflicts);
+    }
+    else
+    {
+      this->nb_row_misses++;
+      this->row_misses_event.event((uint8_t *)&this->nb_row_misses);
+    }
+
+    cas = activate + this->t_rcd;
+    bank->open_row = row;
+    bank->precharge_ready = activate + this->t_ras;
+    channel->nb_consecutive_hits = 0;
+  }
+
+  int64_t burst = std::max((int64_t)((size + this->bus_width - 1) / this->bus_width), (int64_t)1);
+  int64_t data_start = std::max(cas + this->t_cl, channel->bus_ready);
+  int64_t end = data_start + burst;
+
+  bank->cmd_ready = cas + burst;
+  bank->precharge_ready = std::max(bank->precharge_ready, is_write ? end + this->t_wr : end);
+
+  // With the closed-page policy, the row is precharged as soon as the access is done
+  if (!this->open_page)
+  {
+    bank->open_row = -1;
+    bank->cmd_ready = std::max(bank->cmd_ready, bank->precharge_ready + this->t_rp);
+  }
+
+  channel->bus_ready = end;
+
+  // The next request is selected while this one is transferring its data, so
+  // that the requests received in the meantime are considered.
+  channel->next_issue = std::max(cycles + 1, data_start);
+
+  this->trace.msg(vp::trace::LEVEL_TRACE, "Issuing request (req: %p, channel: %d, rank: %d, bank: %d, row: %ld, is_write: %d, start: %ld, end: %ld)\n",
+    req, channel->id, rank, bank_id, row, is_write, start, end);
+
+  if (is_write)
+    this->nb_writes++;
+  else
+    this->nb_reads++;
+
+  // Keep the in-flight requests sorted by completion time, as a request can
+  // finish before an older one on another bank
+  auto it = channel->inflight_reqs.end();
+  while (it != channel->inflight_reqs.begin() && (it - 1)->end > end)
+  {
+    it--;
+  }
+  channel->inflight_reqs.insert(it, { req, end });
+}
+
+
+void dram::account_bandwidth(uint64_t size, int64_t cycles)
+{
+  if (this->first_access == -1)
+  {
+    this->first_access = cycles;
+    this->period_start = cycles;
+  }
+  this->last_access = cycles;
+
+  this->nb_bytes += size;
+  this->period_bytes += size;
+
+  // The bandwidth is reported in bytes per cycle over periods of bandwidth_period cycles
+  if (cycles - this->period_start >= this->bandwidth_period)
+  {
+    this->bandwidth_event.event_real((double)this->period_bytes / (cycles - this->period_start));
+    this->period_start = cycles;
+    this->period_bytes = 0;
+  }
+}
+
+
+void dram::check_channel(dram_channel *channel, int64_t cycles)
+{
+  int64_t next = -1;
+
+  if (!channel->inflight_reqs.empty())
+  {
+    next = channel->inflight_reqs.front().end;
+  }
+
+  if (!channel->pending_reqs.empty() && (next == -1 || channel->next_issue < next))
+  {
+    next = channel->next_issue;
+  }
+
+  if (next != -1)
+  {
+    int64_t delay = std::max(next - cycles, (int64_t)0);
+
+    if (channel->event->is_enqueued())
+    {
+      this->event_cancel(channel->event);
+    }
+    this->event_enqueue(channel->event, delay == 0 ? 1 : delay);
+  }
+}
+
+
+void dram::channel_handler(void *__this, vp::clock_event *event)
+{
+  dram *_this = (dram *)__this;
+  dram_channel *channel = (dram_channel *)event->get_args()[0];
+  int64_t cycles = _this->get_cycles();
+
+  while (!channel->pending_reqs.empty() && cycles >= channel->next_issue)
+  {
+    _this->issue_req(channel, cycles);
+  }
+
+  while (!channel->inflight_reqs.empty() && channel->inflight_reqs.front().end <= cycles)
+  {
+    vp::io_req *req = channel->inflight_reqs.front().req;
+    channel->inflight_reqs.pop_front();
+
+    _this->account_bandwidth(req->get_size(), cycles);
+
+    req->get_resp_port()->resp(req);
+  }
+
+  _this->check_channel(channel, cycles);
+}
+
+
+void dram::reset(bool active)
+{
+  if (active)
+  {
+    for (dram_channel *channel: this->channels)
+    {
+      for (dram_bank_t &bank: channel->banks)
+      {
+        bank.open_row = -1;
+        bank.cmd_ready = 0;
+        bank.precharge_ready = 0;
+      }
+
+      for (dram_rank_t &rank: channel->ranks)
+      {
+        rank.next_refresh = this->t_refi;
+      }
+
+      channel->next_issue = 0;
+      channel->bus_ready = 0;
+      channel->nb_consecutive_hits = 0;
+    }
+
+    this->nb_reads = 0;
+    this->nb_writes = 0;
+    this->nb_bytes = 0;
+    this->nb_row_hits = 0;
+    this->nb_row_misses = 0;
+    this->nb_row_conflicts = 0;
+    this->nb_refreshes = 0;
+    this->first_access = -1;
+    this->last_access = -1;
+    this->period_start = 0;
+    this->period_bytes = 0;
+  }
+}
+
+
+int dram::build()
+{
+  traces.new_trace("trace", &trace, vp::DEBUG);
+  in.set_req_meth(&dram::req);
+  new_slave_port("input", &in);
+
+  this->nb_channels = get_config_int("channels");
+  this->nb_ranks = get_config_int("ranks");
+  this->nb_banks = get_config_int("banks");
+  this->row_size = get_config_int("row_size");
+  this->bus_width = get_config_int("bus_width");
+  this->open_page = get_config_str("page_policy") != "closed";
+  this->fr_fcfs = get_config_str("scheduler") == "fr-fcfs";
+  this->queue_size = get_config_int("queue_size");
+  this->max_row_hits = get_config_int("max_row_hits");
+  this->bandwidth_period = get_config_int("bandwidth_period");
+
+  this->t_rcd = get_config_int("timings/tRCD");
+  this->t_rp = get_config_int("timings/tRP");
+  this->t_cl = get_config_int("timings/tCL");
+  this->t_ras = get_config_int("timings/tRAS");
+  this->t_wr = get_config_int("timings/tWR");
+  this->t_rfc = get_config_int("timings/tRFC");
+  this->t_refi = get_config_int("timings/tREFI");
+
+  if (this->nb_channels <= 0 || this->nb_ranks <= 0 || this->nb_banks <= 0 || this->row_size == 0 || this->bus_width <= 0)
+  {
+    this->trace.fatal("Invalid DRAM geometry (channels: %d, ranks: %d, banks: %d, row_size: %ld, bus_width: %d)\n",
+      this->nb_channels, this->nb_ranks, this->nb_banks, this->row_size, this->bus_width);
+    return -1;
+  }
+
+  if (this->max_row_hits <= 0)
+  {
+    this->max_row_hits = INT32_MAX;
+  }
+
+  if (this->queue_size <= 0)
+  {
+    this->queue_size = INT32_MAX;
+  }
+
+  if (this->bandwidth_period <= 0)
+  {
+    this->bandwidth_period = 1000;
+  }
+
+  traces.new_trace_event_real("bandwidth", &this->bandwidth_event);
+  traces.new_trace_event("row_hits", &this->row_hits_event, 64);
+  traces.new_trace_event("row_misses", &this->row_misses_event, 64);
+  traces.new_trace_event("row_conflicts", &this->row_conflicts_event, 64);
+  traces.new_trace_event("refreshes", &this->refreshes_event, 64);
+
+  for (int i=0; i<this->nb_channels; i++)
+  {
+    this->channels.push_back(new dram_channel(this, i));
+  }
+
+  return 0;
+}
+
+
+void dram::start()
+{
+  size = get_config_int("size");
+
+  trace.msg("Building DRAM (size: 0x%lx, channels: %d, ranks: %d, banks: %d, row_size: 0x%lx, page_policy: %s, scheduler: %s)\n",
+    size, this->nb_channels, this->nb_ranks, this->nb_banks, this->row_size, this->open_page ? "open" : "closed",
+    this->fr_fcfs ? "fr-fcfs" : "fcfs");
+
+  mem_data = new uint8_t[size];
+
+  // Initialize the memory with a special value to detect uninitialized
+  // variables
+  memset(mem_data, 0x57, size);
+
+  js::config *stim_file_conf = this->get_js_config()->get("stim_file");
+  if (stim_file_conf != NULL && stim_file_conf->get_str() != "")
+  {
+    string path = stim_file_conf->get_str();
+
+    trace.msg("Preloading memory with stimuli file (path: %s)\n", path.c_str());
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == NULL)
+    {
+      this->trace.fatal("Unable to open stim file: %s, %s\n", path.c_str(), strerror(errno));
+      return;
+    }
+    if (fread(this->mem_data, 1, size, file) == 0)
+    {
+      this->trace.fatal("Failed to read stim file: %s, %s\n", path.c_str(), strerror(errno));
+    }
+    fclose(file);
+  }
+}
+
+
+void dram::stop()
+{
+  uint64_t nb_accesses = this->nb_row_hits + this->nb_row_misses + this->nb_row_conflicts;
+  int64_t duration = this->last_access - this->first_access;
+
+  this->trace.msg(vp::trace::LEVEL_INFO, "DRAM statistics (reads: %ld, writes: %ld, bytes: %ld, bandwidth: %.3f bytes/cycle, row_hits: %ld, row_misses: %ld, row_conflicts: %ld, row_hit_rate: %.2f%%, refreshes: %ld)\n",
+    this->nb_reads, this->nb_writes, this->nb_bytes,
+    duration > 0 ? (double)this->nb_bytes / duration : 0.0,
+    this->nb_row_hits, this->nb_row_misses, this->nb_row_conflicts,
+    nb_accesses ? 100.0 * this->nb_row_hits / nb_accesses : 0.0,
+    this->nb_refreshes);
+}
+
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+  return new dram(config);
+}
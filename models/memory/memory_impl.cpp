@@ -22,8 +22,20 @@
 #include <vp/vp.hpp>
 #include <vp/itf/io.hpp>
 #include <vp/itf/wire.hpp>
+#include <vp/checkpoint.hpp>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Size of the chunk of initial pattern mapped repeatedly over memories allocated with mmap
+#define MEMORY_PATTERN_CHUNK_SIZE (1 << 21)
+
+// Stimuli files smaller than this are copied instead of mapped, as sharing them
+// between simulators does not save much host memory
+#define MEMORY_STIM_MAP_MIN_SIZE (1 << 20)
 
 class memory : public vp::component
 {
@@ -35,12 +47,18 @@ public:
   int build();
   void start();
   void reset(bool active);
+  void checkpoint(vp::checkpoint *cp);
 
   static vp::io_req_status_e req(void *__this, vp::io_req *req);
 
+  static vp::io_req_status_e dmi_req(void *__this, uint64_t addr, vp::io_dmi *dmi);
+
 private:
 
   static void power_ctrl_sync(void *__this, bool value);
+  void trace_callback();
+  static int get_pattern_fd();
+  uint8_t *mmap_alloc(string stim_path);
 
   vp::trace     trace;
   vp::io_slave in;
@@ -181,6 +199,37 @@ vp::io_req_status_e memory::req(void *__this, vp::io_req *req)
   return vp::IO_REQ_OK;
 }
 
+vp::io_req_status_e memory::dmi_req(void *__this, uint64_t addr, vp::io_dmi *dmi)
+{
+  memory *_this = (memory *)__this;
+
+  // Direct accesses are not visible to the memory, only grant them when
+  // nothing needs to observe each access.
+  if (!_this->powered_up || _this->check_mem || _this->width_bits != 0 || _this->power_trigger ||
+    _this->power.get_power_trace()->get_active() || _this->trace.get_active())
+  {
+    return vp::IO_REQ_INVALID;
+  }
+
+  if (addr >= _this->size)
+  {
+    return vp::IO_REQ_INVALID;
+  }
+
+  dmi->base = 0;
+  dmi->size = _this->size;
+  dmi->data = _this->mem_data;
+  dmi->latency = 0;
+
+  return vp::IO_REQ_OK;
+}
+
+void memory::trace_callback()
+{
+  // Accesses must be seen again to be traced or to account their power
+  this->in.dmi_invalidate();
+}
+
 void memory::reset(bool active)
 {
   if (active)
@@ -190,17 +239,36 @@ void memory::reset(bool active)
   }
 }
 
+void memory::checkpoint(vp::checkpoint *cp)
+{
+  cp->value(this->powered_up);
+  cp->pages(this->mem_data, this->size);
+  if (this->check_mem)
+  {
+    cp->pages(this->check_mem, (this->size + 7) / 8);
+  }
+
+  if (cp->is_restore())
+  {
+    this->in.dmi_invalidate();
+  }
+}
+
 void memory::power_ctrl_sync(void *__this, bool value)
 {
     memory *_this = (memory *)__this;
     _this->powered_up = value;
+    _this->in.dmi_invalidate();
 }
 
 
 int memory::build()
 {
   traces.new_trace("trace", &trace, vp::DEBUG);
+  this->trace.register_callback(std::bind(&memory::trace_callback, this));
+  this->power.get_power_trace()->register_callback(std::bind(&memory::trace_callback, this));
   in.set_req_meth(&memory::req);
+  in.set_dmi_meth(&memory::dmi_req);
   new_slave_port("input", &in);
 
   this->power_ctrl_itf.set_sync_meth(&memory::power_ctrl_sync);
@@ -228,8 +296,21 @@ void memory::start()
 
   trace.msg("Building memory (size: 0x%x, check: %d)\n", size, check);
 
-  mem_data = new uint8_t[size];
+  // Preload the memory
+  string stim_path = "";
+  js::config *stim_file_conf = this->get_js_config()->get("stim_file");
+  if (stim_file_conf != NULL)
+  {
+    stim_path = stim_file_conf->get_str();
+  }
 
+  // With mmap, pages are only allocated when they are written, and stimuli
+  // are mapped from the file, so that they are shared between simulators.
+  mem_data = NULL;
+  if (get_config_bool("mmap"))
+  {
+    mem_data = this->mmap_alloc(stim_path);
+  }
 
   // Special option to check for uninitialized accesses
   if (check)
@@ -242,16 +323,15 @@ void memory::start()
   }
 
 
-  // Initialize the memory with a special value to detect uninitialized
-  // variables
-  memset(mem_data, 0x57, size);
+  if (mem_data == NULL)
+  {
+    mem_data = new uint8_t[size];
 
+    // Initialize the memory with a special value to detect uninitialized
+    // variables
+    memset(mem_data, 0x57, size);
 
-  // Preload the memory
-  js::config *stim_file_conf = this->get_js_config()->get("stim_file");
-  if (stim_file_conf != NULL)
-  {
-    string path = stim_file_conf->get_str();
+    string path = stim_path;
     if (path != "")
     {
       trace.msg("Preloading memory with stimuli file (path: %s)\n", path.c_str());
@@ -264,9 +344,12 @@ void memory::start()
       }
       if (fread(this->mem_data, 1, size, file) == 0)
       {
-        this->trace.fatal("Failed to read stim file: %s, %s\n", path.c_str(), strerror(errno));
+        this->trace.fatal("Failed to read stim file: %s, %s\n", path.c_str(),
+          ferror(file) ? strerror(errno) : "empty file");
+        fclose(file);
         return;
       }
+      fclose(file);
     }
   }
 
@@ -275,6 +358,118 @@ void memory::start()
   this->last_access_timestamp = -1;
 }
 
+static int memory_create_pattern_fd()
+{
+  char path[] = "/tmp/gvsoc_memXXXXXX";
+  int pattern_fd = mkstemp(path);
+  if (pattern_fd != -1)
+  {
+    unlink(path);
+
+    uint8_t *pattern = new uint8_t[MEMORY_PATTERN_CHUNK_SIZE];
+    memset(pattern, 0x57, MEMORY_PATTERN_CHUNK_SIZE);
+    if (pwrite(pattern_fd, pattern, MEMORY_PATTERN_CHUNK_SIZE, 0) != MEMORY_PATTERN_CHUNK_SIZE)
+    {
+      close(pattern_fd);
+      pattern_fd = -1;
+    }
+    delete[] pattern;
+  }
+
+  return pattern_fd;
+}
+
+// Get the file containing a chunk of the initial pattern, shared by all the
+// memories of all the simulator instances of the process. The static
+// initialization is thread-safe, as the instances can be built concurrently.
+int memory::get_pattern_fd()
+{
+  static int pattern_fd = memory_create_pattern_fd();
+
+  return pattern_fd;
+}
+
+// Allocate the memory with private mappings of the initial pattern file and
+// of the stimuli file, so that pages are only allocated when they are modified.
+// The pages of the stimuli file which are not modified by the simulation keep
+// reading the file, so it must not be modified while the simulation is running.
+// Returns NULL if it fails, in which case the memory is allocated normally.
+uint8_t *memory::mmap_alloc(string stim_path)
+{
+  uint64_t page_size = sysconf(_SC_PAGESIZE);
+  uint64_t map_size = (size + page_size - 1) & ~(page_size - 1);
+
+  int pattern_fd = get_pattern_fd();
+  if (pattern_fd == -1 || map_size == 0)
+  {
+    return NULL;
+  }
+
+  uint8_t *data = (uint8_t *)mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (data == MAP_FAILED)
+  {
+    return NULL;
+  }
+
+  for (uint64_t offset = 0; offset < map_size; offset += MEMORY_PATTERN_CHUNK_SIZE)
+  {
+    uint64_t chunk_size = std::min(map_size - offset, (uint64_t)MEMORY_PATTERN_CHUNK_SIZE);
+    if (mmap(data + offset, chunk_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED,
+      pattern_fd, 0) == MAP_FAILED)
+    {
+      munmap(data, map_size);
+      return NULL;
+    }
+  }
+
+  if (stim_path != "")
+  {
+    int fd = open(stim_path.c_str(), O_RDONLY);
+    struct stat stat;
+    if (fd == -1 || fstat(fd, &stat) == -1)
+    {
+      this->trace.fatal("Unable to open stim file: %s, %s\n", stim_path.c_str(), strerror(errno));
+      if (fd != -1)
+      {
+        close(fd);
+      }
+      return data;
+    }
+
+    uint64_t stim_size = std::min((uint64_t)stat.st_size, size);
+    if (stim_size == 0)
+    {
+      // Nothing failed here, errno would be stale
+      this->trace.fatal("Failed to read stim file: %s, empty file\n", stim_path.c_str());
+      close(fd);
+      return data;
+    }
+
+    // Full pages are mapped from the file while the last incomplete one is read,
+    // to keep the initial pattern after the end of the file. Small files are
+    // completely read.
+    uint64_t mapped_size = stim_size >= MEMORY_STIM_MAP_MIN_SIZE ? stim_size & ~(page_size - 1) : 0;
+    if (mapped_size && mmap(data, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED,
+      fd, 0) == MAP_FAILED)
+    {
+      mapped_size = 0;
+    }
+
+    trace.msg("Preloading memory with stimuli file (path: %s, mapped size: 0x%lx)\n", stim_path.c_str(), mapped_size);
+
+    uint64_t remaining = stim_size - mapped_size;
+    if (remaining && pread(fd, data + mapped_size, remaining, mapped_size) != (ssize_t)remaining)
+    {
+      this->trace.fatal("Failed to read stim file: %s, %s\n", stim_path.c_str(), strerror(errno));
+    }
+
+    close(fd);
+  }
+
+  return data;
+}
+
 extern "C" vp::component *vp_constructor(js::config *config)
 {
   return new memory(config);
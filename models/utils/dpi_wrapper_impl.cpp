@@ -95,10 +95,6 @@ static vector<vp::cpi_master *> cpi_masters;
 static vector<cpi_handle_t *> cpi_handles;
 static vector<gpio_handle_t *> gpio_handles;
 
-static ucontext_t main_context;
-
-static dpi_task *active_task;
-
 class dpi_task
 {
   friend class dpi_wrapper;
@@ -145,6 +141,7 @@ private:
 
 class dpi_wrapper : public vp::component
 {
+  friend class dpi_task;
 
 public:
 
@@ -186,6 +183,10 @@ private:
   vector<dpi_task *> tasks;
   vector<dpi_periodic_handler *> handlers;
   dpi_task * first_waiting_task = NULL;
+  // Context of the engine, and task currently executed, each instance has its own
+  // since several simulator instances can run in the same process
+  ucontext_t main_context;
+  dpi_task *active_task = NULL;
   vp::wire_master<bool> chip_reset_itf;
   vp::wire_master<uint32_t> chip_config_itf;
 
@@ -198,21 +199,21 @@ void dpi_task::wait_ps(int64_t t)
   int64_t period = this->top->get_period();
   int64_t cycles = (t + period - 1) / period;
   this->top->event_enqueue(this->wait_evt, cycles);
-  swapcontext(&this->context, &main_context);
+  swapcontext(&this->context, &this->top->main_context);
 }
 
 
 void dpi_task::wait_event()
 {
   top->enqueue_waiting_for_event(this);
-  swapcontext(&this->context, &main_context);
+  swapcontext(&this->context, &this->top->main_context);
 }
 
 void dpi_task::wait_handler(void *__this, vp::clock_event *event)
 {
   dpi_task *_this = (dpi_task *)__this;
-  active_task = _this;
-  swapcontext(&main_context, &_this->context);
+  _this->top->active_task = _this;
+  swapcontext(&_this->top->main_context, &_this->context);
 }
 
 void dpi_task::entry_stub(int id)
@@ -229,7 +230,7 @@ void dpi_task::start()
 
   this->context.uc_stack.ss_sp = malloc(65536);
   this->context.uc_stack.ss_size = 65536;
-  this->context.uc_link = &main_context;
+  this->context.uc_link = &this->top->main_context;
 
   makecontext(&this->context, (void (*)())dpi_task::entry_stub, 1, this->id);
 }
@@ -277,19 +278,19 @@ void dpi_wrapper::enqueue_waiting_for_event(dpi_task *task)
 
 int dpi_wrapper::wait(int64_t t)
 {
-  active_task->wait_ps(t*1000);
+  this->active_task->wait_ps(t*1000);
   return 0;
 }
 
 int dpi_wrapper::wait_ps(int64_t t)
 {
-  active_task->wait_ps(t);
+  this->active_task->wait_ps(t);
   return 0;
 }
 
 void dpi_wrapper::wait_event()
 {
-  active_task->wait_event();
+  this->active_task->wait_event();
 }
 
 void dpi_wrapper::raise_event()
@@ -300,8 +301,8 @@ void dpi_wrapper::raise_event()
   {
     dpi_task *next = current->next;
 
-    active_task = current;
-    swapcontext(&main_context, &current->context);
+    this->active_task = current;
+    swapcontext(&this->main_context, &current->context);
 
     current = next;
   }
@@ -386,7 +387,7 @@ int dpi_wrapper::build()
   this->new_master_port("chip_reset", &this->chip_reset_itf);
   this->new_master_port("chip_config", &this->chip_config_itf);
 
-  void *config_handle = dpi_config_get_from_file(getenv("PULP_CONFIG_FILE"));
+  void *config_handle = dpi_config_get_from_file(this->get_config_path().c_str());
 
   if (config_handle == NULL) return 0;
 
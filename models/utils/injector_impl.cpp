@@ -21,12 +21,14 @@
 
 #include <vp/vp.hpp>
 #include <vp/launcher_internal.hpp>
+#include <vp/launcher_ring.hpp>
 #include <vp/itf/io.hpp>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
+#include <vector>
 
 class injector : public vp::component {
 
@@ -49,8 +51,16 @@ private:
   FILE *snd_file;
   FILE *rcv_file;
 
+  // Shared-memory rings, used instead of the pipes when the launcher provides them
+  bool use_ring;
+  gv_ioreq_ring_port_t snd_port;
+  gv_ioreq_ring_port_t rcv_port;
+
   static vp::io_req_status_e req(void *__this, vp::io_req *req);
   void binding_routine();
+  void ring_binding_routine();
+  void ring_receive();
+  void handle_ext_req(gv_ioreq_desc_t *req, uint8_t *data);
 
 };
 
@@ -71,7 +81,7 @@ vp::io_req_status_e injector::req(void *__this, vp::io_req *req)
 
   _this->trace.msg("IO access (offset: 0x%lx, size: 0x%lx, is_write: %d)\n", offset, size, req->get_is_write());
 
-  if (_this->snd_file == NULL)
+  if (_this->snd_file == NULL && !_this->use_ring)
   {
     _this->trace.force_warning("Accessing injector while it is not connected\n");
     return vp::IO_REQ_INVALID;
@@ -82,6 +92,16 @@ vp::io_req_status_e injector::req(void *__this, vp::io_req *req)
     .binding=(void *)_this->binding_context, .req=req
   };
 
+  if (_this->use_ring)
+  {
+    if (gv_ioreq_ring_send(&_this->snd_port, &desc, data, is_write ? size : 0))
+    {
+      _this->trace.force_warning("Failed to send request to external binding (size: 0x%lx)\n", size);
+      return vp::IO_REQ_INVALID;
+    }
+    return vp::IO_REQ_PENDING;
+  }
+
   if (fwrite((void *)&desc, sizeof(desc), 1, _this->snd_file) != 1) return vp::IO_REQ_INVALID;
   if (is_write && fwrite(data, size, 1, _this->snd_file) != 1) return vp::IO_REQ_INVALID;
   fflush(_this->snd_file);
@@ -89,6 +109,111 @@ vp::io_req_status_e injector::req(void *__this, vp::io_req *req)
   return vp::IO_REQ_PENDING;
 }
 
+// Forward a request received from the external binding and turn its descriptor
+// into the response. Must be called with the engine locked.
+void injector::handle_ext_req(gv_ioreq_desc_t *req, uint8_t *data)
+{
+  vp::io_req *io_req = &ext_req;
+  io_req->init();
+  io_req->set_addr(req->addr);
+  io_req->set_size(req->size);
+  io_req->set_is_write(req->is_write);
+  io_req->set_data(data);
+
+  this->get_clock()->sync();
+
+  int err = this->out.req(io_req);
+
+  req->user_req.state = err != vp::IO_REQ_OK ? GV_IOREQ_DONE_ERROR : GV_IOREQ_DONE;
+  req->user_req.latency = this->get_time() + io_req->get_latency() + io_req->get_duration();
+
+  req->type = GV_IOREQ_DESC_TYPE_RESPONSE;
+}
+
+void injector::ring_binding_routine()
+{
+  this->get_clock()->get_engine()->wait_running();
+
+  this->ring_receive();
+
+  // The launcher may be waiting for a response or for room in the rings, tell it
+  // that nothing will be received or sent anymore
+  gv_ioreq_ring_close(&this->rcv_port);
+  gv_ioreq_ring_close(&this->snd_port);
+}
+
+// Handle the messages from the launcher until it is gone or an error occurs
+void injector::ring_receive()
+{
+  while(1)
+  {
+    gv_ioreq_desc_t *desc = gv_ioreq_ring_wait(&this->rcv_port);
+    if (desc == NULL)
+    {
+      return;
+    }
+
+    // All the messages available are handled with the engine locked once, except
+    // while responses are sent
+    this->get_clock()->get_engine()->lock();
+
+    do
+    {
+      gv_ioreq_desc_t req = *desc;
+
+      if (req.type == GV_IOREQ_DESC_TYPE_REQUEST)
+      {
+        this->trace.msg("Received IO req from external binding (addr: 0x%llx, size: 0x%llx, is_write: %d)\n", req.addr, req.size, req.is_write);
+
+        // Payloads are not bounded by the ring, they are not put on the stack
+        std::vector<uint8_t> data(req.size);
+        if (gv_ioreq_ring_recv_payload(&this->rcv_port, desc, req.is_write ? data.data() : NULL, req.is_write ? req.size : 0))
+        {
+          this->trace.force_warning("Failed to receive request payload from external binding (size: 0x%llx)\n", req.size);
+          this->get_clock()->get_engine()->unlock();
+          return;
+        }
+
+        this->handle_ext_req(&req, data.data());
+
+        // The send may wait for the launcher to make room in the ring, which may
+        // first need an engine response, so the engine must not be kept locked
+        this->get_clock()->get_engine()->unlock();
+        int err = gv_ioreq_ring_send(&this->snd_port, &req, data.data(), req.is_write ? 0 : req.size);
+        if (err)
+        {
+          this->trace.force_warning("Failed to send response to external binding (size: 0x%llx)\n", req.size);
+          return;
+        }
+        this->get_clock()->get_engine()->lock();
+      }
+      else
+      {
+        vp::io_req *ioreq = (vp::io_req *)req.req;
+        if (gv_ioreq_ring_recv_payload(&this->rcv_port, desc, ioreq->get_is_write() ? NULL : ioreq->get_data(),
+          ioreq->get_is_write() ? 0 : ioreq->get_size()))
+        {
+          this->trace.force_warning("Failed to receive response payload from external binding (size: 0x%lx)\n", ioreq->get_size());
+          this->get_clock()->get_engine()->unlock();
+          return;
+        }
+
+        // Errors reported by the external binding are forwarded to the initiator
+        ioreq->status = req.user_req.state == GV_IOREQ_DONE_ERROR ? vp::IO_REQ_INVALID : vp::IO_REQ_OK;
+
+        // Don't specify any timestamp as the initiator will take care of updating
+        // the time depending on the latency we report
+        ioreq->set_latency(0);
+        ioreq->get_resp_port()->resp(ioreq);
+      }
+
+      desc = gv_ioreq_ring_get(&this->rcv_port);
+    } while (desc);
+
+    this->get_clock()->get_engine()->unlock();
+  }
+}
+
 void injector::binding_routine()
 {
   this->get_clock()->get_engine()->wait_running();
@@ -113,24 +238,10 @@ void injector::binding_routine()
         return;
       }
 
-      vp::io_req *io_req = &ext_req;
-      io_req->init();
-      io_req->set_addr(req.addr);
-      io_req->set_size(req.size);
-      io_req->set_is_write(req.is_write);
-      io_req->set_data(data);
-
-      this->get_clock()->sync();
-
-      int err = this->out.req(io_req);
-
-      req.user_req.state = err != vp::IO_REQ_OK ? GV_IOREQ_DONE_ERROR : GV_IOREQ_DONE;
-      req.user_req.latency = this->get_time() + io_req->get_latency() + io_req->get_duration();
+      this->handle_ext_req(&req, data);
 
       this->get_clock()->get_engine()->unlock();
 
-      req.type = GV_IOREQ_DESC_TYPE_RESPONSE;
-
       if (fwrite(&req, sizeof(req), 1, snd_file) != 1) return;
       if (!req.is_write && fwrite((void *)data, req.size, 1, snd_file) != 1) return;
 
@@ -140,6 +251,7 @@ void injector::binding_routine()
     {
       vp::io_req *ioreq = (vp::io_req *)req.req;
       if (!ioreq->get_is_write() && fread(ioreq->get_data(), ioreq->get_size(), 1, this->rcv_file) != 1) return;
+      ioreq->status = req.user_req.state == GV_IOREQ_DONE_ERROR ? vp::IO_REQ_INVALID : vp::IO_REQ_OK;
       // Don't specify any timestamp as the initiator will take care of updating
       // the time depending on the latency we report
       this->get_clock()->get_engine()->lock();
@@ -165,6 +277,24 @@ int injector::build()
 
   this->binding_context = (void *)(long)this->get_js_config()->get_int("context");
 
+  this->use_ring = false;
+  if (this->get_js_config()->get("shm_fd") != NULL)
+  {
+    int shm_fd = this->get_js_config()->get_int("shm_fd");
+    int snd_doorbell = this->get_js_config()->get_int("snd_doorbell");
+    int rcv_doorbell = this->get_js_config()->get_int("rcv_doorbell");
+
+    // Ring 0 goes from the launcher to the platform, ring 1 the other way
+    if (gv_ioreq_ring_open(&this->rcv_port, shm_fd, 0, rcv_doorbell, false) ||
+      gv_ioreq_ring_open(&this->snd_port, shm_fd, 1, snd_doorbell, true))
+    {
+      snprintf(vp_error, VP_ERROR_SIZE, "Failed to map shared memory: %s",  strerror(errno));
+      return -1;
+    }
+
+    this->use_ring = true;
+  }
+
   if (snd_fd != -1)
   {
     snd_file = fdopen(snd_fd, "w");
@@ -198,7 +328,12 @@ int injector::build()
 
 void injector::start()
 {
-  if (rcv_file)
+  if (this->use_ring)
+  {
+    this->get_clock()->retain();
+    new std::thread(&injector::ring_binding_routine, this);
+  }
+  else if (rcv_file)
   {
     this->get_clock()->retain();
     new std::thread(&injector::binding_routine, this);